@@ -5,27 +5,41 @@
 
 #include <stdlib.h>
 
+// The number of items in each chunk; with the link to the
+// next chunk, a chunk occupies 2KB on 64-bit platforms.
+#define CHUNK_CAPACITY 255
+
 // ----------------------------------------------------------------------------
 // Internal Declarations
 
-typedef struct queue_item
+// A fixed-size array of items, linked to the chunk that follows it.
+typedef struct queue_chunk
 {
-    struct queue_item* next;
-    void*              value;
-} queue_item_t;
+    struct queue_chunk* next;
+    void*               items[CHUNK_CAPACITY];
+} queue_chunk_t;
 
 struct queue
 {
-    queue_item_t* head;
-    queue_item_t* tail;
+    // Items are popped from `head` at `head_index`,
+    // and pushed to `tail` at `tail_index`.
+    queue_chunk_t* head;
+    queue_chunk_t* tail;
+    size_t         head_index;
+    size_t         tail_index;
+
+    // A chunk retained for reuse when the tail next fills,
+    // so that a queue cycling through chunks does not allocate.
+    queue_chunk_t* spare;
+
+    // The number of items in the queue.
+    size_t count;
 
     deleter_f deleter;
 };
 
-static bool queue_is_empty(queue_t* queue);
-
-static queue_item_t* new_queue_item(void* value);
-static void delete_queue_item(queue_item_t* item);
+static queue_chunk_t* new_chunk(queue_t* queue);
+static void recycle_chunk(queue_t* queue, queue_chunk_t* chunk);
 
 // ----------------------------------------------------------------------------
 // Exported
@@ -43,8 +57,19 @@ queue_t* queue_new(deleter_f deleter)
         return NULL;
     }
 
-    queue->head = NULL;
-    queue->tail = NULL;
+    queue->spare = NULL;
+
+    queue->head = new_chunk(queue);
+    if (NULL == queue->head)
+    {
+        free(queue);
+        return NULL;
+    }
+
+    queue->tail       = queue->head;
+    queue->head_index = 0;
+    queue->tail_index = 0;
+    queue->count      = 0;
 
     queue->deleter = deleter;
 
@@ -58,12 +83,18 @@ void queue_delete(queue_t* queue)
         return;
     }
 
-    void* value;
-    while ((value = queue_pop(queue)) != NULL)
+    while (queue->count > 0)
     {
-        queue->deleter(value);
+        void* value = queue_pop(queue);
+        if (value != NULL)
+        {
+            queue->deleter(value);
+        }
     }
 
+    // popping the last item leaves a single, empty chunk
+    free(queue->head);
+    free(queue->spare);
     free(queue);
 }
 
@@ -74,76 +105,87 @@ bool queue_push(queue_t* queue, void* value)
         return false;
     }
 
-    queue_item_t* item = new_queue_item(value);
-    if (NULL == item)
+    if (CHUNK_CAPACITY == queue->tail_index)
     {
-        return false;
+        queue_chunk_t* chunk = new_chunk(queue);
+        if (NULL == chunk)
+        {
+            return false;
+        }
+
+        queue->tail->next = chunk;
+        queue->tail       = chunk;
+        queue->tail_index = 0;
     }
 
-    if (queue_is_empty(queue))
-    {
-        queue->head = item;
-        queue->tail = item;
-    }
-    else
-    {
-        // general case
-        queue->tail->next = item;
-        queue->tail       = item;
-    }
+    queue->tail->items[queue->tail_index++] = value;
+    queue->count++;
 
     return true;
 }
 
 void* queue_pop(queue_t* queue)
 {
-    if (NULL == queue || queue_is_empty(queue))
+    if (NULL == queue || 0 == queue->count)
     {
         return NULL;
     }
 
-    queue_item_t* popped = queue->head;
-    if (queue->tail == popped)
+    void* value = queue->head->items[queue->head_index++];
+    queue->count--;
+
+    if (CHUNK_CAPACITY == queue->head_index && queue->head != queue->tail)
     {
-        // only a single item in the queue
-        queue->head = NULL;
-        queue->tail = NULL;
+        // the head chunk is exhausted; move on to the next
+        queue_chunk_t* exhausted = queue->head;
+        queue->head       = exhausted->next;
+        queue->head_index = 0;
+
+        recycle_chunk(queue, exhausted);
     }
-    else
+
+    if (0 == queue->count)
     {
-        // general case
-        queue->head = popped->next;
+        // empty, with head == tail; start again from the front of the chunk
+        queue->head_index = 0;
+        queue->tail_index = 0;
     }
 
-    void* tmp = popped->value;
-    delete_queue_item(popped);
-
-    return tmp;
+    return value;
 }
 
 // ----------------------------------------------------------------------------
 // Internal
 
-static bool queue_is_empty(queue_t* queue)
-{
-    return (NULL == queue->head) && (NULL == queue->tail);
-}
-
-static queue_item_t* new_queue_item(void* value)
+static queue_chunk_t* new_chunk(queue_t* queue)
 {
-    queue_item_t* item = malloc(sizeof(queue_item_t));
-    if (NULL == item)
+    queue_chunk_t* chunk = queue->spare;
+    if (chunk != NULL)
     {
-        return NULL;
+        queue->spare = NULL;
+    }
+    else
+    {
+        chunk = malloc(sizeof(queue_chunk_t));
+        if (NULL == chunk)
+        {
+            return NULL;
+        }
     }
 
-    item->next  = NULL;
-    item->value = value;
+    chunk->next = NULL;
 
-    return item;
+    return chunk;
 }
 
-static void delete_queue_item(queue_item_t* item)
+static void recycle_chunk(queue_t* queue, queue_chunk_t* chunk)
 {
-    free(item);
-}
\ No newline at end of file
+    if (NULL == queue->spare)
+    {
+        queue->spare = chunk;
+    }
+    else
+    {
+        free(chunk);
+    }
+}
@@ -1,5 +1,12 @@
 // queue.h
 // Generic FIFO queue data structure.
+//
+// Items are stored in a linked list of fixed-size chunks, each holding
+// a few hundred items, so that push and pop are usually just an array
+// store or load and an index increment; a chunk is allocated only when
+// the tail chunk fills. A chunk emptied by pop is kept as a spare for
+// the next time the tail fills, so that a queue whose length stays
+// roughly constant does not allocate at all.
 
 #ifndef QUEUE_H
 #define QUEUE_H
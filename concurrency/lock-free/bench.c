@@ -0,0 +1,268 @@
+// bench.c
+// Contended throughput benchmark for the concurrent stacks.
+//
+// Each of t threads performs a fixed number of operations on a shared
+// stack, choosing push or pop at random with equal probability, for t
+// from 1 to 64. The stack is first filled with some items, so that pops
+// rarely find it empty. Reports the total throughput in millions of
+// operations per second.
+//
+// The elimination-backoff stack is compared against the Treiber stack
+// and against the array-backed lstack_t of data-structures/stack guarded
+// by a single mutex. Throughput at the larger thread counts depends on
+// the number of cores: with fewer cores than threads, threads are
+// preempted rather than contending, and elimination has little to do.
+//
+// Usage:
+//  ./bench [operations per thread]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "stack.h"
+#include "lf_stack.h"
+#include "eb_stack.h"
+
+#define DEFAULT_OPS_PER_THREAD 1000000
+
+#define MAX_THREADS 64
+
+// The number of items on the stack before the threads start.
+#define N_PREFILL 1000
+
+// ----------------------------------------------------------------------------
+// Stacks Under Test
+
+typedef struct locked_stack
+{
+    pthread_mutex_t lock;
+    lstack_t*       stack;
+} locked_stack_t;
+
+typedef enum variant
+{
+    LOCKED,
+    TREIBER,
+    ELIMINATION
+} variant_t;
+
+typedef struct bench_stack
+{
+    variant_t      variant;
+    locked_stack_t locked;
+    lf_stack_t*    treiber;
+    eb_stack_t*    elimination;
+} bench_stack_t;
+
+static bool bench_push(bench_stack_t* s, void* data)
+{
+    switch (s->variant)
+    {
+    case LOCKED:
+    {
+        pthread_mutex_lock(&s->locked.lock);
+        const bool pushed = stack_push(s->locked.stack, data);
+        pthread_mutex_unlock(&s->locked.lock);
+        return pushed;
+    }
+    case TREIBER:
+        return lf_stack_push(s->treiber, data);
+    case ELIMINATION:
+        return eb_stack_push(s->elimination, data);
+    }
+
+    return false;
+}
+
+static void* bench_pop(bench_stack_t* s)
+{
+    switch (s->variant)
+    {
+    case LOCKED:
+    {
+        pthread_mutex_lock(&s->locked.lock);
+        void* data = stack_pop(s->locked.stack);
+        pthread_mutex_unlock(&s->locked.lock);
+        return data;
+    }
+    case TREIBER:
+        return lf_stack_pop(s->treiber);
+    case ELIMINATION:
+        return eb_stack_pop(s->elimination);
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+typedef struct thread_args
+{
+    bench_stack_t*     stack;
+    pthread_barrier_t* barrier;
+    size_t             n_ops;
+    uint64_t           seed;
+    size_t             n_pushed;
+    size_t             n_popped;
+} thread_args_t;
+
+static uint64_t next_random(uint64_t* state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void fail(const char* message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+static void* worker(void* arg)
+{
+    thread_args_t* args = (thread_args_t*) arg;
+
+    uint64_t rng = args->seed;
+
+    pthread_barrier_wait(args->barrier);
+
+    for (size_t i = 0; i < args->n_ops; ++i)
+    {
+        if (next_random(&rng) >> 63)
+        {
+            if (!bench_push(args->stack, (void*) (uintptr_t) (i + 1)))
+            {
+                fail("push failed");
+            }
+
+            args->n_pushed++;
+        }
+        else if (bench_pop(args->stack) != NULL)
+        {
+            args->n_popped++;
+        }
+    }
+
+    return NULL;
+}
+
+static double run(variant_t variant, size_t n_threads, size_t ops_per_thread)
+{
+    bench_stack_t stack = { .variant = variant };
+
+    pthread_mutex_init(&stack.locked.lock, NULL);
+    stack.locked.stack = stack_new();
+    stack.treiber      = lf_stack_new();
+    stack.elimination  = eb_stack_new();
+
+    if (NULL == stack.locked.stack || NULL == stack.treiber || NULL == stack.elimination)
+    {
+        fail("allocation failed");
+    }
+
+    for (size_t i = 0; i < N_PREFILL; ++i)
+    {
+        if (!bench_push(&stack, (void*) (uintptr_t) (i + 1)))
+        {
+            fail("push failed");
+        }
+    }
+
+    // the threads start together, once all have been created
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned) n_threads + 1);
+
+    pthread_t     threads[MAX_THREADS];
+    thread_args_t args[MAX_THREADS];
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        args[i] = (thread_args_t) {
+            .stack    = &stack,
+            .barrier  = &barrier,
+            .n_ops    = ops_per_thread,
+            .seed     = 0x9e3779b97f4a7c15ULL*(i + 1),
+            .n_pushed = 0,
+            .n_popped = 0
+        };
+
+        if (pthread_create(&threads[i], NULL, worker, &args[i]) != 0)
+        {
+            fail("pthread_create() failed");
+        }
+    }
+
+    pthread_barrier_wait(&barrier);
+    const double start = now_seconds();
+
+    size_t n_pushed = N_PREFILL;
+    size_t n_popped = 0;
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        pthread_join(threads[i], NULL);
+        n_pushed += args[i].n_pushed;
+        n_popped += args[i].n_popped;
+    }
+
+    const double elapsed = now_seconds() - start;
+
+    // every item pushed is popped exactly once
+    while (bench_pop(&stack) != NULL)
+    {
+        n_popped++;
+    }
+
+    if (n_popped != n_pushed)
+    {
+        fail("items lost");
+    }
+
+    pthread_barrier_destroy(&barrier);
+    pthread_mutex_destroy(&stack.locked.lock);
+    stack_delete(stack.locked.stack);
+    lf_stack_delete(stack.treiber);
+    eb_stack_delete(stack.elimination);
+
+    return (double) (n_threads*ops_per_thread) / elapsed / 1e6;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t ops_per_thread = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_OPS_PER_THREAD;
+
+    printf("%7s  %12s  %12s  %12s\n", "threads", "mutex", "treiber", "elimination");
+
+    for (size_t n_threads = 1; n_threads <= MAX_THREADS; n_threads *= 2)
+    {
+        const double locked      = run(LOCKED, n_threads, ops_per_thread);
+        const double treiber     = run(TREIBER, n_threads, ops_per_thread);
+        const double elimination = run(ELIMINATION, n_threads, ops_per_thread);
+
+        printf("%7zu  %12.2f  %12.2f  %12.2f\n", n_threads, locked, treiber, elimination);
+    }
+
+    printf("(millions of operations per second)\n");
+
+    return EXIT_SUCCESS;
+}
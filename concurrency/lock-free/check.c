@@ -0,0 +1,441 @@
+// check.c
+// Driver program for lock-free queue and stack tests.
+
+// attribute gnu_printf
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "lf_queue.h"
+#include "lf_stack.h"
+#include "eb_stack.h"
+
+#define N_THREADS          4
+#define N_ITEMS_PER_THREAD 20000
+#define N_ITEMS            (N_THREADS*N_ITEMS_PER_THREAD)
+
+// ----------------------------------------------------------------------------
+// Definitions for Testing
+
+// Items are encoded as nonzero integers, so that none is NULL.
+#define ENCODE(id, i) ((void*) (uintptr_t) ((id)*N_ITEMS_PER_THREAD + (i) + 1))
+#define DECODE(item)  ((size_t) (uintptr_t) (item) - 1)
+
+static size_t n_deleted = 0;
+
+static void count_delete(void* item)
+{
+    (void) item;
+    n_deleted++;
+}
+
+typedef struct thread_args
+{
+    lf_queue_t*  queue;
+    lf_stack_t*  stack;
+    eb_stack_t*  eb_stack;
+    size_t       id;
+    atomic_int*  seen;
+    atomic_long* n_popped;
+} thread_args_t;
+
+static void* queue_producer(void* arg)
+{
+    thread_args_t* args = (thread_args_t*) arg;
+
+    for (size_t i = 0; i < N_ITEMS_PER_THREAD; ++i)
+    {
+        if (!lf_queue_push(args->queue, ENCODE(args->id, i)))
+        {
+            return (void*) 1;
+        }
+    }
+
+    return NULL;
+}
+
+static void* queue_consumer(void* arg)
+{
+    thread_args_t* args = (thread_args_t*) arg;
+
+    // the items of each producer must arrive in the order they were pushed
+    long last[N_THREADS];
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        last[i] = -1;
+    }
+
+    while (atomic_load(args->n_popped) < N_ITEMS / 2)
+    {
+        void* item = lf_queue_pop(args->queue);
+        if (NULL == item)
+        {
+            continue;
+        }
+
+        const size_t key = DECODE(item);
+        if (key >= N_ITEMS)
+        {
+            return (void*) 1;
+        }
+
+        const size_t producer = key / N_ITEMS_PER_THREAD;
+        const long   index    = (long) (key % N_ITEMS_PER_THREAD);
+        if (index <= last[producer])
+        {
+            return (void*) 1;
+        }
+
+        last[producer] = index;
+
+        atomic_fetch_add(&args->seen[key], 1);
+        atomic_fetch_add(args->n_popped, 1);
+    }
+
+    return NULL;
+}
+
+static void* stack_worker(void* arg)
+{
+    thread_args_t* args = (thread_args_t*) arg;
+
+    // interleave pushes and pops, so that items are popped
+    // and freed while other threads are popping around them
+    for (size_t i = 0; i < N_ITEMS_PER_THREAD; ++i)
+    {
+        if (!lf_stack_push(args->stack, ENCODE(args->id, i)))
+        {
+            return (void*) 1;
+        }
+
+        if (i % 2 != 0)
+        {
+            void* item = lf_stack_pop(args->stack);
+            if (item != NULL)
+            {
+                const size_t key = DECODE(item);
+                if (key >= N_ITEMS)
+                {
+                    return (void*) 1;
+                }
+
+                atomic_fetch_add(&args->seen[key], 1);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void* eb_stack_worker(void* arg)
+{
+    thread_args_t* args = (thread_args_t*) arg;
+
+    // pushes and pops in bursts, so that many threads are
+    // pushing at once, and then popping, and collide
+    for (size_t i = 0; i < N_ITEMS_PER_THREAD; i += 8)
+    {
+        for (size_t j = i; j < i + 8 && j < N_ITEMS_PER_THREAD; ++j)
+        {
+            if (!eb_stack_push(args->eb_stack, ENCODE(args->id, j)))
+            {
+                return (void*) 1;
+            }
+        }
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            void* item = eb_stack_pop(args->eb_stack);
+            if (item != NULL)
+            {
+                const size_t key = DECODE(item);
+                if (key >= N_ITEMS)
+                {
+                    return (void*) 1;
+                }
+
+                atomic_fetch_add(&args->seen[key], 1);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Test Cases
+
+START_TEST(test_lf_queue_new)
+{
+    ck_assert_msg(NULL == lf_queue_new(NULL), "lf_queue_new() accepted a NULL deleter");
+
+    lf_queue_t* queue = lf_queue_new(count_delete);
+    ck_assert_msg(queue != NULL, "lf_queue_new() returned NULL");
+
+    ck_assert(NULL == lf_queue_pop(queue));
+    ck_assert(!lf_queue_push(NULL, ENCODE(0, 0)));
+    ck_assert(NULL == lf_queue_pop(NULL));
+
+    lf_queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_lf_queue_fifo)
+{
+    lf_queue_t* queue = lf_queue_new(count_delete);
+    ck_assert_msg(queue != NULL, "lf_queue_new() returned NULL");
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ck_assert(lf_queue_push(queue, ENCODE(0, i)));
+    }
+
+    for (size_t i = 0; i < 500; ++i)
+    {
+        ck_assert_msg(ENCODE(0, i) == lf_queue_pop(queue), "items popped out of order");
+    }
+
+    // the remaining items are passed to the deleter
+    n_deleted = 0;
+    lf_queue_delete(queue);
+    ck_assert(500 == n_deleted);
+}
+END_TEST
+
+START_TEST(test_lf_queue_concurrent)
+{
+    lf_queue_t* queue = lf_queue_new(count_delete);
+    ck_assert_msg(queue != NULL, "lf_queue_new() returned NULL");
+
+    static atomic_int seen[N_ITEMS];
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        atomic_init(&seen[i], 0);
+    }
+
+    atomic_long n_popped;
+    atomic_init(&n_popped, 0);
+
+    // half of the items are popped while producers and consumers run
+    // together; the remainder are then checked from a single thread
+    pthread_t producers[N_THREADS];
+    pthread_t consumers[N_THREADS];
+    thread_args_t args[N_THREADS];
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        args[i].queue    = queue;
+        args[i].id       = i;
+        args[i].seen     = seen;
+        args[i].n_popped = &n_popped;
+        ck_assert(0 == pthread_create(&producers[i], NULL, queue_producer, &args[i]));
+        ck_assert(0 == pthread_create(&consumers[i], NULL, queue_consumer, &args[i]));
+    }
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        void* result;
+        pthread_join(producers[i], &result);
+        ck_assert_msg(NULL == result, "lf_queue_push() failed");
+        pthread_join(consumers[i], &result);
+        ck_assert_msg(NULL == result, "lf_queue_pop() returned an item out of order");
+    }
+
+    void* item;
+    while ((item = lf_queue_pop(queue)) != NULL)
+    {
+        atomic_fetch_add(&seen[DECODE(item)], 1);
+    }
+
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(1 == atomic_load(&seen[i]), "item not popped exactly once");
+    }
+
+    lf_queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_lf_stack_lifo)
+{
+    ck_assert_msg(!lf_stack_delete(NULL), "lf_stack_delete() accepted NULL");
+
+    lf_stack_t* stack = lf_stack_new();
+    ck_assert_msg(stack != NULL, "lf_stack_new() returned NULL");
+
+    ck_assert(lf_stack_empty(stack));
+    ck_assert(NULL == lf_stack_pop(stack));
+    ck_assert(NULL == lf_stack_peek(stack));
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ck_assert(lf_stack_push(stack, ENCODE(0, i)));
+        ck_assert(ENCODE(0, i) == lf_stack_peek(stack));
+    }
+
+    ck_assert(!lf_stack_empty(stack));
+    ck_assert_msg(!lf_stack_delete(stack), "nonempty stack deleted");
+
+    for (size_t i = 1000; i-- > 0;)
+    {
+        ck_assert_msg(ENCODE(0, i) == lf_stack_pop(stack), "items popped out of order");
+    }
+
+    ck_assert(lf_stack_empty(stack));
+    ck_assert(lf_stack_delete(stack));
+}
+END_TEST
+
+START_TEST(test_lf_stack_concurrent)
+{
+    lf_stack_t* stack = lf_stack_new();
+    ck_assert_msg(stack != NULL, "lf_stack_new() returned NULL");
+
+    static atomic_int seen[N_ITEMS];
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        atomic_init(&seen[i], 0);
+    }
+
+    pthread_t threads[N_THREADS];
+    thread_args_t args[N_THREADS];
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        args[i].stack = stack;
+        args[i].id    = i;
+        args[i].seen  = seen;
+        ck_assert(0 == pthread_create(&threads[i], NULL, stack_worker, &args[i]));
+    }
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        void* result;
+        pthread_join(threads[i], &result);
+        ck_assert_msg(NULL == result, "lf_stack_push() failed or lf_stack_pop() returned a corrupt item");
+    }
+
+    void* item;
+    while ((item = lf_stack_pop(stack)) != NULL)
+    {
+        atomic_fetch_add(&seen[DECODE(item)], 1);
+    }
+
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(1 == atomic_load(&seen[i]), "item not popped exactly once");
+    }
+
+    ck_assert(lf_stack_delete(stack));
+}
+END_TEST
+
+START_TEST(test_eb_stack_lifo)
+{
+    ck_assert_msg(!eb_stack_delete(NULL), "eb_stack_delete() accepted NULL");
+
+    eb_stack_t* stack = eb_stack_new();
+    ck_assert_msg(stack != NULL, "eb_stack_new() returned NULL");
+
+    ck_assert(eb_stack_empty(stack));
+    ck_assert(NULL == eb_stack_pop(stack));
+    ck_assert(NULL == eb_stack_peek(stack));
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ck_assert(eb_stack_push(stack, ENCODE(0, i)));
+        ck_assert(ENCODE(0, i) == eb_stack_peek(stack));
+    }
+
+    ck_assert(!eb_stack_empty(stack));
+    ck_assert_msg(!eb_stack_delete(stack), "nonempty stack deleted");
+
+    for (size_t i = 1000; i-- > 0;)
+    {
+        ck_assert_msg(ENCODE(0, i) == eb_stack_pop(stack), "items popped out of order");
+    }
+
+    ck_assert(eb_stack_empty(stack));
+    ck_assert(eb_stack_delete(stack));
+}
+END_TEST
+
+START_TEST(test_eb_stack_concurrent)
+{
+    eb_stack_t* stack = eb_stack_new();
+    ck_assert_msg(stack != NULL, "eb_stack_new() returned NULL");
+
+    static atomic_int seen[N_ITEMS];
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        atomic_init(&seen[i], 0);
+    }
+
+    pthread_t threads[N_THREADS];
+    thread_args_t args[N_THREADS];
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        args[i].eb_stack = stack;
+        args[i].id       = i;
+        args[i].seen     = seen;
+        ck_assert(0 == pthread_create(&threads[i], NULL, eb_stack_worker, &args[i]));
+    }
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        void* result;
+        pthread_join(threads[i], &result);
+        ck_assert_msg(NULL == result, "eb_stack_push() failed or eb_stack_pop() returned a corrupt item");
+    }
+
+    void* item;
+    while ((item = eb_stack_pop(stack)) != NULL)
+    {
+        atomic_fetch_add(&seen[DECODE(item)], 1);
+    }
+
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(1 == atomic_load(&seen[i]), "item not popped exactly once");
+    }
+
+    ck_assert(eb_stack_delete(stack));
+}
+END_TEST
+
+// ----------------------------------------------------------------------------
+// Infrastructure
+
+Suite* lock_free_suite(void)
+{
+    Suite* s = suite_create("lock-free");
+    TCase* tc_core = tcase_create("lock-free-core");
+
+    tcase_add_test(tc_core, test_lf_queue_new);
+    tcase_add_test(tc_core, test_lf_queue_fifo);
+    tcase_add_test(tc_core, test_lf_queue_concurrent);
+    tcase_add_test(tc_core, test_lf_stack_lifo);
+    tcase_add_test(tc_core, test_lf_stack_concurrent);
+    tcase_add_test(tc_core, test_eb_stack_lifo);
+    tcase_add_test(tc_core, test_eb_stack_concurrent);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    Suite* suite = lock_free_suite();
+    SRunner* runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    srunner_free(runner);
+
+    return EXIT_SUCCESS;
+}
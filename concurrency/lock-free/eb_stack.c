@@ -0,0 +1,382 @@
+// eb_stack.c
+// Unbounded lock-free elimination-backoff stack.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "hazard.h"
+#include "eb_stack.h"
+
+#define CACHE_LINE_SIZE 64
+
+// The number of slots in the elimination array.
+#define ELIMINATION_SLOTS 16
+
+// The number of times a waiting operation polls its slot.
+#define ELIMINATION_SPINS 256
+
+// Slot states. A slot holds either one of the following, or the address
+// of an item tagged with OFFERED (a push is waiting for a pop to take it)
+// or DELIVERED (a waiting pop has been given it); items are allocated
+// with malloc(), so their low-order two bits are clear.
+#define SLOT_EMPTY   ((uintptr_t) 0x0)
+#define SLOT_TAKEN   ((uintptr_t) 0x4)
+#define SLOT_WAITING ((uintptr_t) 0x8)
+
+#define TAG_OFFERED   ((uintptr_t) 0x1)
+#define TAG_DELIVERED ((uintptr_t) 0x2)
+#define TAG_MASK      ((uintptr_t) 0x3)
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+typedef struct eb_stack_item
+{
+    // must come first; see hazard.h
+    hazard_node_t hnode;
+
+    // Set before the item is pushed, and never changed thereafter.
+    struct eb_stack_item* next;
+    void*                 data;
+} eb_stack_item_t;
+
+// A slot of the elimination array, alone on its cache line.
+typedef struct slot
+{
+    _Alignas(CACHE_LINE_SIZE) _Atomic(uintptr_t) state;
+} slot_t;
+
+struct eb_stack
+{
+    _Alignas(CACHE_LINE_SIZE) _Atomic(eb_stack_item_t*) top;
+
+    slot_t slots[ELIMINATION_SLOTS];
+};
+
+typedef enum attempt
+{
+    ATTEMPT_DONE,
+    ATTEMPT_EMPTY,
+    ATTEMPT_CONTENDED
+} attempt_t;
+
+// The calling thread's random state, and the number of slots it uses.
+static _Thread_local uint64_t rng   = 0;
+static _Thread_local size_t   range = 1;
+
+static attempt_t try_push(eb_stack_t* stack, eb_stack_item_t* item);
+static attempt_t try_pop(eb_stack_t* stack, hazard_record_t* record, eb_stack_item_t** popped);
+
+static bool eliminate_push(eb_stack_t* stack, eb_stack_item_t* item);
+static eb_stack_item_t* eliminate_pop(eb_stack_t* stack);
+
+static slot_t* choose_slot(eb_stack_t* stack);
+static void narrow(void);
+static void widen(void);
+
+static eb_stack_item_t* protect_top(hazard_record_t* record, eb_stack_t* stack);
+static void reclaim_item(hazard_node_t* node);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+eb_stack_t* eb_stack_new(void)
+{
+    eb_stack_t* stack = aligned_alloc(CACHE_LINE_SIZE, sizeof(eb_stack_t));
+    if (NULL == stack)
+    {
+        return NULL;
+    }
+
+    atomic_init(&stack->top, NULL);
+    for (size_t i = 0; i < ELIMINATION_SLOTS; ++i)
+    {
+        atomic_init(&stack->slots[i].state, SLOT_EMPTY);
+    }
+
+    return stack;
+}
+
+bool eb_stack_delete(eb_stack_t* stack)
+{
+    if (NULL == stack || atomic_load(&stack->top) != NULL)
+    {
+        return false;
+    }
+
+    free(stack);
+
+    return true;
+}
+
+bool eb_stack_push(eb_stack_t* stack, void* data)
+{
+    if (NULL == stack)
+    {
+        return false;
+    }
+
+    eb_stack_item_t* item = malloc(sizeof(eb_stack_item_t));
+    if (NULL == item)
+    {
+        return false;
+    }
+
+    item->data = data;
+
+    while (try_push(stack, item) != ATTEMPT_DONE)
+    {
+        if (eliminate_push(stack, item))
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+void* eb_stack_pop(eb_stack_t* stack)
+{
+    if (NULL == stack)
+    {
+        return NULL;
+    }
+
+    hazard_record_t* record = hazard_acquire();
+    if (NULL == record)
+    {
+        return NULL;
+    }
+
+    eb_stack_item_t* item = NULL;
+    for (;;)
+    {
+        const attempt_t attempt = try_pop(stack, record, &item);
+        if (ATTEMPT_EMPTY == attempt)
+        {
+            return NULL;
+        }
+
+        if (ATTEMPT_DONE == attempt)
+        {
+            void* data = item->data;
+            hazard_retire(record, &item->hnode, reclaim_item);
+            return data;
+        }
+
+        item = eliminate_pop(stack);
+        if (item != NULL)
+        {
+            // the item was never on the stack, so no other thread refers to it
+            void* data = item->data;
+            free(item);
+            return data;
+        }
+    }
+}
+
+void* eb_stack_peek(eb_stack_t* stack)
+{
+    if (NULL == stack)
+    {
+        return NULL;
+    }
+
+    hazard_record_t* record = hazard_acquire();
+    if (NULL == record)
+    {
+        return NULL;
+    }
+
+    eb_stack_item_t* top = protect_top(record, stack);
+    void* data = (NULL == top) ? NULL : top->data;
+
+    hazard_clear(record, 0);
+
+    return data;
+}
+
+bool eb_stack_empty(eb_stack_t* stack)
+{
+    return (NULL == stack) || (NULL == atomic_load(&stack->top));
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static attempt_t try_push(eb_stack_t* stack, eb_stack_item_t* item)
+{
+    // the item is not yet shared, so no protection is needed
+    item->next = atomic_load_explicit(&stack->top, memory_order_relaxed);
+
+    return atomic_compare_exchange_strong_explicit(
+        &stack->top, &item->next, item,
+        memory_order_release, memory_order_relaxed)
+        ? ATTEMPT_DONE
+        : ATTEMPT_CONTENDED;
+}
+
+static attempt_t try_pop(eb_stack_t* stack, hazard_record_t* record, eb_stack_item_t** popped)
+{
+    eb_stack_item_t* top = protect_top(record, stack);
+    if (NULL == top)
+    {
+        hazard_clear(record, 0);
+        return ATTEMPT_EMPTY;
+    }
+
+    // `top` cannot be freed and reused while protected,
+    // so the swap succeeds only if `next` is its successor
+    const bool swapped = atomic_compare_exchange_strong(&stack->top, &top, top->next);
+
+    hazard_clear(record, 0);
+
+    if (!swapped)
+    {
+        return ATTEMPT_CONTENDED;
+    }
+
+    *popped = top;
+    return ATTEMPT_DONE;
+}
+
+static bool eliminate_push(eb_stack_t* stack, eb_stack_item_t* item)
+{
+    slot_t* slot = choose_slot(stack);
+
+    const uintptr_t offered   = (uintptr_t) item | TAG_OFFERED;
+    const uintptr_t delivered = (uintptr_t) item | TAG_DELIVERED;
+
+    uintptr_t state = atomic_load(&slot->state);
+
+    if (SLOT_WAITING == state)
+    {
+        // a pop is waiting; hand it the item, and it empties the slot
+        return atomic_compare_exchange_strong(&slot->state, &state, delivered);
+    }
+
+    if (state != SLOT_EMPTY || !atomic_compare_exchange_strong(&slot->state, &state, offered))
+    {
+        widen();
+        return false;
+    }
+
+    // wait for a pop to take the item
+    for (size_t i = 0; i < ELIMINATION_SPINS; ++i)
+    {
+        if (SLOT_TAKEN == atomic_load_explicit(&slot->state, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    // withdraw the offer, unless it has been taken in the meantime
+    state = offered;
+    if (atomic_compare_exchange_strong(&slot->state, &state, SLOT_EMPTY))
+    {
+        narrow();
+        return false;
+    }
+
+    // taken, and only this thread can empty the slot
+    atomic_store(&slot->state, SLOT_EMPTY);
+    return true;
+}
+
+static eb_stack_item_t* eliminate_pop(eb_stack_t* stack)
+{
+    slot_t* slot = choose_slot(stack);
+
+    uintptr_t state = atomic_load(&slot->state);
+
+    if (TAG_OFFERED == (state & TAG_MASK))
+    {
+        // a push is waiting; take its item, and it empties the slot
+        return atomic_compare_exchange_strong(&slot->state, &state, SLOT_TAKEN)
+            ? (eb_stack_item_t*) (state & ~TAG_MASK)
+            : NULL;
+    }
+
+    if (state != SLOT_EMPTY || !atomic_compare_exchange_strong(&slot->state, &state, SLOT_WAITING))
+    {
+        widen();
+        return NULL;
+    }
+
+    // wait for a push to deliver an item
+    for (size_t i = 0; i < ELIMINATION_SPINS; ++i)
+    {
+        if (atomic_load_explicit(&slot->state, memory_order_relaxed) != SLOT_WAITING)
+        {
+            break;
+        }
+    }
+
+    // withdraw, unless an item has been delivered in the meantime
+    state = SLOT_WAITING;
+    if (atomic_compare_exchange_strong(&slot->state, &state, SLOT_EMPTY))
+    {
+        narrow();
+        return NULL;
+    }
+
+    // delivered, and only this thread can empty the slot
+    atomic_store(&slot->state, SLOT_EMPTY);
+    return (eb_stack_item_t*) (state & ~TAG_MASK);
+}
+
+static slot_t* choose_slot(eb_stack_t* stack)
+{
+    if (0 == rng)
+    {
+        // seed each thread differently
+        rng = (uint64_t) (uintptr_t) &rng | 1;
+    }
+
+    // xorshift64*
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+
+    const uint64_t r = rng*0x2545f4914f6cdd1dULL;
+    return &stack->slots[(r >> 32) % range];
+}
+
+static void narrow(void)
+{
+    if (range > 1)
+    {
+        range /= 2;
+    }
+}
+
+static void widen(void)
+{
+    if (range < ELIMINATION_SLOTS)
+    {
+        range *= 2;
+    }
+}
+
+static eb_stack_item_t* protect_top(hazard_record_t* record, eb_stack_t* stack)
+{
+    eb_stack_item_t* top = atomic_load(&stack->top);
+    for (;;)
+    {
+        hazard_set(record, 0, top);
+
+        eb_stack_item_t* reloaded = atomic_load(&stack->top);
+        if (reloaded == top)
+        {
+            return top;
+        }
+
+        top = reloaded;
+    }
+}
+
+static void reclaim_item(hazard_node_t* node)
+{
+    free((eb_stack_item_t*) node);
+}
@@ -0,0 +1,107 @@
+// eb_stack.h
+// Unbounded lock-free elimination-backoff stack.
+//
+// Background:
+//
+// A Treiber stack (see lf_stack.h) funnels every operation through a
+// compare-and-swap on its top. Under contention most of those fail, and
+// the threads that retry only contend again, so that throughput falls as
+// threads are added rather than rising.
+//
+// The elimination-backoff stack (Hendler, Shavit and Yerushalmi, 2004)
+// observes that a push followed immediately by a pop leaves the stack
+// unchanged, so such a pair can complete without touching the stack at
+// all: the push simply hands its item to the pop. An operation first
+// tries the stack as usual. If its compare-and-swap fails, then rather
+// than retry at once, it backs off to a randomly chosen slot of an
+// elimination array, and waits there briefly for an operation of the
+// opposite kind. A pop that finds a push waiting takes its item, and a
+// push that finds a pop waiting delivers its item; both then return,
+// having linearized together at the moment of exchange. An operation
+// that meets no partner returns to the stack and tries again.
+//
+// The more contended the stack, the more likely a partner is to arrive,
+// and since exchanges in distinct slots proceed in parallel, throughput
+// scales with the number of threads instead of collapsing. Each thread
+// adapts the range of slots it uses: it narrows the range when it waits
+// in vain, so that sparse operations still meet, and widens it when it
+// finds slots occupied by operations of its own kind.
+//
+// Items on the stack itself are reclaimed with hazard pointers, as in
+// lf_stack.h. An item that is exchanged in the elimination array is owned
+// by exactly one thread at a time, and so needs no protection.
+//
+// The interface follows that of stack.h (lstack_t), and may be used from
+// any number of threads concurrently, except for eb_stack_delete().
+
+#ifndef EB_STACK_H
+#define EB_STACK_H
+
+#include <stdbool.h>
+
+typedef struct eb_stack eb_stack_t;
+
+// eb_stack_new()
+//
+// Construct a new stack data structure.
+//
+// Returns:
+//  A pointer to the newly constructed stack on success.
+//  NULL on failure.
+eb_stack_t* eb_stack_new(void);
+
+// eb_stack_delete()
+//
+// Destroy an existing stack data structure.
+//
+// As with stack_delete(), destruction fails if the stack is not empty;
+// users must pop and destroy the remaining items and try again.
+//
+// No other thread may be accessing the stack.
+//
+// Returns:
+//  `true` on successful destruction of the stack
+//  `false` in the event the stack is nonempty
+bool eb_stack_delete(eb_stack_t* stack);
+
+// eb_stack_push()
+//
+// Push a new item onto the top of the stack.
+//
+// Returns:
+//  `true` on successful push
+//  `false` otherwise (invalid stack, allocation failure)
+bool eb_stack_push(eb_stack_t* stack, void* data);
+
+// eb_stack_pop()
+//
+// Pop an item off the top of the stack.
+//
+// Returns:
+//  A pointer to the user data popped from the stack on success.
+//  NULL on failure (invalid stack, empty stack, allocation failure)
+void* eb_stack_pop(eb_stack_t* stack);
+
+// eb_stack_peek()
+//
+// Return the user data stored in the topmost stack
+// item without removing the item from the stack.
+//
+// Returns:
+//  A pointer to the peeked data on success
+//  NULL on failure (invalid stack, empty stack, allocation failure)
+void* eb_stack_peek(eb_stack_t* stack);
+
+// eb_stack_empty()
+//
+// Determine whether the stack is empty.
+//
+// In the event that an invalid stack pointer (`stack`)
+// is passed to this function, it returns `true`.
+//
+// Returns:
+//  `true` if the stack was empty at the time of the call
+//  `false` otherwise
+bool eb_stack_empty(eb_stack_t* stack);
+
+#endif // EB_STACK_H
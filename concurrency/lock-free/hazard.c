@@ -0,0 +1,306 @@
+// hazard.c
+// Hazard pointers for safe memory reclamation in lock-free structures.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "hazard.h"
+
+// The number of retired nodes beyond the total number of
+// slots at which a thread scans for nodes to reclaim.
+#define SCAN_SLACK 16
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+struct hazard_record
+{
+    // The slots; written only by the owning thread, read by any.
+    _Atomic(void*) hazards[HAZARD_SLOTS];
+
+    // The next record in the global list; records
+    // are never removed, so this never changes.
+    hazard_record_t* next;
+
+    // Set while the record is owned by a thread.
+    atomic_bool active;
+
+    // Nodes retired by the owning thread, awaiting reclamation.
+    hazard_node_t* retired;
+    size_t         n_retired;
+};
+
+// Every record ever allocated, and their number.
+static _Atomic(hazard_record_t*) records = NULL;
+static atomic_size_t             n_records = 0;
+
+// Nodes left unreclaimed by threads that have exited.
+static pthread_mutex_t orphans_lock = PTHREAD_MUTEX_INITIALIZER;
+static hazard_node_t*  orphans      = NULL;
+
+// The key whose destructor releases a thread's record when it exits.
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  key;
+
+static _Thread_local hazard_record_t* current = NULL;
+
+static void create_key(void);
+static hazard_record_t* reuse_record(void);
+static hazard_record_t* new_record(void);
+static void release_record(void* arg);
+
+static void adopt_orphans(hazard_record_t* record);
+static void scan(hazard_record_t* record);
+static int compare_pointers(const void* a, const void* b);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+hazard_record_t* hazard_acquire(void)
+{
+    if (current != NULL)
+    {
+        return current;
+    }
+
+    if (pthread_once(&key_once, create_key) != 0)
+    {
+        return NULL;
+    }
+
+    hazard_record_t* record = reuse_record();
+    if (NULL == record)
+    {
+        record = new_record();
+        if (NULL == record)
+        {
+            return NULL;
+        }
+    }
+
+    // without the destructor, the record would never be released
+    if (pthread_setspecific(key, record) != 0)
+    {
+        atomic_store(&record->active, false);
+        return NULL;
+    }
+
+    current = record;
+    return record;
+}
+
+void hazard_set(hazard_record_t* record, size_t slot, void* pointer)
+{
+    // sequentially consistent, so that the store is visible to a scan
+    // before the shared location from which `pointer` came is reloaded
+    atomic_store(&record->hazards[slot], pointer);
+}
+
+void hazard_clear(hazard_record_t* record, size_t slot)
+{
+    atomic_store_explicit(&record->hazards[slot], NULL, memory_order_release);
+}
+
+void hazard_retire(hazard_record_t* record, hazard_node_t* node, reclaim_f reclaim)
+{
+    node->reclaim = reclaim;
+    node->next    = record->retired;
+    record->retired = node;
+    record->n_retired++;
+
+    const size_t threshold = 2*atomic_load(&n_records)*HAZARD_SLOTS + SCAN_SLACK;
+    if (record->n_retired >= threshold)
+    {
+        scan(record);
+    }
+}
+
+void hazard_collect(hazard_record_t* record)
+{
+    if (NULL == record)
+    {
+        return;
+    }
+
+    scan(record);
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static void create_key(void)
+{
+    // failure leaves records unreleased, so that hazard_acquire() fails
+    pthread_key_create(&key, release_record);
+}
+
+static hazard_record_t* reuse_record(void)
+{
+    // take over a record released by a thread that has exited
+    for (hazard_record_t* r = atomic_load(&records); r != NULL; r = r->next)
+    {
+        bool expected = false;
+        if (!atomic_load_explicit(&r->active, memory_order_relaxed)
+         && atomic_compare_exchange_strong(&r->active, &expected, true))
+        {
+            return r;
+        }
+    }
+
+    return NULL;
+}
+
+static hazard_record_t* new_record(void)
+{
+    hazard_record_t* record = malloc(sizeof(hazard_record_t));
+    if (NULL == record)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < HAZARD_SLOTS; ++i)
+    {
+        atomic_init(&record->hazards[i], NULL);
+    }
+
+    atomic_init(&record->active, true);
+    record->retired   = NULL;
+    record->n_retired = 0;
+
+    record->next = atomic_load(&records);
+    while (!atomic_compare_exchange_weak(&records, &record->next, record))
+        ;
+
+    atomic_fetch_add(&n_records, 1);
+
+    return record;
+}
+
+static void release_record(void* arg)
+{
+    hazard_record_t* record = (hazard_record_t*) arg;
+
+    for (size_t i = 0; i < HAZARD_SLOTS; ++i)
+    {
+        hazard_clear(record, i);
+    }
+
+    scan(record);
+
+    // hand over whatever remains protected by other threads
+    if (record->retired != NULL)
+    {
+        hazard_node_t* last = record->retired;
+        while (last->next != NULL)
+        {
+            last = last->next;
+        }
+
+        pthread_mutex_lock(&orphans_lock);
+        last->next = orphans;
+        orphans    = record->retired;
+        pthread_mutex_unlock(&orphans_lock);
+
+        record->retired   = NULL;
+        record->n_retired = 0;
+    }
+
+    current = NULL;
+    atomic_store(&record->active, false);
+}
+
+static void adopt_orphans(hazard_record_t* record)
+{
+    pthread_mutex_lock(&orphans_lock);
+    hazard_node_t* adopted = orphans;
+    orphans = NULL;
+    pthread_mutex_unlock(&orphans_lock);
+
+    while (adopted != NULL)
+    {
+        hazard_node_t* next = adopted->next;
+        adopted->next   = record->retired;
+        record->retired = adopted;
+        record->n_retired++;
+        adopted = next;
+    }
+}
+
+static void scan(hazard_record_t* record)
+{
+    adopt_orphans(record);
+
+    if (NULL == record->retired)
+    {
+        return;
+    }
+
+    // records are only ever pushed at the head of the list, so
+    // the list that follows a snapshot of the head is fixed; records
+    // added since cannot protect nodes that were already unlinked
+    hazard_record_t* const head = atomic_load(&records);
+
+    size_t capacity = 0;
+    for (hazard_record_t* r = head; r != NULL; r = r->next)
+    {
+        capacity += HAZARD_SLOTS;
+    }
+
+    void** hazards = malloc(capacity*sizeof(void*));
+    if (NULL == hazards)
+    {
+        // try again at the next retirement
+        return;
+    }
+
+    size_t n_hazards = 0;
+    for (hazard_record_t* r = head; r != NULL; r = r->next)
+    {
+        for (size_t i = 0; i < HAZARD_SLOTS; ++i)
+        {
+            void* hazard = atomic_load(&r->hazards[i]);
+            if (hazard != NULL)
+            {
+                hazards[n_hazards++] = hazard;
+            }
+        }
+    }
+
+    qsort(hazards, n_hazards, sizeof(void*), compare_pointers);
+
+    // reclaim every unprotected node, keeping the remainder
+    hazard_node_t* node = record->retired;
+    record->retired   = NULL;
+    record->n_retired = 0;
+
+    while (node != NULL)
+    {
+        hazard_node_t* next = node->next;
+
+        void* key = node;
+        if (NULL == bsearch(&key, hazards, n_hazards, sizeof(void*), compare_pointers))
+        {
+            node->reclaim(node);
+        }
+        else
+        {
+            node->next = record->retired;
+            record->retired = node;
+            record->n_retired++;
+        }
+
+        node = next;
+    }
+
+    free(hazards);
+}
+
+static int compare_pointers(const void* a, const void* b)
+{
+    const uintptr_t x = (uintptr_t) *(void* const*) a;
+    const uintptr_t y = (uintptr_t) *(void* const*) b;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,138 @@
+// hazard.h
+// Hazard pointers for safe memory reclamation in lock-free structures.
+
+#ifndef HAZARD_H
+#define HAZARD_H
+
+#include <stddef.h>
+
+// Background:
+//
+// A lock-free data structure unlinks a node with a single atomic
+// operation, but other threads may still be reading that node: they
+// loaded a pointer to it before it was unlinked, and are about to
+// dereference it. The node therefore cannot be freed as soon as it is
+// unlinked. Worse, if it is freed and the allocator hands the same
+// memory out for a new node that is then linked back in, a thread
+// holding the stale pointer may perform a compare-and-swap that
+// succeeds even though the structure has changed underneath it (the
+// "ABA" problem).
+//
+// Hazard pointers (Michael, 2004) solve both problems. Each thread owns
+// a small number of single-writer, multi-reader slots. Before it
+// dereferences a shared node, a thread publishes the node's address in
+// one of its slots (and then checks that the node is still reachable,
+// since it may have been unlinked between the load and the publish).
+// A thread that unlinks a node "retires" it, adding it to a private
+// list rather than freeing it. When that list grows long enough, the
+// thread scans the slots of every thread and frees those retired nodes
+// that no slot refers to. A node is thus never freed, and so never
+// reused, while any thread may still dereference it, which precludes
+// ABA on that node as well.
+//
+// The cost is a store and a full fence per protected load, and a scan
+// that is amortized over many retirements, since the list is scanned
+// only once it holds a number of nodes proportional to the total number
+// of slots. The number of nodes awaiting reclamation is bounded.
+//
+// In this implementation, a single process-wide set of slots is shared
+// by all structures. A thread acquires a record of slots on its first
+// use, and releases it when the thread exits, at which point any nodes
+// it could not yet free are handed over to be freed by another thread's
+// next scan. Retired nodes embed a hazard_node_t, so that retiring a node
+// never allocates.
+
+// The number of hazard pointer slots available to each thread.
+#define HAZARD_SLOTS 2
+
+// A retired node; embedded in the nodes of lock-free structures.
+//
+// The hazard_node_t must be the first member of the structure node,
+// so that a hazard pointer to the structure node protects it.
+typedef struct hazard_node
+{
+    struct hazard_node* next;
+    void (*reclaim)(struct hazard_node* node);
+} hazard_node_t;
+
+// The signature for the function that frees a retired node.
+typedef void (*reclaim_f)(hazard_node_t* node);
+
+// The record of hazard pointer slots owned by a thread.
+typedef struct hazard_record hazard_record_t;
+
+// hazard_acquire()
+//
+// Return the calling thread's record of hazard pointer slots.
+//
+// The record is acquired on the first call from each thread, and
+// the same record is returned by subsequent calls from that thread.
+//
+// Returns:
+//  A pointer to the calling thread's record on success
+//  NULL on failure (allocation failure)
+hazard_record_t* hazard_acquire(void);
+
+// hazard_set()
+//
+// Publish a pointer in a hazard pointer slot.
+//
+// Publishing a pointer protects the node to which it refers only if
+// the node is still reachable after the pointer is published; callers
+// must therefore reload the shared location from which the pointer was
+// loaded, and retry if it has changed:
+//
+//     node_t* node = atomic_load(&shared);
+//     for (;;)
+//     {
+//         hazard_set(record, 0, node);
+//
+//         node_t* reloaded = atomic_load(&shared);
+//         if (reloaded == node)
+//         {
+//             break;
+//         }
+//
+//         node = reloaded;
+//     }
+//
+// On exit from the loop, `node` will not be reclaimed until the slot is
+// cleared or reused, provided that it is only retired after having been
+// made unreachable from `shared`.
+//
+// Arguments:
+//  record  - the calling thread's record
+//  slot    - the slot in which to publish the pointer
+//  pointer - the pointer to publish
+void hazard_set(hazard_record_t* record, size_t slot, void* pointer);
+
+// hazard_clear()
+//
+// Clear a hazard pointer slot, releasing protection of its node.
+//
+// Arguments:
+//  record - the calling thread's record
+//  slot   - the slot to clear
+void hazard_clear(hazard_record_t* record, size_t slot);
+
+// hazard_retire()
+//
+// Retire a node that has been made unreachable, deferring its
+// reclamation until no thread holds a hazard pointer to it.
+//
+// Arguments:
+//  record  - the calling thread's record
+//  node    - the retired node, embedded in the unlinked structure node
+//  reclaim - the function that frees the structure node
+void hazard_retire(hazard_record_t* record, hazard_node_t* node, reclaim_f reclaim);
+
+// hazard_collect()
+//
+// Reclaim every node retired by the calling thread
+// to which no thread holds a hazard pointer.
+//
+// Arguments:
+//  record - the calling thread's record
+void hazard_collect(hazard_record_t* record);
+
+#endif // HAZARD_H
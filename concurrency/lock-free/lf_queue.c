@@ -0,0 +1,237 @@
+// lf_queue.c
+// Unbounded lock-free multi-producer, multi-consumer FIFO queue.
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "hazard.h"
+#include "lf_queue.h"
+
+#define CACHE_LINE_SIZE 64
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+typedef struct lf_node
+{
+    // must come first; see hazard.h
+    hazard_node_t hnode;
+
+    _Atomic(struct lf_node*) next;
+    void*                    value;
+} lf_node_t;
+
+struct lf_queue
+{
+    // Producers and consumers contend on different lines.
+    _Alignas(CACHE_LINE_SIZE) _Atomic(lf_node_t*) head;
+    _Alignas(CACHE_LINE_SIZE) _Atomic(lf_node_t*) tail;
+
+    deleter_f deleter;
+};
+
+static lf_node_t* new_node(void* value);
+static lf_node_t* protect(hazard_record_t* record, size_t slot, _Atomic(lf_node_t*)* source);
+static void reclaim_node(hazard_node_t* node);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+lf_queue_t* lf_queue_new(deleter_f deleter)
+{
+    if (NULL == deleter)
+    {
+        return NULL;
+    }
+
+    lf_queue_t* queue = aligned_alloc(CACHE_LINE_SIZE, sizeof(lf_queue_t));
+    if (NULL == queue)
+    {
+        return NULL;
+    }
+
+    lf_node_t* dummy = new_node(NULL);
+    if (NULL == dummy)
+    {
+        free(queue);
+        return NULL;
+    }
+
+    atomic_init(&queue->head, dummy);
+    atomic_init(&queue->tail, dummy);
+    queue->deleter = deleter;
+
+    return queue;
+}
+
+void lf_queue_delete(lf_queue_t* queue)
+{
+    if (NULL == queue)
+    {
+        return;
+    }
+
+    // with no other thread present, the list may be walked directly
+    lf_node_t* dummy = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    lf_node_t* node  = atomic_load_explicit(&dummy->next, memory_order_relaxed);
+    free(dummy);
+
+    while (node != NULL)
+    {
+        lf_node_t* next = atomic_load_explicit(&node->next, memory_order_relaxed);
+        if (node->value != NULL)
+        {
+            queue->deleter(node->value);
+        }
+
+        free(node);
+        node = next;
+    }
+
+    free(queue);
+}
+
+bool lf_queue_push(lf_queue_t* queue, void* value)
+{
+    if (NULL == queue)
+    {
+        return false;
+    }
+
+    hazard_record_t* record = hazard_acquire();
+    if (NULL == record)
+    {
+        return false;
+    }
+
+    lf_node_t* node = new_node(value);
+    if (NULL == node)
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        lf_node_t* tail = protect(record, 0, &queue->tail);
+        lf_node_t* next = atomic_load(&tail->next);
+
+        if (next != NULL)
+        {
+            // the tail is lagging; help to advance it
+            atomic_compare_exchange_strong(&queue->tail, &tail, next);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak(&tail->next, &next, node))
+        {
+            // failure means another thread has already advanced the tail
+            atomic_compare_exchange_strong(&queue->tail, &tail, node);
+            break;
+        }
+    }
+
+    hazard_clear(record, 0);
+
+    return true;
+}
+
+void* lf_queue_pop(lf_queue_t* queue)
+{
+    if (NULL == queue)
+    {
+        return NULL;
+    }
+
+    hazard_record_t* record = hazard_acquire();
+    if (NULL == record)
+    {
+        return NULL;
+    }
+
+    lf_node_t* head;
+    void*      value;
+
+    for (;;)
+    {
+        head = protect(record, 0, &queue->head);
+
+        lf_node_t* tail = atomic_load(&queue->tail);
+        lf_node_t* next = atomic_load(&head->next);
+
+        // `next` cannot be retired before `head`, so it
+        // is protected once `head` is seen to be unchanged
+        hazard_set(record, 1, next);
+        if (head != atomic_load(&queue->head))
+        {
+            continue;
+        }
+
+        if (NULL == next)
+        {
+            hazard_clear(record, 0);
+            hazard_clear(record, 1);
+            return NULL;
+        }
+
+        if (head == tail)
+        {
+            // the tail is lagging behind the node to be dequeued
+            atomic_compare_exchange_strong(&queue->tail, &tail, next);
+            continue;
+        }
+
+        // read before the swap, after which `next` may be dequeued in turn
+        value = next->value;
+
+        if (atomic_compare_exchange_strong(&queue->head, &head, next))
+        {
+            break;
+        }
+    }
+
+    hazard_clear(record, 0);
+    hazard_clear(record, 1);
+
+    hazard_retire(record, &head->hnode, reclaim_node);
+
+    return value;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static lf_node_t* new_node(void* value)
+{
+    lf_node_t* node = malloc(sizeof(lf_node_t));
+    if (NULL == node)
+    {
+        return NULL;
+    }
+
+    atomic_init(&node->next, NULL);
+    node->value = value;
+
+    return node;
+}
+
+static lf_node_t* protect(hazard_record_t* record, size_t slot, _Atomic(lf_node_t*)* source)
+{
+    lf_node_t* node = atomic_load(source);
+    for (;;)
+    {
+        hazard_set(record, slot, node);
+
+        lf_node_t* reloaded = atomic_load(source);
+        if (reloaded == node)
+        {
+            return node;
+        }
+
+        node = reloaded;
+    }
+}
+
+static void reclaim_node(hazard_node_t* node)
+{
+    free((lf_node_t*) node);
+}
@@ -0,0 +1,80 @@
+// lf_queue.h
+// Unbounded lock-free multi-producer, multi-consumer FIFO queue.
+//
+// The queue of Michael and Scott (1996): a singly-linked list with a
+// dummy node at its head, whose `head` and `tail` pointers are each
+// advanced by compare-and-swap. A push links a new node after the last
+// and then swings `tail` to it; any thread that finds `tail` lagging
+// behind the last node helps to advance it before proceeding, so that
+// no thread ever waits for another. A pop swings `head` to the first
+// real node, which becomes the new dummy, and retires the old dummy.
+//
+// Retired nodes are reclaimed with hazard pointers (see hazard.h), which
+// also guarantee that a node is not reused while a thread about to
+// compare-and-swap a pointer to it may still hold that pointer.
+//
+// The interface follows that of queue.h, and may be used from any
+// number of threads concurrently, except for lf_queue_delete().
+
+#ifndef LF_QUEUE_H
+#define LF_QUEUE_H
+
+#include <stdbool.h>
+
+typedef struct lf_queue lf_queue_t;
+
+// The signature for the user-provided delete function.
+typedef void (*deleter_f)(void*);
+
+// lf_queue_new()
+//
+// Construct a new queue
+//
+// Arguments:
+//  deleter - the user-provided delete function
+//
+// Returns:
+//  A pointer to a newly constructed queue object on success
+//  NULL on failure
+lf_queue_t* lf_queue_new(deleter_f deleter);
+
+// lf_queue_delete()
+//
+// Delete all of the items in the queue
+// using the user-provided deleter, and
+// subsequently destroy the queue itself.
+//
+// No other thread may be accessing the queue.
+//
+// Arguments:
+//  queue - pointer to the queue object
+void lf_queue_delete(lf_queue_t* queue);
+
+// lf_queue_push()
+//
+// Insert a new item at the tail of the queue.
+//
+// Arguments:
+//  queue - pointer to the queue object
+//  value - the item to be added to the queue
+//
+// Returns:
+//  `true` if the item is successfully added to the queue
+//  `false` otherwise (invalid argument, allocation failure)
+bool lf_queue_push(lf_queue_t* queue, void* value);
+
+// lf_queue_pop()
+//
+// Remove the item at the head of the queue.
+//
+// If the queue is empty, this function returns NULL.
+//
+// Arguments:
+//  queue - pointer to the queue object
+//
+// Returns:
+//  The item removed from the queue on success
+//  NULL on failure (invalid argument, empty queue, allocation failure)
+void* lf_queue_pop(lf_queue_t* queue);
+
+#endif // LF_QUEUE_H
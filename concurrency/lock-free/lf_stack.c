@@ -0,0 +1,172 @@
+// lf_stack.c
+// Unbounded lock-free stack (last in, first out) data structure.
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "hazard.h"
+#include "lf_stack.h"
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+typedef struct lf_stack_item
+{
+    // must come first; see hazard.h
+    hazard_node_t hnode;
+
+    // Set before the item is pushed, and never changed thereafter.
+    struct lf_stack_item* next;
+    void*                 data;
+} lf_stack_item_t;
+
+struct lf_stack
+{
+    _Atomic(lf_stack_item_t*) top;
+};
+
+static lf_stack_item_t* protect_top(hazard_record_t* record, lf_stack_t* stack);
+static void reclaim_item(hazard_node_t* node);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+lf_stack_t* lf_stack_new(void)
+{
+    lf_stack_t* stack = malloc(sizeof(lf_stack_t));
+    if (NULL == stack)
+    {
+        return NULL;
+    }
+
+    atomic_init(&stack->top, NULL);
+
+    return stack;
+}
+
+bool lf_stack_delete(lf_stack_t* stack)
+{
+    if (NULL == stack || atomic_load(&stack->top) != NULL)
+    {
+        return false;
+    }
+
+    free(stack);
+
+    return true;
+}
+
+bool lf_stack_push(lf_stack_t* stack, void* data)
+{
+    if (NULL == stack)
+    {
+        return false;
+    }
+
+    lf_stack_item_t* item = malloc(sizeof(lf_stack_item_t));
+    if (NULL == item)
+    {
+        return false;
+    }
+
+    item->data = data;
+    item->next = atomic_load_explicit(&stack->top, memory_order_relaxed);
+
+    // the item is not yet shared, so no protection is needed
+    while (!atomic_compare_exchange_weak_explicit(
+        &stack->top, &item->next, item,
+        memory_order_release, memory_order_relaxed))
+        ;
+
+    return true;
+}
+
+void* lf_stack_pop(lf_stack_t* stack)
+{
+    if (NULL == stack)
+    {
+        return NULL;
+    }
+
+    hazard_record_t* record = hazard_acquire();
+    if (NULL == record)
+    {
+        return NULL;
+    }
+
+    lf_stack_item_t* top;
+    for (;;)
+    {
+        top = protect_top(record, stack);
+        if (NULL == top)
+        {
+            hazard_clear(record, 0);
+            return NULL;
+        }
+
+        // `top` cannot be freed and reused while protected,
+        // so the swap succeeds only if `next` is its successor
+        if (atomic_compare_exchange_strong(&stack->top, &top, top->next))
+        {
+            break;
+        }
+    }
+
+    hazard_clear(record, 0);
+
+    void* data = top->data;
+    hazard_retire(record, &top->hnode, reclaim_item);
+
+    return data;
+}
+
+void* lf_stack_peek(lf_stack_t* stack)
+{
+    if (NULL == stack)
+    {
+        return NULL;
+    }
+
+    hazard_record_t* record = hazard_acquire();
+    if (NULL == record)
+    {
+        return NULL;
+    }
+
+    lf_stack_item_t* top = protect_top(record, stack);
+    void* data = (NULL == top) ? NULL : top->data;
+
+    hazard_clear(record, 0);
+
+    return data;
+}
+
+bool lf_stack_empty(lf_stack_t* stack)
+{
+    return (NULL == stack) || (NULL == atomic_load(&stack->top));
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static lf_stack_item_t* protect_top(hazard_record_t* record, lf_stack_t* stack)
+{
+    lf_stack_item_t* top = atomic_load(&stack->top);
+    for (;;)
+    {
+        hazard_set(record, 0, top);
+
+        lf_stack_item_t* reloaded = atomic_load(&stack->top);
+        if (reloaded == top)
+        {
+            return top;
+        }
+
+        top = reloaded;
+    }
+}
+
+static void reclaim_item(hazard_node_t* node)
+{
+    free((lf_stack_item_t*) node);
+}
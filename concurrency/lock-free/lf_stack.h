@@ -0,0 +1,93 @@
+// lf_stack.h
+// Unbounded lock-free stack (last in, first out) data structure.
+//
+// The stack of Treiber (1986): a singly-linked list whose top is
+// replaced by compare-and-swap. A push links its node to the current
+// top and swaps it in; a pop swaps in the successor of the current top.
+//
+// A pop is exposed to the ABA problem: between reading the top and its
+// successor and swapping in the successor, the top may be popped and
+// freed, and its memory reused for a node that is pushed back on, so
+// that the swap succeeds and installs a successor that is long gone.
+// Here a pop protects the top with a hazard pointer (see hazard.h)
+// before reading its successor, so the top cannot be freed, and so
+// cannot reappear, until the pop is complete.
+//
+// The interface follows that of stack.h (lstack_t), and may be used
+// from any number of threads concurrently, except for lf_stack_delete().
+// It offers lf_stack_empty() in place of stack_count(), as maintaining
+// an exact count would add a contended read-modify-write to every
+// operation, and any count would be stale as soon as it was read.
+
+#ifndef LF_STACK_H
+#define LF_STACK_H
+
+#include <stdbool.h>
+
+typedef struct lf_stack lf_stack_t;
+
+// lf_stack_new()
+//
+// Construct a new stack data structure.
+//
+// Returns:
+//  A pointer to the newly constructed stack on success.
+//  NULL on failure.
+lf_stack_t* lf_stack_new(void);
+
+// lf_stack_delete()
+//
+// Destroy an existing stack data structure.
+//
+// As with stack_delete(), the stack does not own the data that
+// it stores, and so destruction fails if the stack is not empty;
+// users must pop and destroy the remaining items and try again.
+//
+// No other thread may be accessing the stack.
+//
+// Returns:
+//  `true` on successful destruction of the stack
+//  `false` in the event the stack is nonempty
+bool lf_stack_delete(lf_stack_t* stack);
+
+// lf_stack_push()
+//
+// Push a new item onto the top of the stack.
+//
+// Returns:
+//  `true` on successful push
+//  `false` otherwise (invalid stack, allocation failure)
+bool lf_stack_push(lf_stack_t* stack, void* data);
+
+// lf_stack_pop()
+//
+// Pop an item off the top of the stack.
+//
+// Returns:
+//  A pointer to the user data popped from the stack on success.
+//  NULL on failure (invalid stack, empty stack, allocation failure)
+void* lf_stack_pop(lf_stack_t* stack);
+
+// lf_stack_peek()
+//
+// Return the user data stored in the topmost stack
+// item without removing the item from the stack.
+//
+// Returns:
+//  A pointer to the peeked data on success
+//  NULL on failure (invalid stack, empty stack, allocation failure)
+void* lf_stack_peek(lf_stack_t* stack);
+
+// lf_stack_empty()
+//
+// Determine whether the stack is empty.
+//
+// In the event that an invalid stack pointer (`stack`)
+// is passed to this function, it returns `true`.
+//
+// Returns:
+//  `true` if the stack was empty at the time of the call
+//  `false` otherwise
+bool lf_stack_empty(lf_stack_t* stack);
+
+#endif // LF_STACK_H
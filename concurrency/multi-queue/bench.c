@@ -0,0 +1,290 @@
+// bench.c
+// Throughput and quality benchmark for the MultiQueue.
+//
+// Each thread repeatedly pops an item and pushes a new item with a
+// random key, with the queue prefilled so that it holds a steady number
+// of items. The benchmark compares a single heap behind a lock (a
+// MultiQueue with one internal heap) against MultiQueues with 2 and 4
+// heaps per thread, at 1 to 16 threads, reporting:
+//
+//  - throughput, in millions of operations per second
+//  - the mean and maximum rank error of pops, where the rank of a pop
+//    is the number of items in the queue with a strictly smaller key
+//    than the one it returned (0 for an exact priority queue)
+//
+// Rank error is measured in a second run of the same workload in which
+// each thread logs its operations, ordered by a shared sequence counter
+// (taken before each push and after each pop, so that an item is always
+// logged as pushed before it is popped). The log is then replayed in
+// sequence order against a Fenwick tree of the key counts. Because the
+// counter is not taken at the instant each operation takes effect, the
+// ranks are approximate, but they are accurate enough to compare the
+// configurations.
+//
+// Usage:
+//  ./bench [total operations per run]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "multi_queue.h"
+
+#define DEFAULT_N_OPS (1 << 21)
+#define N_PREFILL     (1 << 20)
+#define MAX_THREADS   16
+
+// Keys are drawn uniformly from [0, KEY_RANGE).
+#define KEY_BITS  20
+#define KEY_RANGE (1u << KEY_BITS)
+
+// Marks a popped key in the operation log.
+#define POP_FLAG (1ULL << 63)
+
+// ----------------------------------------------------------------------------
+// Workload
+
+typedef struct worker_args
+{
+    multi_queue_t* queue;
+    size_t         n_ops;
+    uint64_t       seed;
+
+    // If non-NULL, operations are recorded here, indexed by `sequence`.
+    uint64_t*         log;
+    atomic_size_t*    sequence;
+} worker_args_t;
+
+static uint64_t next_random(uint64_t* state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static uint64_t random_key(uint64_t* state)
+{
+    return next_random(state) >> (64 - KEY_BITS);
+}
+
+static void* worker(void* arg)
+{
+    worker_args_t* args = (worker_args_t*) arg;
+
+    uint64_t rng = args->seed;
+    for (size_t i = 0; i < args->n_ops; ++i)
+    {
+        uint64_t key;
+        if (multi_queue_pop(args->queue, &key, NULL) && args->log != NULL)
+        {
+            const size_t seq = atomic_fetch_add_explicit(args->sequence, 1, memory_order_relaxed);
+            args->log[seq] = key | POP_FLAG;
+        }
+
+        key = random_key(&rng);
+        if (args->log != NULL)
+        {
+            const size_t seq = atomic_fetch_add_explicit(args->sequence, 1, memory_order_relaxed);
+            args->log[seq] = key;
+        }
+
+        multi_queue_push(args->queue, key, NULL);
+    }
+
+    return NULL;
+}
+
+// Run the workload, returning the elapsed time in seconds.
+static double run_workload(
+    size_t         n_queues,
+    size_t         n_threads,
+    size_t         n_ops,
+    const uint64_t* prefill,
+    uint64_t*      log)
+{
+    multi_queue_t* queue = multi_queue_new(n_queues);
+    if (NULL == queue)
+    {
+        fprintf(stderr, "multi_queue_new() failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < N_PREFILL; ++i)
+    {
+        multi_queue_push(queue, prefill[i], NULL);
+    }
+
+    atomic_size_t sequence;
+    atomic_init(&sequence, 0);
+
+    pthread_t     threads[MAX_THREADS];
+    worker_args_t args[MAX_THREADS];
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        args[i].queue    = queue;
+        args[i].n_ops    = n_ops / n_threads;
+        args[i].seed     = 0x9e3779b97f4a7c15ULL*(i + 1);
+        args[i].log      = log;
+        args[i].sequence = &sequence;
+        pthread_create(&threads[i], NULL, worker, &args[i]);
+    }
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    struct timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    multi_queue_delete(queue);
+
+    return (double) (stop.tv_sec - start.tv_sec) + (double) (stop.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// ----------------------------------------------------------------------------
+// Rank Error
+
+// Fenwick (binary indexed) tree of key counts over [0, KEY_RANGE).
+static int32_t fenwick[KEY_RANGE + 1];
+
+static void fenwick_add(uint64_t key, int32_t delta)
+{
+    for (size_t i = key + 1; i <= KEY_RANGE; i += i & (~i + 1))
+    {
+        fenwick[i] += delta;
+    }
+}
+
+// The number of keys strictly less than `key`.
+static uint64_t fenwick_count_below(uint64_t key)
+{
+    int64_t sum = 0;
+    for (size_t i = key; i > 0; i -= i & (~i + 1))
+    {
+        sum += fenwick[i];
+    }
+
+    return (uint64_t) sum;
+}
+
+static void replay(
+    const uint64_t* prefill,
+    const uint64_t* log,
+    size_t          n_events,
+    double*         mean_rank,
+    uint64_t*       max_rank)
+{
+    for (size_t i = 0; i <= KEY_RANGE; ++i)
+    {
+        fenwick[i] = 0;
+    }
+
+    for (size_t i = 0; i < N_PREFILL; ++i)
+    {
+        fenwick_add(prefill[i], 1);
+    }
+
+    uint64_t n_pops = 0;
+    uint64_t total  = 0;
+    uint64_t max    = 0;
+
+    for (size_t i = 0; i < n_events; ++i)
+    {
+        const uint64_t key = log[i] & ~POP_FLAG;
+        if (0 == (log[i] & POP_FLAG))
+        {
+            fenwick_add(key, 1);
+            continue;
+        }
+
+        const uint64_t rank = fenwick_count_below(key);
+        fenwick_add(key, -1);
+
+        total += rank;
+        max    = (rank > max) ? rank : max;
+        n_pops++;
+    }
+
+    *mean_rank = (n_pops > 0) ? (double) total / (double) n_pops : 0.0;
+    *max_rank  = max;
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+static void run(
+    const char*     name,
+    size_t          n_queues,
+    size_t          n_threads,
+    size_t          n_ops,
+    const uint64_t* prefill,
+    uint64_t*       log)
+{
+    const double elapsed = run_workload(n_queues, n_threads, n_ops, prefill, NULL);
+
+    // every pop succeeds, since the queue never falls below the prefill
+    run_workload(n_queues, n_threads, n_ops, prefill, log);
+
+    const size_t n_events = 2*(n_ops / n_threads)*n_threads;
+
+    double   mean_rank;
+    uint64_t max_rank;
+    replay(prefill, log, n_events, &mean_rank, &max_rank);
+
+    printf("%8zu  %10s  %8zu  %10.2f  %10.1f  %10lu\n",
+        n_threads, name, n_queues,
+        (double) (2*n_ops) / elapsed / 1e6,
+        mean_rank, (unsigned long) max_rank);
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t n_ops = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_N_OPS;
+
+    uint64_t* prefill = malloc(N_PREFILL*sizeof(uint64_t));
+    uint64_t* log     = malloc(2*n_ops*sizeof(uint64_t));
+    if (NULL == prefill || NULL == log)
+    {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t rng = 1;
+    for (size_t i = 0; i < N_PREFILL; ++i)
+    {
+        prefill[i] = random_key(&rng);
+    }
+
+    printf("%zu operations per run, %u items held\n", n_ops, N_PREFILL);
+    printf("%8s  %10s  %8s  %10s  %10s  %10s\n",
+        "threads", "queue", "heaps", "Mops/s", "mean rank", "max rank");
+
+    for (size_t n_threads = 1; n_threads <= MAX_THREADS; n_threads *= 2)
+    {
+        run("locked", 1, n_threads, n_ops, prefill, log);
+        run("multi c=2", 2*n_threads, n_threads, n_ops, prefill, log);
+        run("multi c=4", 4*n_threads, n_threads, n_ops, prefill, log);
+    }
+
+    free(log);
+    free(prefill);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+// check.c
+// Driver program for MultiQueue tests.
+
+// attribute gnu_printf
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "multi_queue.h"
+
+#define N_THREADS          4
+#define N_ITEMS_PER_THREAD 10000
+#define N_ITEMS            (N_THREADS*N_ITEMS_PER_THREAD)
+
+// ----------------------------------------------------------------------------
+// Definitions for Testing
+
+typedef struct thread_args
+{
+    multi_queue_t* queue;
+    size_t         id;
+    atomic_int*    seen;
+} thread_args_t;
+
+static void* pusher(void* arg)
+{
+    thread_args_t* args = (thread_args_t*) arg;
+
+    for (size_t i = 0; i < N_ITEMS_PER_THREAD; ++i)
+    {
+        const uint64_t key = args->id*N_ITEMS_PER_THREAD + i;
+        if (!multi_queue_push(args->queue, key, (void*) (uintptr_t) key))
+        {
+            return (void*) 1;
+        }
+    }
+
+    return NULL;
+}
+
+static void* popper(void* arg)
+{
+    thread_args_t* args = (thread_args_t*) arg;
+
+    uint64_t key;
+    void* value;
+    while (multi_queue_pop(args->queue, &key, &value))
+    {
+        if (key >= N_ITEMS || (uintptr_t) value != key)
+        {
+            return (void*) 1;
+        }
+
+        atomic_fetch_add(&args->seen[key], 1);
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Test Cases
+
+START_TEST(test_multi_queue_new)
+{
+    ck_assert_msg(NULL == multi_queue_new(0), "multi_queue_new() accepted zero queues");
+
+    multi_queue_t* queue = multi_queue_new(8);
+    ck_assert_msg(queue != NULL, "multi_queue_new() returned NULL");
+
+    ck_assert(!multi_queue_pop(queue, NULL, NULL));
+    ck_assert_msg(!multi_queue_push(queue, UINT64_MAX, NULL), "reserved key accepted");
+
+    multi_queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_multi_queue_single)
+{
+    // with a single internal heap, the ordering is exact
+    multi_queue_t* queue = multi_queue_new(1);
+    ck_assert_msg(queue != NULL, "multi_queue_new() returned NULL");
+
+    srand(1);
+    for (int i = 0; i < 1000; ++i)
+    {
+        ck_assert(multi_queue_push(queue, (uint64_t) (rand() % 500), NULL));
+    }
+
+    uint64_t prev = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        uint64_t key;
+        ck_assert(multi_queue_pop(queue, &key, NULL));
+        ck_assert_msg(key >= prev, "items popped out of key order");
+        prev = key;
+    }
+
+    ck_assert(!multi_queue_pop(queue, NULL, NULL));
+
+    multi_queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_multi_queue_relaxed)
+{
+    // with many heaps, every item is still popped exactly once
+    multi_queue_t* queue = multi_queue_new(16);
+    ck_assert_msg(queue != NULL, "multi_queue_new() returned NULL");
+
+    for (uint64_t key = 0; key < 1000; ++key)
+    {
+        ck_assert(multi_queue_push(queue, key, (void*) (uintptr_t) key));
+    }
+
+    static int seen[1000];
+    for (int i = 0; i < 1000; ++i)
+    {
+        uint64_t key;
+        void* value;
+        ck_assert(multi_queue_pop(queue, &key, &value));
+        ck_assert(key < 1000 && (uintptr_t) value == key);
+        seen[key]++;
+    }
+
+    ck_assert(!multi_queue_pop(queue, NULL, NULL));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ck_assert_msg(1 == seen[i], "item not popped exactly once");
+    }
+
+    multi_queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_multi_queue_concurrent)
+{
+    multi_queue_t* queue = multi_queue_new(2*N_THREADS);
+    ck_assert_msg(queue != NULL, "multi_queue_new() returned NULL");
+
+    static atomic_int seen[N_ITEMS];
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        atomic_init(&seen[i], 0);
+    }
+
+    pthread_t threads[N_THREADS];
+    thread_args_t args[N_THREADS];
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        args[i].queue = queue;
+        args[i].id    = i;
+        args[i].seen  = seen;
+        ck_assert(0 == pthread_create(&threads[i], NULL, pusher, &args[i]));
+    }
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        void* result;
+        pthread_join(threads[i], &result);
+        ck_assert_msg(NULL == result, "multi_queue_push() failed");
+    }
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        ck_assert(0 == pthread_create(&threads[i], NULL, popper, &args[i]));
+    }
+
+    for (size_t i = 0; i < N_THREADS; ++i)
+    {
+        void* result;
+        pthread_join(threads[i], &result);
+        ck_assert_msg(NULL == result, "multi_queue_pop() returned a corrupt item");
+    }
+
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(1 == atomic_load(&seen[i]), "item not popped exactly once");
+    }
+
+    multi_queue_delete(queue);
+}
+END_TEST
+
+// ----------------------------------------------------------------------------
+// Infrastructure
+
+Suite* multi_queue_suite(void)
+{
+    Suite* s = suite_create("multi-queue");
+    TCase* tc_core = tcase_create("multi-queue-core");
+
+    tcase_add_test(tc_core, test_multi_queue_new);
+    tcase_add_test(tc_core, test_multi_queue_single);
+    tcase_add_test(tc_core, test_multi_queue_relaxed);
+    tcase_add_test(tc_core, test_multi_queue_concurrent);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    Suite* suite = multi_queue_suite();
+    SRunner* runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    srunner_free(runner);
+
+    return EXIT_SUCCESS;
+}
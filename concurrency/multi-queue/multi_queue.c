@@ -0,0 +1,338 @@
+// multi_queue.c
+// A concurrent relaxed priority queue (MultiQueue).
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "multi_queue.h"
+
+// The assumed size of a cache line, used to separate the heaps.
+#define CACHE_LINE_SIZE 64
+
+// The capacity of a heap when it first receives an item.
+#define INITIAL_HEAP_CAPACITY 64
+
+// The cached top key of an empty heap.
+#define EMPTY_KEY UINT64_MAX
+
+// Attempts to lock a randomly chosen heap before
+// an operation falls back to waiting for a lock.
+#define MAX_ATTEMPTS 16
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+typedef struct heap_entry
+{
+    uint64_t key;
+    void*    value;
+} heap_entry_t;
+
+// A sequential binary min-heap and its lock.
+typedef struct heap
+{
+    // Aligned so that heaps do not share cache lines.
+    _Alignas(CACHE_LINE_SIZE) pthread_mutex_t lock;
+
+    // The key of the item at the top of the heap, or EMPTY_KEY;
+    // written under the lock, and read without it.
+    _Atomic uint64_t top;
+
+    // The heap itself; guarded by `lock`.
+    heap_entry_t* entries;
+    size_t        count;
+    size_t        capacity;
+} heap_t;
+
+struct multi_queue
+{
+    // The array of `n_queues` heaps.
+    heap_t* heaps;
+    size_t  n_queues;
+};
+
+// Seeds the per-thread random number generators.
+static atomic_uint_fast64_t rng_seed = 0;
+
+// The random number generator state for the current thread.
+static _Thread_local uint64_t rng_state = 0;
+
+static heap_t* random_heap(multi_queue_t* queue);
+static uint64_t next_random(void);
+
+static bool heap_push(heap_t* heap, uint64_t key, void* value);
+static void heap_pop(heap_t* heap, uint64_t* key, void** value);
+static void publish_top(heap_t* heap);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+multi_queue_t* multi_queue_new(size_t n_queues)
+{
+    if (0 == n_queues)
+    {
+        return NULL;
+    }
+
+    multi_queue_t* queue = malloc(sizeof(multi_queue_t));
+    if (NULL == queue)
+    {
+        return NULL;
+    }
+
+    queue->heaps = aligned_alloc(CACHE_LINE_SIZE, n_queues*sizeof(heap_t));
+    if (NULL == queue->heaps)
+    {
+        free(queue);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n_queues; ++i)
+    {
+        heap_t* heap = &queue->heaps[i];
+
+        pthread_mutex_init(&heap->lock, NULL);
+        atomic_init(&heap->top, EMPTY_KEY);
+
+        heap->entries  = NULL;
+        heap->count    = 0;
+        heap->capacity = 0;
+    }
+
+    queue->n_queues = n_queues;
+
+    return queue;
+}
+
+void multi_queue_delete(multi_queue_t* queue)
+{
+    if (NULL == queue)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < queue->n_queues; ++i)
+    {
+        pthread_mutex_destroy(&queue->heaps[i].lock);
+        free(queue->heaps[i].entries);
+    }
+
+    free(queue->heaps);
+    free(queue);
+}
+
+bool multi_queue_push(multi_queue_t* queue, uint64_t key, void* value)
+{
+    if (NULL == queue || EMPTY_KEY == key)
+    {
+        return false;
+    }
+
+    // any heap will do, so take the first one that is not locked
+    heap_t* heap = random_heap(queue);
+    for (size_t i = 0; pthread_mutex_trylock(&heap->lock) != 0; ++i)
+    {
+        if (MAX_ATTEMPTS == i)
+        {
+            pthread_mutex_lock(&heap->lock);
+            break;
+        }
+
+        heap = random_heap(queue);
+    }
+
+    const bool pushed = heap_push(heap, key, value);
+    pthread_mutex_unlock(&heap->lock);
+
+    return pushed;
+}
+
+bool multi_queue_pop(multi_queue_t* queue, uint64_t* key, void** value)
+{
+    if (NULL == queue)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < MAX_ATTEMPTS; ++i)
+    {
+        // of two random heaps, pop from the one with the smaller top
+        heap_t* a = random_heap(queue);
+        heap_t* b = random_heap(queue);
+
+        const uint64_t top_a = atomic_load_explicit(&a->top, memory_order_relaxed);
+        const uint64_t top_b = atomic_load_explicit(&b->top, memory_order_relaxed);
+
+        heap_t* heap = (top_a <= top_b) ? a : b;
+        if (EMPTY_KEY == ((top_a <= top_b) ? top_a : top_b))
+        {
+            continue;
+        }
+
+        if (pthread_mutex_trylock(&heap->lock) != 0)
+        {
+            continue;
+        }
+
+        // the heap may have been emptied since its top was read
+        if (heap->count > 0)
+        {
+            heap_pop(heap, key, value);
+            pthread_mutex_unlock(&heap->lock);
+            return true;
+        }
+
+        pthread_mutex_unlock(&heap->lock);
+    }
+
+    // random choices keep finding empty or busy heaps; the queue is
+    // likely nearly empty, so look for an item in every heap in turn
+    for (size_t i = 0; i < queue->n_queues; ++i)
+    {
+        heap_t* heap = &queue->heaps[i];
+        if (EMPTY_KEY == atomic_load_explicit(&heap->top, memory_order_relaxed))
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&heap->lock);
+        if (heap->count > 0)
+        {
+            heap_pop(heap, key, value);
+            pthread_mutex_unlock(&heap->lock);
+            return true;
+        }
+        pthread_mutex_unlock(&heap->lock);
+    }
+
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static heap_t* random_heap(multi_queue_t* queue)
+{
+    // scale a 32-bit random number into [0, n_queues) without division
+    const uint64_t r = next_random() >> 32;
+    return &queue->heaps[(r*queue->n_queues) >> 32];
+}
+
+static uint64_t next_random(void)
+{
+    if (0 == rng_state)
+    {
+        // distinct, non-zero seeds for each thread
+        rng_state = (atomic_fetch_add(&rng_seed, 1) + 1)*0x9e3779b97f4a7c15ULL;
+    }
+
+    // xorshift64*
+    uint64_t x = rng_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng_state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static bool heap_push(heap_t* heap, uint64_t key, void* value)
+{
+    if (heap->count == heap->capacity)
+    {
+        const size_t capacity = (0 == heap->capacity)
+            ? INITIAL_HEAP_CAPACITY
+            : 2*heap->capacity;
+
+        heap_entry_t* entries = realloc(heap->entries, capacity*sizeof(heap_entry_t));
+        if (NULL == entries)
+        {
+            return false;
+        }
+
+        heap->entries  = entries;
+        heap->capacity = capacity;
+    }
+
+    heap_entry_t* entries = heap->entries;
+
+    // shift larger ancestors down into the hole, then fill it
+    size_t index = heap->count++;
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / 2;
+        if (entries[parent].key <= key)
+        {
+            break;
+        }
+
+        entries[index] = entries[parent];
+        index = parent;
+    }
+
+    entries[index].key   = key;
+    entries[index].value = value;
+
+    if (0 == index)
+    {
+        publish_top(heap);
+    }
+
+    return true;
+}
+
+static void heap_pop(heap_t* heap, uint64_t* key, void** value)
+{
+    heap_entry_t* entries = heap->entries;
+
+    if (key != NULL)
+    {
+        *key = entries[0].key;
+    }
+
+    if (value != NULL)
+    {
+        *value = entries[0].value;
+    }
+
+    // move the last item to the root and sift it down
+    const size_t count = --heap->count;
+    if (count > 0)
+    {
+        const heap_entry_t last = entries[count];
+
+        size_t index = 0;
+        for (;;)
+        {
+            size_t child = 2*index + 1;
+            if (child >= count)
+            {
+                break;
+            }
+
+            if (child + 1 < count && entries[child + 1].key < entries[child].key)
+            {
+                ++child;
+            }
+
+            if (last.key <= entries[child].key)
+            {
+                break;
+            }
+
+            entries[index] = entries[child];
+            index = child;
+        }
+
+        entries[index] = last;
+    }
+
+    publish_top(heap);
+}
+
+static void publish_top(heap_t* heap)
+{
+    const uint64_t top = (0 == heap->count) ? EMPTY_KEY : heap->entries[0].key;
+    atomic_store_explicit(&heap->top, top, memory_order_relaxed);
+}
@@ -0,0 +1,109 @@
+// multi_queue.h
+// A concurrent relaxed priority queue (MultiQueue).
+
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Background:
+//
+// A priority queue shared between threads is conventionally protected
+// by a single lock. Every push and pop then serializes on that lock,
+// and worse, every pop contends for the same item at the head of the
+// queue, so adding threads adds contention rather than throughput.
+//
+// Many parallel algorithms that use a priority queue (schedulers,
+// parallel shortest paths, branch-and-bound search) do not actually
+// require that each pop returns the single highest priority item;
+// returning an item that is "close to" the highest priority is enough
+// for them to make progress, at the cost of some wasted work. Relaxing
+// the ordering guarantee in this way allows the queue to be spread
+// over several independent parts.
+//
+// A MultiQueue is built from an array of ordinary sequential heaps,
+// each protected by its own lock, with typically c*T heaps for T
+// threads and a small constant c (2 to 4 works well). A push inserts
+// into a heap chosen at random. A pop chooses two heaps at random,
+// compares the keys at their tops, and pops from the one with the
+// higher priority. If the lock of a chosen heap is already held, the
+// operation simply chooses again rather than waiting, so threads
+// rarely block one another.
+//
+// The "power of two choices" keeps the tops of the heaps close to one
+// another, so the rank of the popped item (the number of items in the
+// whole queue with strictly higher priority) is small on average: it
+// is expected to be O(c*T), independent of the number of items queued.
+// The top key of each heap is cached in an atomic variable, so that
+// comparing two heaps does not require taking their locks.
+//
+// Keys are unsigned 64-bit integers, and smaller keys have higher
+// priority (i.e. this is a min-queue).
+
+// The MultiQueue.
+typedef struct multi_queue multi_queue_t;
+
+// multi_queue_new()
+//
+// Construct a new, empty MultiQueue.
+//
+// Arguments:
+//  n_queues - the number of internal heaps; c*T for T
+//             threads and a small constant c is recommended
+//
+// Returns:
+//  A pointer to a newly constructed MultiQueue on success
+//  NULL on failure (invalid argument, allocation failure)
+multi_queue_t* multi_queue_new(size_t n_queues);
+
+// multi_queue_delete()
+//
+// Destroy an existing MultiQueue.
+//
+// Values remaining in the queue are not owned by it, and are not released.
+//
+// Arguments:
+//  queue - pointer to an existing MultiQueue
+void multi_queue_delete(multi_queue_t* queue);
+
+// multi_queue_push()
+//
+// Insert an item into the MultiQueue.
+//
+// This function is threadsafe.
+//
+// Arguments:
+//  queue - pointer to an existing MultiQueue
+//  key   - the priority of the item; smaller keys have
+//          higher priority, and UINT64_MAX is reserved
+//  value - the item to insert
+//
+// Returns:
+//  `true` on successful addition of the item to the queue
+//  `false` otherwise (invalid argument, allocation failure)
+bool multi_queue_push(multi_queue_t* queue, uint64_t key, void* value);
+
+// multi_queue_pop()
+//
+// Remove an item with a small key from the MultiQueue.
+//
+// This function is threadsafe. The item removed is not necessarily
+// the one with the smallest key, but is very likely to be close to it.
+//
+// This function fails only if it observes every internal heap to be
+// empty; in the presence of concurrent pushes, it may therefore fail
+// even though the queue as a whole was never empty.
+//
+// Arguments:
+//  queue - pointer to an existing MultiQueue
+//  key   - set to the key of the removed item (may be NULL)
+//  value - set to the removed item (may be NULL)
+//
+// Returns:
+//  `true` if an item was removed
+//  `false` on failure (invalid argument, empty queue)
+bool multi_queue_pop(multi_queue_t* queue, uint64_t* key, void** value);
+
+#endif // MULTI_QUEUE_H
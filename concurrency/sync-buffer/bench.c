@@ -0,0 +1,386 @@
+// bench.c
+// Benchmarks for the synchronized bounded-buffer.
+//
+// The throughput benchmark compares the slot-array sync_buffer_t
+// against the previous linked-list implementation (reproduced below
+// as list_buffer_t), which allocated a node in every put and freed it
+// in every get.
+//
+// The latency benchmark measures the time from a put to the return of
+// the get that receives the item, for a consumer that is already
+// waiting, with spinning disabled (block immediately) and enabled.
+//
+// Usage:
+//  ./bench [total items per run]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "sync_buffer.h"
+
+#define DEFAULT_N_ITEMS  (1 << 21)
+#define BUFFER_CAPACITY  1024
+#define MAX_THREADS      32
+
+#define N_HANDOFFS       20000
+#define HANDOFF_GAP_NS   5000
+
+// ----------------------------------------------------------------------------
+// Baseline: Linked-List Buffer
+
+typedef struct list_item
+{
+    struct list_item* next;
+    void*             data;
+} list_item_t;
+
+typedef struct list_buffer
+{
+    list_item_t*    head;
+    list_item_t*    tail;
+    pthread_mutex_t lock;
+    pthread_cond_t  nonempty;
+    pthread_cond_t  nonfull;
+    size_t          count;
+    size_t          capacity;
+} list_buffer_t;
+
+static list_buffer_t* list_buffer_new(const size_t capacity)
+{
+    list_buffer_t* buffer = malloc(sizeof(list_buffer_t));
+    if (NULL == buffer)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_init(&buffer->lock, NULL);
+    pthread_cond_init(&buffer->nonempty, NULL);
+    pthread_cond_init(&buffer->nonfull, NULL);
+
+    buffer->head     = NULL;
+    buffer->tail     = NULL;
+    buffer->count    = 0;
+    buffer->capacity = capacity;
+
+    return buffer;
+}
+
+static void list_buffer_delete(list_buffer_t* buffer)
+{
+    pthread_mutex_destroy(&buffer->lock);
+    pthread_cond_destroy(&buffer->nonempty);
+    pthread_cond_destroy(&buffer->nonfull);
+    free(buffer);
+}
+
+static bool list_buffer_put(list_buffer_t* buffer, void* data)
+{
+    list_item_t* item = malloc(sizeof(list_item_t));
+    if (NULL == item)
+    {
+        return false;
+    }
+
+    item->data = data;
+    item->next = NULL;
+
+    pthread_mutex_lock(&buffer->lock);
+    while (buffer->count == buffer->capacity)
+    {
+        pthread_cond_wait(&buffer->nonfull, &buffer->lock);
+    }
+
+    if (0 == buffer->count)
+    {
+        buffer->head = item;
+    }
+    else
+    {
+        buffer->tail->next = item;
+    }
+
+    buffer->tail = item;
+    buffer->count++;
+
+    pthread_mutex_unlock(&buffer->lock);
+    pthread_cond_signal(&buffer->nonempty);
+
+    return true;
+}
+
+static void* list_buffer_get(list_buffer_t* buffer)
+{
+    pthread_mutex_lock(&buffer->lock);
+    while (0 == buffer->count)
+    {
+        pthread_cond_wait(&buffer->nonempty, &buffer->lock);
+    }
+
+    list_item_t* item = buffer->head;
+    buffer->head = item->next;
+    if (1 == buffer->count)
+    {
+        buffer->tail = NULL;
+    }
+
+    buffer->count--;
+
+    pthread_mutex_unlock(&buffer->lock);
+    pthread_cond_signal(&buffer->nonfull);
+
+    void* data = item->data;
+    free(item);
+
+    return data;
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+// The operations under test, so both buffers share one harness.
+typedef struct buffer_ops
+{
+    const char* name;
+    void* (*create)(size_t capacity);
+    void  (*destroy)(void* buffer);
+    bool  (*put)(void* buffer, void* data);
+    void* (*get)(void* buffer);
+} buffer_ops_t;
+
+typedef struct worker_args
+{
+    const buffer_ops_t* ops;
+    void*               buffer;
+    size_t              n_ops;
+} worker_args_t;
+
+static void* slot_create(size_t capacity)
+{
+    return sync_buffer_new(capacity);
+}
+
+static void slot_destroy(void* buffer)
+{
+    sync_buffer_delete((sync_buffer_t*) buffer);
+}
+
+static bool slot_put(void* buffer, void* data)
+{
+    return sync_buffer_put((sync_buffer_t*) buffer, data);
+}
+
+static void* slot_get(void* buffer)
+{
+    return sync_buffer_get((sync_buffer_t*) buffer);
+}
+
+static void* list_create(size_t capacity)
+{
+    return list_buffer_new(capacity);
+}
+
+static void list_destroy(void* buffer)
+{
+    list_buffer_delete((list_buffer_t*) buffer);
+}
+
+static bool list_put(void* buffer, void* data)
+{
+    return list_buffer_put((list_buffer_t*) buffer, data);
+}
+
+static void* list_get(void* buffer)
+{
+    return list_buffer_get((list_buffer_t*) buffer);
+}
+
+static const buffer_ops_t SLOT_OPS = {
+    "slot-array", slot_create, slot_destroy, slot_put, slot_get
+};
+
+static const buffer_ops_t LIST_OPS = {
+    "linked-list", list_create, list_destroy, list_put, list_get
+};
+
+static void* producer(void* arg)
+{
+    worker_args_t* args = (worker_args_t*) arg;
+    for (size_t i = 0; i < args->n_ops; ++i)
+    {
+        args->ops->put(args->buffer, (void*) (i + 1));
+    }
+
+    return NULL;
+}
+
+static void* consumer(void* arg)
+{
+    worker_args_t* args = (worker_args_t*) arg;
+    for (size_t i = 0; i < args->n_ops; ++i)
+    {
+        args->ops->get(args->buffer);
+    }
+
+    return NULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+// Run `n_threads` producers and `n_threads` consumers moving
+// `n_items` items in total; returns throughput in items / second.
+static double run(const buffer_ops_t* ops, size_t n_threads, size_t n_items)
+{
+    pthread_t producers[MAX_THREADS];
+    pthread_t consumers[MAX_THREADS];
+
+    void* buffer = ops->create(BUFFER_CAPACITY);
+
+    worker_args_t args = {
+        .ops    = ops,
+        .buffer = buffer,
+        .n_ops  = n_items / n_threads
+    };
+
+    const double start = now_seconds();
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        pthread_create(&producers[i], NULL, producer, &args);
+        pthread_create(&consumers[i], NULL, consumer, &args);
+    }
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    const double elapsed = now_seconds() - start;
+
+    ops->destroy(buffer);
+
+    return (double) (args.n_ops*n_threads) / elapsed;
+}
+
+// ----------------------------------------------------------------------------
+// Handoff Latency
+
+typedef struct handoff_args
+{
+    sync_buffer_t* buffer;
+    uint64_t*      latencies;
+    atomic_bool    received;
+} handoff_args_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec*1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void* handoff_consumer(void* arg)
+{
+    handoff_args_t* args = (handoff_args_t*) arg;
+    for (size_t i = 0; i < N_HANDOFFS; ++i)
+    {
+        // each item carries the time at which it was put
+        const uint64_t sent = (uint64_t) (uintptr_t) sync_buffer_get(args->buffer);
+        args->latencies[i]  = now_ns() - sent;
+
+        atomic_store(&args->received, true);
+    }
+
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b)
+{
+    const uint64_t x = *(const uint64_t*) a;
+    const uint64_t y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+// Hand off items one at a time, leaving a gap after each is received
+// so that the consumer is always waiting when the next one is put.
+static void run_handoff(const char* name, size_t spin_limit)
+{
+    pthread_t consumer_thread;
+
+    handoff_args_t args;
+    args.buffer    = sync_buffer_new(BUFFER_CAPACITY);
+    args.latencies = malloc(N_HANDOFFS*sizeof(uint64_t));
+    atomic_init(&args.received, false);
+
+    sync_buffer_set_spin(args.buffer, spin_limit);
+
+    pthread_create(&consumer_thread, NULL, handoff_consumer, &args);
+
+    for (size_t i = 0; i < N_HANDOFFS; ++i)
+    {
+        const uint64_t gap_end = now_ns() + HANDOFF_GAP_NS;
+        while (now_ns() < gap_end)
+            ;
+
+        atomic_store(&args.received, false);
+        sync_buffer_put(args.buffer, (void*) (uintptr_t) now_ns());
+
+        while (!atomic_load(&args.received))
+            ;
+    }
+
+    pthread_join(consumer_thread, NULL);
+
+    qsort(args.latencies, N_HANDOFFS, sizeof(uint64_t), compare_u64);
+
+    printf("%-16s  %10zu  %10lu  %10lu\n",
+        name,
+        spin_limit,
+        (unsigned long) args.latencies[N_HANDOFFS / 2],
+        (unsigned long) args.latencies[(N_HANDOFFS*99) / 100]);
+
+    free(args.latencies);
+    sync_buffer_delete(args.buffer);
+}
+
+// ----------------------------------------------------------------------------
+// Main
+
+int main(int argc, char* argv[])
+{
+    const size_t n_items = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_N_ITEMS;
+
+    printf("capacity %d, %zu items per run\n", BUFFER_CAPACITY, n_items);
+    printf("%8s  %16s  %16s  %8s\n",
+        "threads", "linked-list/s", "slot-array/s", "speedup");
+
+    for (size_t n_threads = 1; n_threads <= MAX_THREADS; n_threads *= 2)
+    {
+        const double list = run(&LIST_OPS, n_threads, n_items);
+        const double slot = run(&SLOT_OPS, n_threads, n_items);
+
+        printf("%8zu  %16.0f  %16.0f  %7.2fx\n",
+            n_threads, list, slot, slot / list);
+    }
+
+    printf("\n%d handoffs, %d ns apart\n", N_HANDOFFS, HANDOFF_GAP_NS);
+    printf("%-16s  %10s  %10s  %10s\n", "wait", "spin limit", "p50 (ns)", "p99 (ns)");
+
+    run_handoff("block", 0);
+    run_handoff("spin-then-block", SYNC_BUFFER_DEFAULT_SPIN);
+
+    return EXIT_SUCCESS;
+}
@@ -66,6 +66,28 @@ static void* consumer(void* arg)
     return (void*) get_count;
 }
 
+static void* batch_consumer(void* arg)
+{
+    sync_buffer_t* buffer = (sync_buffer_t*) arg;
+
+    void* items[8];
+
+    // consume until the buffer is closed and drained
+    size_t get_count = 0;
+    size_t n_got;
+    while ((n_got = sync_buffer_get_n(buffer, items, 8)) > 0)
+    {
+        for (size_t i = 0; i < n_got; ++i)
+        {
+            delete_point((point_t*) items[i]);
+        }
+
+        get_count += n_got;
+    }
+
+    return (void*) get_count;
+}
+
 // ----------------------------------------------------------------------------
 // Test Cases
 
@@ -113,6 +135,150 @@ START_TEST(test_sync_buffer)
 }
 END_TEST
 
+START_TEST(test_sync_buffer_fifo)
+{
+    const size_t capacity = 4;
+
+    sync_buffer_t* buffer = sync_buffer_new(capacity);
+    ck_assert_msg(buffer != NULL, "sync_buffer_new() returned NULL");
+
+    // cycle through the slot array several times to exercise wraparound
+    size_t next_put = 1;
+    size_t next_get = 1;
+    for (size_t round = 0; round < 3*capacity; ++round)
+    {
+        while (sync_buffer_try_put(buffer, (void*) next_put))
+        {
+            next_put++;
+        }
+
+        ck_assert_msg(next_put - next_get == capacity, "buffer accepted more than capacity items");
+
+        // drain half of the buffer, checking first-in first-out order
+        for (size_t i = 0; i < capacity / 2; ++i)
+        {
+            void* data = sync_buffer_try_get(buffer);
+            ck_assert_msg((size_t) data == next_get, "sync_buffer_try_get() returned out-of-order item");
+            next_get++;
+        }
+    }
+
+    while (next_get < next_put)
+    {
+        void* data = sync_buffer_get(buffer);
+        ck_assert_msg((size_t) data == next_get, "sync_buffer_get() returned out-of-order item");
+        next_get++;
+    }
+
+    ck_assert_msg(NULL == sync_buffer_try_get(buffer), "sync_buffer_try_get() succeeded on empty buffer");
+
+    const bool destroyed = sync_buffer_delete(buffer);
+    ck_assert_msg(destroyed, "sync_buffer_destroy() failed for expected empty buffer");
+}
+END_TEST
+
+START_TEST(test_sync_buffer_batch)
+{
+    void* in[10];
+    void* out[10];
+
+    sync_buffer_t* buffer = sync_buffer_new(16);
+    ck_assert_msg(buffer != NULL, "sync_buffer_new() returned NULL");
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        in[i] = (void*) (i + 1);
+    }
+
+    const size_t n_put = sync_buffer_put_n(buffer, in, 10);
+    ck_assert_msg(n_put == 10, "sync_buffer_put_n() inserted unexpected count");
+
+    // retrieve fewer than are available
+    const size_t n_got1 = sync_buffer_get_n(buffer, out, 4);
+    ck_assert_msg(n_got1 == 4, "sync_buffer_get_n() retrieved unexpected count");
+
+    // retrieve more than are available
+    const size_t n_got2 = sync_buffer_get_n(buffer, out + 4, 10);
+    ck_assert_msg(n_got2 == 6, "sync_buffer_get_n() retrieved unexpected count");
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        ck_assert_msg(out[i] == in[i], "sync_buffer_get_n() returned out-of-order item");
+    }
+
+    const bool destroyed = sync_buffer_delete(buffer);
+    ck_assert_msg(destroyed, "sync_buffer_destroy() failed for expected empty buffer");
+}
+END_TEST
+
+START_TEST(test_sync_buffer_timeout)
+{
+    sync_buffer_t* buffer = sync_buffer_new(4);
+    ck_assert_msg(buffer != NULL, "sync_buffer_new() returned NULL");
+
+    // empty buffer should time out
+    void* r1 = sync_buffer_get_timeout(buffer, 10);
+    ck_assert_msg(NULL == r1, "sync_buffer_get_timeout() returned data from empty buffer");
+    ck_assert_msg(!sync_buffer_drained(buffer), "open buffer reported as drained");
+
+    // nonempty buffer should not
+    ck_assert(sync_buffer_put(buffer, (void*) 42));
+    void* r2 = sync_buffer_get_timeout(buffer, 10);
+    ck_assert_msg((size_t) r2 == 42, "sync_buffer_get_timeout() failed on nonempty buffer");
+
+    const bool destroyed = sync_buffer_delete(buffer);
+    ck_assert_msg(destroyed, "sync_buffer_destroy() failed for expected empty buffer");
+}
+END_TEST
+
+START_TEST(test_sync_buffer_close)
+{
+    pthread_t consumers[CONCURRENCY_LEVEL];
+
+    sync_buffer_t* buffer = sync_buffer_new(32);
+    ck_assert_msg(buffer != NULL, "sync_buffer_new() returned NULL");
+
+    for (size_t i = 0; i < CONCURRENCY_LEVEL; ++i)
+    {
+        const int ret = pthread_create(&consumers[i], NULL, batch_consumer, buffer);
+        ck_assert(0 == ret);
+    }
+
+    // produce from this thread, then close to release the consumers
+    size_t produce_count = 0;
+    for (size_t i = 0; i < OPS_PER_THREAD; ++i)
+    {
+        void* batch[3] = { make_point(1, 1), make_point(2, 2), make_point(3, 3) };
+        produce_count += sync_buffer_put_n(buffer, batch, 3);
+    }
+
+    sync_buffer_close(buffer);
+
+    // no insertions are permitted once closed
+    point_t* rejected = make_point(4, 4);
+    ck_assert_msg(!sync_buffer_put(buffer, rejected), "sync_buffer_put() succeeded on closed buffer");
+    ck_assert_msg(!sync_buffer_try_put(buffer, rejected), "sync_buffer_try_put() succeeded on closed buffer");
+    delete_point(rejected);
+
+    size_t consume_count = 0;
+    for (size_t i = 0; i < CONCURRENCY_LEVEL; ++i)
+    {
+        void* consumer_ret;
+        pthread_join(consumers[i], &consumer_ret);
+        consume_count += (size_t) consumer_ret;
+    }
+
+    ck_assert_msg(produce_count == 3*OPS_PER_THREAD, "produce count differs from expected");
+    ck_assert_msg(consume_count == produce_count, "consume count differs from produce count");
+
+    ck_assert_msg(sync_buffer_drained(buffer), "closed, empty buffer not reported as drained");
+    ck_assert_msg(NULL == sync_buffer_get(buffer), "sync_buffer_get() returned data from drained buffer");
+
+    const bool destroyed = sync_buffer_delete(buffer);
+    ck_assert_msg(destroyed, "sync_buffer_destroy() failed for expected empty buffer");
+}
+END_TEST
+
 // ----------------------------------------------------------------------------
 // Infrastructure
  
@@ -122,6 +288,10 @@ Suite* sync_buffer_suite(void)
     TCase* tc_core = tcase_create("sync-buffer-core");
     
     tcase_add_test(tc_core, test_sync_buffer);
+    tcase_add_test(tc_core, test_sync_buffer_fifo);
+    tcase_add_test(tc_core, test_sync_buffer_batch);
+    tcase_add_test(tc_core, test_sync_buffer_timeout);
+    tcase_add_test(tc_core, test_sync_buffer_close);
 
     suite_add_tcase(s, tc_core);
     
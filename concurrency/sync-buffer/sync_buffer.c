@@ -1,31 +1,41 @@
 // sync_buffer.c
 // A general internally-synchronized bounded-buffer data structure.
 
+// clock_gettime(), pthread_condattr_setclock()
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <errno.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "sync_buffer.h"
 
-// ----------------------------------------------------------------------------
-// Internal Declarations
+#define NS_PER_MS  1000000L
+#define NS_PER_SEC 1000000000L
 
-// A single element in the internal linked list.
-typedef struct buffer_item
-{
-    // Pointer to the next item in the buffer.
-    struct buffer_item* next;
+// The minimum spin budget, regardless of the running estimate.
+#define SPIN_SLACK 16
 
-    // User-provided data.
-    void* data;
-} buffer_item_t;
+// ----------------------------------------------------------------------------
+// Internal Declarations
 
-static void put_unsafe(sync_buffer_t* buffer, buffer_item_t* item);
-static buffer_item_t* get_unsafe(sync_buffer_t* buffer);
+static void put_unsafe(sync_buffer_t* buffer, void* data);
+static void* get_unsafe(sync_buffer_t* buffer);
 
 static bool buffer_empty_unsafe(sync_buffer_t* buffer);
 static bool buffer_full_unsafe(sync_buffer_t* buffer);
 
-static buffer_item_t* new_item(void* data);
-static void destroy_item(buffer_item_t* item);
+static void spin_until_nonempty(sync_buffer_t* buffer);
+static void spin_until_nonfull(sync_buffer_t* buffer);
+static void spin_update_estimate(sync_buffer_t* buffer, size_t spins, bool ready);
+static void cpu_relax(void);
+
+static void wait_nonempty_unsafe(sync_buffer_t* buffer);
+static void wait_nonfull_unsafe(sync_buffer_t* buffer);
+
+static void notify(pthread_cond_t* cond, size_t n_items, size_t n_waiters);
+static struct timespec deadline_after(size_t timeout_ms);
 
 // ----------------------------------------------------------------------------
 // Exported
@@ -43,25 +53,54 @@ sync_buffer_t* sync_buffer_new(const size_t capacity)
         return NULL;
     }
 
+    // all of the storage the buffer will ever need is allocated here
+    void** slots = malloc(capacity*sizeof(void*));
+    if (NULL == slots)
+    {
+        free(buffer);
+        return NULL;
+    }
+
     // default initialization for mutex
     const int lock_init = pthread_mutex_init(&buffer->lock, NULL);
 
-    // default initialization for condition variables
-    const int nonempty_init = pthread_cond_init(&buffer->nonempty, NULL);
-    const int nonfull_init  = pthread_cond_init(&buffer->nonfull, NULL);\
+    // timed waits measure their deadline against the monotonic
+    // clock so that they are unaffected by changes to system time
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    const int nonempty_init = pthread_cond_init(&buffer->nonempty, &attr);
+    const int nonfull_init  = pthread_cond_init(&buffer->nonfull, &attr);
+
+    pthread_condattr_destroy(&attr);
 
     if (lock_init != 0 || nonempty_init != 0 || nonfull_init != 0)
     {
         // initialization of one or more synchronization primitives failed
+        free(slots);
         free(buffer);
         return NULL;
     }
 
-    buffer->head = NULL;
-    buffer->tail = NULL;
+    buffer->slots = slots;
+    buffer->head  = 0;
+    buffer->tail  = 0;
 
-    buffer->count    = 0;
+    atomic_init(&buffer->count, 0);
     buffer->capacity = capacity;
+    buffer->closed   = false;
+
+    buffer->n_waiting_consumers = 0;
+    buffer->n_waiting_producers = 0;
+
+    // spinning is pointless if the thread we wait on cannot run concurrently
+    const size_t spin_limit = (sysconf(_SC_NPROCESSORS_ONLN) > 1)
+        ? SYNC_BUFFER_DEFAULT_SPIN
+        : 0;
+
+    atomic_init(&buffer->spin_limit, spin_limit);
+    atomic_init(&buffer->spin_estimate, spin_limit / 2);
 
     return buffer;
 }
@@ -83,6 +122,7 @@ bool sync_buffer_delete(sync_buffer_t* buffer)
     pthread_cond_destroy(&buffer->nonempty);
     pthread_cond_destroy(&buffer->nonfull);
 
+    free(buffer->slots);
     free(buffer);
 
     return true;
@@ -95,29 +135,35 @@ bool sync_buffer_put(sync_buffer_t* buffer, void* data)
         return false;
     }
 
-    buffer_item_t* item = new_item(data);
-    if (NULL == item)
-    {
-        return false;
-    }
+    // the buffer may become nonfull before it is worth blocking
+    spin_until_nonfull(buffer);
 
     // acquire exclusive access to the buffer
     pthread_mutex_lock(&buffer->lock);
 
     // block until the buffer is nonfull
-    while (buffer_full_unsafe(buffer))
+    while (buffer_full_unsafe(buffer) && !buffer->closed)
+    {
+        wait_nonfull_unsafe(buffer);
+    }
+
+    if (buffer->closed)
     {
-        pthread_cond_wait(&buffer->nonfull, &buffer->lock);
+        // buffer was closed, possibly while we were blocked
+        pthread_mutex_unlock(&buffer->lock);
+        return false;
     }
 
     // buffer is now nonfull and we have exclusive access;
-    put_unsafe(buffer, item);
+    put_unsafe(buffer, data);
+
+    const size_t n_waiters = buffer->n_waiting_consumers;
 
     // release exclusive access to the buffer
     pthread_mutex_unlock(&buffer->lock);
 
     // notify consumers that item has been added
-    pthread_cond_signal(&buffer->nonempty);
+    notify(&buffer->nonempty, 1, n_waiters);
 
     return true;
 }
@@ -129,32 +175,27 @@ bool sync_buffer_try_put(sync_buffer_t* buffer, void* data)
         return false;
     }
 
-    buffer_item_t* item = new_item(data);
-    if (NULL == item)
-    {
-        return false;
-    }
-
     // acquire exclusive access to the buffer
     pthread_mutex_lock(&buffer->lock);
 
     // determine if buffer is full
-    if (buffer_full_unsafe(buffer))
+    if (buffer_full_unsafe(buffer) || buffer->closed)
     {
-        // buffer is full, bail on put operation
+        // buffer is full or closed, bail on put operation
         pthread_mutex_unlock(&buffer->lock);
-        free(item);
         return false;
     }
 
     // buffer is nonfull and we have exclusive access
-    put_unsafe(buffer, item);
+    put_unsafe(buffer, data);
+
+    const size_t n_waiters = buffer->n_waiting_consumers;
 
     // release exclusive access to the buffer
     pthread_mutex_unlock(&buffer->lock);
 
     // notify consumers that item has been added
-    pthread_cond_signal(&buffer->nonempty);
+    notify(&buffer->nonempty, 1, n_waiters);
 
     return true;
 }
@@ -166,26 +207,35 @@ void* sync_buffer_get(sync_buffer_t* buffer)
         return NULL;
     }
 
+    // the buffer may become nonempty before it is worth blocking
+    spin_until_nonempty(buffer);
+
     // acquire exclusive access to the buffer
     pthread_mutex_lock(&buffer->lock);
 
     // block until buffer is nonempty
-    while (buffer_empty_unsafe(buffer))
+    while (buffer_empty_unsafe(buffer) && !buffer->closed)
     {
-        pthread_cond_wait(&buffer->nonempty, &buffer->lock);
+        wait_nonempty_unsafe(buffer);
+    }
+
+    if (buffer_empty_unsafe(buffer))
+    {
+        // buffer is closed and drained
+        pthread_mutex_unlock(&buffer->lock);
+        return NULL;
     }
 
     // buffer is now nonempty and we have exclusive access;
-    buffer_item_t* item = get_unsafe(buffer);
+    void* data = get_unsafe(buffer);
+
+    const size_t n_waiters = buffer->n_waiting_producers;
 
     // release exclusive access to the buffer
     pthread_mutex_unlock(&buffer->lock);
 
     // notify producers that item was removed
-    pthread_cond_signal(&buffer->nonfull);
-
-    void* data = item->data;
-    destroy_item(item);
+    notify(&buffer->nonfull, 1, n_waiters);
 
     return data;
 }
@@ -209,87 +259,385 @@ void* sync_buffer_try_get(sync_buffer_t* buffer)
     }
 
     // buffer is nonempty and we have exclusive access;
-    buffer_item_t* item = get_unsafe(buffer);
+    void* data = get_unsafe(buffer);
+
+    const size_t n_waiters = buffer->n_waiting_producers;
 
     // release exclusive access to the buffer
     pthread_mutex_unlock(&buffer->lock);
 
     // notify producers that item was removed
-    pthread_cond_signal(&buffer->nonfull);
+    notify(&buffer->nonfull, 1, n_waiters);
+
+    return data;
+}
+
+size_t sync_buffer_put_n(sync_buffer_t* buffer, void* items[], size_t n)
+{
+    if (NULL == buffer || NULL == items || 0 == n)
+    {
+        return 0;
+    }
+
+    size_t inserted = 0;
 
-    void* data = item->data;
-    destroy_item(item);
+    // the buffer may become nonfull before it is worth blocking
+    spin_until_nonfull(buffer);
+
+    // acquire exclusive access to the buffer
+    pthread_mutex_lock(&buffer->lock);
+
+    while (inserted < n)
+    {
+        // block until the buffer is nonfull
+        while (buffer_full_unsafe(buffer) && !buffer->closed)
+        {
+            wait_nonfull_unsafe(buffer);
+        }
+
+        if (buffer->closed)
+        {
+            break;
+        }
+
+        // insert as much of the remainder as the buffer has room for
+        const size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+
+        size_t batch = buffer->capacity - count;
+        if (batch > n - inserted)
+        {
+            batch = n - inserted;
+        }
+
+        for (size_t i = 0; i < batch; ++i)
+        {
+            put_unsafe(buffer, items[inserted + i]);
+        }
+
+        inserted += batch;
+
+        // notify consumers now rather than after the loop; we may
+        // block again below, waiting for them to make room
+        notify(&buffer->nonempty, batch, buffer->n_waiting_consumers);
+    }
+
+    // release exclusive access to the buffer
+    pthread_mutex_unlock(&buffer->lock);
+
+    return inserted;
+}
+
+size_t sync_buffer_get_n(sync_buffer_t* buffer, void* items[], size_t n)
+{
+    if (NULL == buffer || NULL == items || 0 == n)
+    {
+        return 0;
+    }
+
+    // the buffer may become nonempty before it is worth blocking
+    spin_until_nonempty(buffer);
+
+    // acquire exclusive access to the buffer
+    pthread_mutex_lock(&buffer->lock);
+
+    // block until buffer is nonempty
+    while (buffer_empty_unsafe(buffer) && !buffer->closed)
+    {
+        wait_nonempty_unsafe(buffer);
+    }
+
+    // take everything that is available, up to `n`
+    const size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    const size_t batch = (count < n) ? count : n;
+    for (size_t i = 0; i < batch; ++i)
+    {
+        items[i] = get_unsafe(buffer);
+    }
+
+    const size_t n_waiters = buffer->n_waiting_producers;
+
+    // release exclusive access to the buffer
+    pthread_mutex_unlock(&buffer->lock);
+
+    // notify producers that items were removed
+    notify(&buffer->nonfull, batch, n_waiters);
+
+    return batch;
+}
+
+void* sync_buffer_get_timeout(sync_buffer_t* buffer, size_t timeout_ms)
+{
+    if (0 == timeout_ms)
+    {
+        return sync_buffer_try_get(buffer);
+    }
+
+    if (NULL == buffer)
+    {
+        return NULL;
+    }
+
+    // compute the deadline before contending for the lock
+    const struct timespec deadline = deadline_after(timeout_ms);
+
+    // acquire exclusive access to the buffer
+    pthread_mutex_lock(&buffer->lock);
+
+    // block until buffer is nonempty or the deadline passes
+    while (buffer_empty_unsafe(buffer) && !buffer->closed)
+    {
+        buffer->n_waiting_consumers++;
+        const int r = pthread_cond_timedwait(
+            &buffer->nonempty, &buffer->lock, &deadline);
+        buffer->n_waiting_consumers--;
+
+        if (ETIMEDOUT == r)
+        {
+            break;
+        }
+    }
+
+    if (buffer_empty_unsafe(buffer))
+    {
+        // timed out, or buffer is closed and drained
+        pthread_mutex_unlock(&buffer->lock);
+        return NULL;
+    }
+
+    // buffer is now nonempty and we have exclusive access;
+    void* data = get_unsafe(buffer);
+
+    const size_t n_waiters = buffer->n_waiting_producers;
+
+    // release exclusive access to the buffer
+    pthread_mutex_unlock(&buffer->lock);
+
+    // notify producers that item was removed
+    notify(&buffer->nonfull, 1, n_waiters);
 
     return data;
 }
 
+void sync_buffer_close(sync_buffer_t* buffer)
+{
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&buffer->lock);
+    buffer->closed = true;
+    pthread_mutex_unlock(&buffer->lock);
+
+    // wake every blocked thread so that it observes the closure
+    pthread_cond_broadcast(&buffer->nonempty);
+    pthread_cond_broadcast(&buffer->nonfull);
+}
+
+void sync_buffer_set_spin(sync_buffer_t* buffer, size_t spin_limit)
+{
+    if (NULL == buffer)
+    {
+        return;
+    }
+
+    atomic_store_explicit(&buffer->spin_limit, spin_limit, memory_order_relaxed);
+    atomic_store_explicit(&buffer->spin_estimate, spin_limit / 2, memory_order_relaxed);
+}
+
+bool sync_buffer_drained(sync_buffer_t* buffer)
+{
+    if (NULL == buffer)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&buffer->lock);
+    const bool drained = buffer->closed && buffer_empty_unsafe(buffer);
+    pthread_mutex_unlock(&buffer->lock);
+
+    return drained;
+}
+
 // ----------------------------------------------------------------------------
 // Internal
 
-static void put_unsafe(sync_buffer_t* buffer, buffer_item_t* item)
+static void put_unsafe(sync_buffer_t* buffer, void* data)
 {
     // insert at the tail of the buffer
-    
-    if (buffer_empty_unsafe(buffer))
+
+    buffer->slots[buffer->tail] = data;
+
+    // advance the tail, wrapping around the end of the slot array
+    if (++buffer->tail == buffer->capacity)
     {
-        // only need to touch head if buffer is empty
-        buffer->head = item;
+        buffer->tail = 0;
     }
-    else
+
+    // only ever modified under the lock; the atomic store
+    // publishes the new count to threads spinning without it
+    const size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    atomic_store_explicit(&buffer->count, count + 1, memory_order_relaxed);
+}
+
+static void* get_unsafe(sync_buffer_t* buffer)
+{
+    // remove from the head of the buffer
+
+    void* data = buffer->slots[buffer->head];
+
+    // advance the head, wrapping around the end of the slot array
+    if (++buffer->head == buffer->capacity)
     {
-        // in general case of nonempty buffer, update the
-        // next point for the current tail
-        buffer->tail->next = item;
+        buffer->head = 0;
     }
 
-    item->next   = NULL;
-    buffer->tail = item;
+    const size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    atomic_store_explicit(&buffer->count, count - 1, memory_order_relaxed);
 
-    buffer->count++;
+    return data;
 }
 
-static buffer_item_t* get_unsafe(sync_buffer_t* buffer)
+static bool buffer_empty_unsafe(sync_buffer_t* buffer)
 {
-    // remove from the head of the buffer 
+    return 0 == atomic_load_explicit(&buffer->count, memory_order_relaxed);
+}
 
-    buffer_item_t* item = buffer->head;
+static bool buffer_full_unsafe(sync_buffer_t* buffer)
+{
+    return atomic_load_explicit(&buffer->count, memory_order_relaxed) == buffer->capacity;
+}
 
-    if (1 == buffer->count)
+static void spin_until_nonempty(sync_buffer_t* buffer)
+{
+    const size_t limit = atomic_load_explicit(&buffer->spin_limit, memory_order_relaxed);
+    if (0 == limit)
     {
-        // only need to touch tail pointer when buffer will become empty
-        buffer->tail = NULL;
+        return;
     }
 
-    buffer->head = item->next;
+    // spin for up to twice the current estimate of the wait
+    const size_t estimate = atomic_load_explicit(&buffer->spin_estimate, memory_order_relaxed);
+    const size_t budget   = (2*estimate + SPIN_SLACK < limit) ? 2*estimate + SPIN_SLACK : limit;
 
-    buffer->count--;
+    // the count is read atomically, so it may be polled without the lock
+    size_t spins = 0;
+    while (buffer_empty_unsafe(buffer) && spins < budget)
+    {
+        cpu_relax();
+        ++spins;
+    }
 
-    return item;
+    spin_update_estimate(buffer, spins, !buffer_empty_unsafe(buffer));
 }
 
-static bool buffer_empty_unsafe(sync_buffer_t* buffer)
+static void spin_until_nonfull(sync_buffer_t* buffer)
 {
-    return 0 == buffer->count; 
+    const size_t limit = atomic_load_explicit(&buffer->spin_limit, memory_order_relaxed);
+    if (0 == limit)
+    {
+        return;
+    }
+
+    // spin for up to twice the current estimate of the wait
+    const size_t estimate = atomic_load_explicit(&buffer->spin_estimate, memory_order_relaxed);
+    const size_t budget   = (2*estimate + SPIN_SLACK < limit) ? 2*estimate + SPIN_SLACK : limit;
+
+    // the count is read atomically, so it may be polled without the lock
+    size_t spins = 0;
+    while (buffer_full_unsafe(buffer) && spins < budget)
+    {
+        cpu_relax();
+        ++spins;
+    }
+
+    spin_update_estimate(buffer, spins, !buffer_full_unsafe(buffer));
 }
 
-static bool buffer_full_unsafe(sync_buffer_t* buffer)
+static void spin_update_estimate(sync_buffer_t* buffer, size_t spins, bool ready)
 {
-    return buffer->count == buffer->capacity;
+    if (0 == spins)
+    {
+        // did not need to wait at all; nothing learned
+        return;
+    }
+
+    // updates from concurrent spinners may be lost; that is fine for an estimate
+    const size_t estimate = atomic_load_explicit(&buffer->spin_estimate, memory_order_relaxed);
+
+    size_t updated;
+    if (ready)
+    {
+        // spinning paid off; move the estimate 1/8 of the way toward this wait
+        updated = (spins > estimate)
+            ? estimate + (spins - estimate) / 8
+            : estimate - (estimate - spins) / 8;
+    }
+    else
+    {
+        // the wait outlasted the spin, which was wasted; back off
+        updated = estimate / 2;
+    }
+
+    atomic_store_explicit(&buffer->spin_estimate, updated, memory_order_relaxed);
+}
+
+static void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static void wait_nonempty_unsafe(sync_buffer_t* buffer)
+{
+    // register as a waiter so that producers know to signal us
+    buffer->n_waiting_consumers++;
+    pthread_cond_wait(&buffer->nonempty, &buffer->lock);
+    buffer->n_waiting_consumers--;
+}
+
+static void wait_nonfull_unsafe(sync_buffer_t* buffer)
+{
+    // register as a waiter so that consumers know to signal us
+    buffer->n_waiting_producers++;
+    pthread_cond_wait(&buffer->nonfull, &buffer->lock);
+    buffer->n_waiting_producers--;
 }
 
-static buffer_item_t* new_item(void* data)
+static void notify(pthread_cond_t* cond, size_t n_items, size_t n_waiters)
 {
-    buffer_item_t* item = malloc(sizeof(buffer_item_t));
-    if (NULL == item)
+    // skip the signal entirely when no thread is blocked; otherwise
+    // one waiter can make use of one item, so wake them all for a batch
+    if (0 == n_waiters || 0 == n_items)
     {
-        return NULL;
+        return;
     }
 
-    item->data = data;
-    return item;
+    if (n_items > 1 && n_waiters > 1)
+    {
+        pthread_cond_broadcast(cond);
+    }
+    else
+    {
+        pthread_cond_signal(cond);
+    }
 }
 
-static void destroy_item(buffer_item_t* item)
+static struct timespec deadline_after(size_t timeout_ms)
 {
-    free(item);
-}
\ No newline at end of file
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    deadline.tv_sec  += (time_t) (timeout_ms / 1000);
+    deadline.tv_nsec += (long) (timeout_ms % 1000)*NS_PER_MS;
+    if (deadline.tv_nsec >= NS_PER_SEC)
+    {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= NS_PER_SEC;
+    }
+
+    return deadline;
+}
@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 // Background:
 //
@@ -85,6 +86,41 @@
 // semantics and thus behave functionally identically to a 
 // synchronized queue.
 //
+// NOTE: Because the capacity of the buffer is fixed at construction,
+// this implementation preallocates a circular array of slots in
+// sync_buffer_new() rather than allocating a list node for each
+// inserted item. The put() and get() paths therefore never touch
+// the heap, and allocation failure is only possible at construction.
+//
+// NOTE: In addition to the fundamental API, this implementation
+// supports a number of extensions:
+//
+// - put_n() and get_n() move multiple items per acquisition of the
+//   internal lock, amortizing lock and condition variable traffic
+//   across a batch when message rates are high.
+//
+// - get_timeout() bounds the time the calling thread spends blocked
+//   waiting for the buffer to become nonempty.
+//
+// - close() marks the buffer as closed: subsequent put operations
+//   fail, and blocked consumers are woken. Consumers continue to
+//   retrieve the items that remain in the buffer, and once it is
+//   drained, get operations return immediately with NULL. This
+//   allows consumers to exit cleanly without the producer inserting
+//   a "poison pill" item for each of them.
+//
+// NOTE: When the buffer is typically handed items within a few
+// microseconds of a consumer arriving, the cost of blocking in
+// pthread_cond_wait() and being woken by the kernel dominates the
+// latency of a handoff. For this reason, the blocking put and get
+// operations first spin for a bounded number of iterations, polling
+// the count of items in the buffer, and only block on the condition
+// variable if the wait outlasts the spin. The number of iterations
+// adapts to the waits observed on the buffer, and is bounded above
+// by a limit that may be adjusted with sync_buffer_set_spin(). Both
+// operations also track the number of blocked threads, so that the
+// (comparatively expensive) signal is skipped when nobody is waiting.
+//
 // NOTE: The declaration of the sync_buffer type below
 // presumes the use of the pthread API for multithreaded
 // programming. This is not strictly necessary, and 
@@ -94,14 +130,18 @@
 // the C11 thread support library in both volume and quality,
 // so I chose to use pthreads for the purposes of this module.
 
-struct buffer_item;
+// The default upper bound on spin iterations prior to blocking.
+#define SYNC_BUFFER_DEFAULT_SPIN 1024
 
 // The synchronized buffer data structure.
 typedef struct sync_buffer {
 
-    // Head and tail pointers for internal linked-list.
-    struct buffer_item* head;
-    struct buffer_item* tail;
+    // Preallocated circular array of `capacity` slots.
+    void** slots;
+
+    // Index of the oldest item (next get) and the next free slot (next put).
+    size_t head;
+    size_t tail;
 
     // The lock that guards exclusive access to the buffer.
     pthread_mutex_t lock;
@@ -112,11 +152,28 @@ typedef struct sync_buffer {
     // Signaled when an item is removed from the buffer.
     pthread_cond_t nonfull;
 
-    // The current count of items in the buffer.
-    size_t count;
+    // The current count of items in the buffer. Modified only while
+    // holding `lock`, but read without it by spinning threads.
+    atomic_size_t count;
 
     // The maximum capacity of the buffer.
     size_t capacity;
+
+    // Set by sync_buffer_close(); no further items may be inserted.
+    bool closed;
+
+    // The number of threads blocked on `nonempty` and `nonfull`,
+    // respectively; the condition variables are only signaled
+    // when the corresponding count is nonzero.
+    size_t n_waiting_consumers;
+    size_t n_waiting_producers;
+
+    // The maximum number of iterations a thread spins before blocking.
+    atomic_size_t spin_limit;
+
+    // A running estimate of the number of iterations for which
+    // a spinning thread must wait before it is able to proceed.
+    atomic_size_t spin_estimate;
 } sync_buffer_t;
 
 // sync_buffer_new()
@@ -176,7 +233,7 @@ bool sync_buffer_delete(sync_buffer_t* buffer);
 //
 // Returns:
 //  `true` if the new item is successfully inserted
-//  `false` on failure (allocation failure)
+//  `false` on failure (invalid argument, buffer closed)
 bool sync_buffer_put(sync_buffer_t* buffer, void* data);
 
 // sync_buffer_try_put()
@@ -215,6 +272,7 @@ bool sync_buffer_try_put(sync_buffer_t* buffer, void* data);
 //
 // Returns:
 //  A pointer to the user data retrieved from the buffer
+//  NULL if the buffer is closed and drained
 void* sync_buffer_get(sync_buffer_t* buffer);
 
 // sync_buffer_try_put()
@@ -235,4 +293,114 @@ void* sync_buffer_get(sync_buffer_t* buffer);
 //  NULL if no data is retrieved from buffer 
 void* sync_buffer_try_get(sync_buffer_t* buffer);
 
+// sync_buffer_put_n()
+//
+// Insert `n` items into the synchronized buffer.
+//
+// This function is threadsafe. It behaves like a sequence
+// of `n` calls to sync_buffer_put(), but inserts as many
+// items as the buffer has room for each time it acquires
+// exclusive access to the buffer, rather than just one.
+// In the event that the buffer becomes full before all
+// `n` items are inserted, this function blocks until room
+// is available for the remainder. The items are inserted
+// in order, but items from concurrent producers may be
+// interleaved between batches.
+//
+// Arguments:
+//  buffer - pointer to an existing buffer data structure
+//  items  - array of `n` user-provided data items to insert
+//  n      - the number of items to insert
+//
+// Returns:
+//  The number of items inserted; this is less than `n`
+//  only if the buffer is closed while the call is blocked
+size_t sync_buffer_put_n(sync_buffer_t* buffer, void* items[], size_t n);
+
+// sync_buffer_get_n()
+//
+// Retrieve up to `n` items from the synchronized buffer.
+//
+// This function is threadsafe. It blocks until the buffer
+// is nonempty, and then removes as many items as are
+// available, up to `n`, in a single acquisition of
+// exclusive access to the buffer.
+//
+// Arguments:
+//  buffer - pointer to an existing buffer data structure
+//  items  - array of at least `n` slots to receive the items
+//  n      - the maximum number of items to retrieve
+//
+// Returns:
+//  The number of items retrieved (at least 1)
+//  0 on failure (invalid argument, buffer closed and drained)
+size_t sync_buffer_get_n(sync_buffer_t* buffer, void* items[], size_t n);
+
+// sync_buffer_get_timeout()
+//
+// Retrieve data from the synchronized buffer, blocking
+// for at most `timeout_ms` milliseconds.
+//
+// This function is threadsafe. It behaves like sync_buffer_get(),
+// except that it gives up and returns NULL if the buffer remains
+// empty for the duration of the timeout. A timeout of 0 behaves
+// like sync_buffer_try_get().
+//
+// Arguments:
+//  buffer     - pointer to an existing buffer data structure
+//  timeout_ms - the maximum time to block, in milliseconds
+//
+// Returns:
+//  A pointer to the user data retrieved from the buffer
+//  NULL on timeout, or if the buffer is closed and drained
+void* sync_buffer_get_timeout(sync_buffer_t* buffer, size_t timeout_ms);
+
+// sync_buffer_close()
+//
+// Close the synchronized buffer to further insertions.
+//
+// This function is threadsafe. After it returns, all put
+// operations on the buffer fail, and producers blocked in
+// a put operation wake and return failure. Consumers blocked
+// in a get operation wake and either retrieve one of the
+// items that remain in the buffer or, once it is drained,
+// return NULL. Closing a closed buffer has no effect.
+//
+// Arguments:
+//  buffer - pointer to an existing buffer data structure
+void sync_buffer_close(sync_buffer_t* buffer);
+
+// sync_buffer_set_spin()
+//
+// Set the maximum number of iterations for which a thread
+// blocking in a put or get operation spins before it blocks.
+//
+// This function is threadsafe. A limit of 0 disables spinning,
+// such that threads block immediately; this is appropriate when
+// producers and consumers compete for the same processor. The
+// default limit is SYNC_BUFFER_DEFAULT_SPIN on multiprocessor
+// systems and 0 on uniprocessor systems.
+//
+// Arguments:
+//  buffer     - pointer to an existing buffer data structure
+//  spin_limit - the maximum number of spin iterations
+void sync_buffer_set_spin(sync_buffer_t* buffer, size_t spin_limit);
+
+// sync_buffer_drained()
+//
+// Determine if the synchronized buffer is closed and empty.
+//
+// This function is threadsafe. Because a drained buffer can never
+// again become nonempty, a consumer that receives NULL from a get
+// operation may use this function to distinguish the end of the
+// stream from a NULL item or a timeout.
+//
+// Arguments:
+//  buffer - pointer to an existing buffer data structure
+//
+// Returns:
+//  `true` if the buffer is closed and contains no items
+//  `false` otherwise
+bool sync_buffer_drained(sync_buffer_t* buffer);
+
 #endif // SYNC_BUFFER_H
\ No newline at end of file
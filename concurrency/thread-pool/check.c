@@ -0,0 +1,156 @@
+// check.c
+// Driver program for thread pool executor tests.
+
+// attribute gnu_printf
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "thread_pool.h"
+
+#define N_WORKERS      4
+#define QUEUE_CAPACITY 8
+#define N_TASKS        200
+
+// ----------------------------------------------------------------------------
+// Definitions for Testing
+
+static void* square(void* arg)
+{
+    const uintptr_t n = (uintptr_t) arg;
+    return (void*) (n*n);
+}
+
+static void* increment(void* arg)
+{
+    atomic_size_t* counter = (atomic_size_t*) arg;
+    atomic_fetch_add(counter, 1);
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Test Cases
+
+START_TEST(test_pool_new)
+{
+    thread_pool_t* pool = pool_new(N_WORKERS, QUEUE_CAPACITY);
+    ck_assert_msg(pool != NULL, "pool_new() returned NULL");
+    ck_assert_msg(pool_size(pool) == N_WORKERS, "pool_size() returned incorrect value");
+
+    ck_assert_msg(NULL == pool_new(0, QUEUE_CAPACITY), "pool_new() succeeded with no workers");
+    ck_assert_msg(NULL == pool_new(N_WORKERS, 0), "pool_new() succeeded with no queue capacity");
+
+    pool_delete(pool);
+}
+END_TEST
+
+START_TEST(test_pool_submit_join)
+{
+    future_t* futures[N_TASKS];
+
+    thread_pool_t* pool = pool_new(N_WORKERS, QUEUE_CAPACITY);
+    ck_assert_msg(pool != NULL, "pool_new() returned NULL");
+
+    // submit more tasks than the queue holds to exercise backpressure
+    for (uintptr_t i = 0; i < N_TASKS; ++i)
+    {
+        futures[i] = pool_submit(pool, square, (void*) i);
+        ck_assert_msg(futures[i] != NULL, "pool_submit() returned NULL");
+    }
+
+    for (uintptr_t i = 0; i < N_TASKS; ++i)
+    {
+        void* result = future_join(futures[i]);
+        ck_assert_msg((uintptr_t) result == i*i, "future_join() returned incorrect result");
+    }
+
+    pool_delete(pool);
+}
+END_TEST
+
+START_TEST(test_pool_execute_drain)
+{
+    atomic_size_t counter;
+    atomic_init(&counter, 0);
+
+    thread_pool_t* pool = pool_new(N_WORKERS, QUEUE_CAPACITY);
+    ck_assert_msg(pool != NULL, "pool_new() returned NULL");
+
+    for (size_t i = 0; i < N_TASKS; ++i)
+    {
+        ck_assert_msg(pool_execute(pool, increment, &counter), "pool_execute() failed");
+    }
+
+    // deletion runs every task that was submitted before returning
+    pool_delete(pool);
+
+    ck_assert_msg(atomic_load(&counter) == N_TASKS, "pool_delete() did not drain submitted tasks");
+}
+END_TEST
+
+START_TEST(test_pool_worker_stats)
+{
+    future_t* futures[N_TASKS];
+
+    thread_pool_t* pool = pool_new(N_WORKERS, QUEUE_CAPACITY);
+    ck_assert_msg(pool != NULL, "pool_new() returned NULL");
+
+    for (uintptr_t i = 0; i < N_TASKS; ++i)
+    {
+        futures[i] = pool_submit(pool, square, (void*) i);
+        ck_assert_msg(futures[i] != NULL, "pool_submit() returned NULL");
+    }
+
+    for (size_t i = 0; i < N_TASKS; ++i)
+    {
+        future_join(futures[i]);
+    }
+
+    // every joined task is accounted to exactly one worker
+    uint64_t total = 0;
+    for (size_t i = 0; i < pool_size(pool); ++i)
+    {
+        const worker_stats_t stats = pool_worker_stats(pool, i);
+        total += stats.n_tasks;
+    }
+
+    ck_assert_msg(total == N_TASKS, "pool_worker_stats() task counts differ from expected");
+
+    const worker_stats_t invalid = pool_worker_stats(pool, N_WORKERS);
+    ck_assert_msg(0 == invalid.n_tasks, "pool_worker_stats() returned data for invalid worker");
+
+    pool_delete(pool);
+}
+END_TEST
+
+// ----------------------------------------------------------------------------
+// Infrastructure
+ 
+Suite* thread_pool_suite(void)
+{
+    Suite* s = suite_create("thread-pool");
+    TCase* tc_core = tcase_create("thread-pool-core");
+    
+    tcase_add_test(tc_core, test_pool_new);
+    tcase_add_test(tc_core, test_pool_submit_join);
+    tcase_add_test(tc_core, test_pool_execute_drain);
+    tcase_add_test(tc_core, test_pool_worker_stats);
+
+    suite_add_tcase(s, tc_core);
+    
+    return s;
+}
+
+int main(void)
+{
+    Suite* suite = thread_pool_suite();
+    SRunner* runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);    
+    srunner_free(runner);
+    
+    return EXIT_SUCCESS;
+}
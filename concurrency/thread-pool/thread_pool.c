@@ -0,0 +1,352 @@
+// thread_pool.c
+// A fixed-size thread pool executor built on the synchronized buffer.
+
+// clock_gettime()
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "sync_buffer.h"
+#include "thread_pool.h"
+
+// The assumed size of a cache line, used to separate per-worker state.
+#define CACHE_LINE_SIZE 64
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+// A submitted task; doubles as the future returned to the submitter.
+struct future
+{
+    // The task and its argument.
+    task_f fn;
+    void*  arg;
+
+    // The value returned by the task, valid once `done` is set.
+    void* result;
+
+    // The time at which the task was submitted.
+    uint64_t submitted_ns;
+
+    // Set if no future was returned, so the worker releases the task.
+    bool detached;
+
+    // Set when the task has run; guarded by `lock`.
+    bool done;
+
+    // Synchronizes completion of the task with future_join().
+    pthread_mutex_t lock;
+    pthread_cond_t  completed;
+};
+
+// The state maintained for each worker.
+typedef struct worker
+{
+    // Aligned so that workers do not share cache lines.
+    _Alignas(CACHE_LINE_SIZE) pthread_t thread;
+
+    // The pool to which the worker belongs.
+    struct thread_pool* pool;
+
+    // Statistics, written only by the worker itself.
+    _Atomic uint64_t n_tasks;
+    _Atomic uint64_t idle_ns;
+    _Atomic uint64_t busy_ns;
+    _Atomic uint64_t queue_wait_ns;
+} worker_t;
+
+struct thread_pool
+{
+    // The queue of submitted tasks.
+    sync_buffer_t* queue;
+
+    // The array of `n_workers` workers.
+    worker_t* workers;
+    size_t    n_workers;
+};
+
+static void* worker_main(void* arg);
+
+static future_t* new_future(task_f fn, void* arg, bool detached);
+static void delete_future(future_t* future);
+static void complete_future(future_t* future, void* result);
+
+static void stats_add(_Atomic uint64_t* stat, uint64_t value);
+static uint64_t now_ns(void);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+thread_pool_t* pool_new(size_t n_workers, size_t queue_capacity)
+{
+    if (0 == n_workers || 0 == queue_capacity)
+    {
+        return NULL;
+    }
+
+    thread_pool_t* pool = malloc(sizeof(thread_pool_t));
+    if (NULL == pool)
+    {
+        return NULL;
+    }
+
+    pool->queue = sync_buffer_new(queue_capacity);
+    if (NULL == pool->queue)
+    {
+        free(pool);
+        return NULL;
+    }
+
+    pool->workers = aligned_alloc(CACHE_LINE_SIZE, n_workers*sizeof(worker_t));
+    if (NULL == pool->workers)
+    {
+        sync_buffer_delete(pool->queue);
+        free(pool);
+        return NULL;
+    }
+
+    pool->n_workers = 0;
+    for (size_t i = 0; i < n_workers; ++i)
+    {
+        worker_t* worker = &pool->workers[i];
+
+        worker->pool = pool;
+        atomic_init(&worker->n_tasks, 0);
+        atomic_init(&worker->idle_ns, 0);
+        atomic_init(&worker->busy_ns, 0);
+        atomic_init(&worker->queue_wait_ns, 0);
+
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0)
+        {
+            // shut down the workers that were started
+            pool_delete(pool);
+            return NULL;
+        }
+
+        pool->n_workers++;
+    }
+
+    return pool;
+}
+
+void pool_delete(thread_pool_t* pool)
+{
+    if (NULL == pool)
+    {
+        return;
+    }
+
+    // workers drain the remaining tasks and exit
+    sync_buffer_close(pool->queue);
+
+    for (size_t i = 0; i < pool->n_workers; ++i)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    sync_buffer_delete(pool->queue);
+
+    free(pool->workers);
+    free(pool);
+}
+
+future_t* pool_submit(thread_pool_t* pool, task_f fn, void* arg)
+{
+    if (NULL == pool || NULL == fn)
+    {
+        return NULL;
+    }
+
+    future_t* future = new_future(fn, arg, false);
+    if (NULL == future)
+    {
+        return NULL;
+    }
+
+    if (!sync_buffer_put(pool->queue, future))
+    {
+        // pool is shutting down
+        delete_future(future);
+        return NULL;
+    }
+
+    return future;
+}
+
+bool pool_execute(thread_pool_t* pool, task_f fn, void* arg)
+{
+    if (NULL == pool || NULL == fn)
+    {
+        return false;
+    }
+
+    future_t* future = new_future(fn, arg, true);
+    if (NULL == future)
+    {
+        return false;
+    }
+
+    if (!sync_buffer_put(pool->queue, future))
+    {
+        // pool is shutting down
+        delete_future(future);
+        return false;
+    }
+
+    return true;
+}
+
+void* future_join(future_t* future)
+{
+    if (NULL == future)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&future->lock);
+    while (!future->done)
+    {
+        pthread_cond_wait(&future->completed, &future->lock);
+    }
+    pthread_mutex_unlock(&future->lock);
+
+    void* result = future->result;
+    delete_future(future);
+
+    return result;
+}
+
+size_t pool_size(thread_pool_t* pool)
+{
+    return (NULL == pool) ? 0 : pool->n_workers;
+}
+
+worker_stats_t pool_worker_stats(thread_pool_t* pool, size_t worker)
+{
+    worker_stats_t stats = {
+        .n_tasks       = 0,
+        .idle_ns       = 0,
+        .busy_ns       = 0,
+        .queue_wait_ns = 0
+    };
+
+    if (pool != NULL && worker < pool->n_workers)
+    {
+        worker_t* w = &pool->workers[worker];
+
+        stats.n_tasks       = atomic_load_explicit(&w->n_tasks, memory_order_relaxed);
+        stats.idle_ns       = atomic_load_explicit(&w->idle_ns, memory_order_relaxed);
+        stats.busy_ns       = atomic_load_explicit(&w->busy_ns, memory_order_relaxed);
+        stats.queue_wait_ns = atomic_load_explicit(&w->queue_wait_ns, memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static void* worker_main(void* arg)
+{
+    worker_t* worker = (worker_t*) arg;
+    sync_buffer_t* queue = worker->pool->queue;
+
+    for (;;)
+    {
+        const uint64_t idle_start = now_ns();
+
+        // NULL is never submitted, so it indicates the queue is drained
+        future_t* task = sync_buffer_get(queue);
+        if (NULL == task)
+        {
+            break;
+        }
+
+        const uint64_t busy_start = now_ns();
+
+        stats_add(&worker->idle_ns, busy_start - idle_start);
+        stats_add(&worker->queue_wait_ns, busy_start - task->submitted_ns);
+
+        void* result = task->fn(task->arg);
+
+        stats_add(&worker->busy_ns, now_ns() - busy_start);
+        stats_add(&worker->n_tasks, 1);
+
+        if (task->detached)
+        {
+            delete_future(task);
+        }
+        else
+        {
+            complete_future(task, result);
+        }
+    }
+
+    return NULL;
+}
+
+static future_t* new_future(task_f fn, void* arg, bool detached)
+{
+    future_t* future = malloc(sizeof(future_t));
+    if (NULL == future)
+    {
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&future->lock, NULL) != 0)
+    {
+        free(future);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&future->completed, NULL) != 0)
+    {
+        pthread_mutex_destroy(&future->lock);
+        free(future);
+        return NULL;
+    }
+
+    future->fn           = fn;
+    future->arg          = arg;
+    future->result       = NULL;
+    future->submitted_ns = now_ns();
+    future->detached     = detached;
+    future->done         = false;
+
+    return future;
+}
+
+static void delete_future(future_t* future)
+{
+    pthread_mutex_destroy(&future->lock);
+    pthread_cond_destroy(&future->completed);
+    free(future);
+}
+
+static void complete_future(future_t* future, void* result)
+{
+    pthread_mutex_lock(&future->lock);
+    future->result = result;
+    future->done   = true;
+
+    // signal under the lock; the joiner frees the future once it sees `done`
+    pthread_cond_signal(&future->completed);
+    pthread_mutex_unlock(&future->lock);
+}
+
+static void stats_add(_Atomic uint64_t* stat, uint64_t value)
+{
+    // only the owning worker writes its statistics, so no RMW is required
+    const uint64_t current = atomic_load_explicit(stat, memory_order_relaxed);
+    atomic_store_explicit(stat, current + value, memory_order_relaxed);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec*1000000000ULL + (uint64_t) ts.tv_nsec;
+}
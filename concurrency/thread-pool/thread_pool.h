@@ -0,0 +1,172 @@
+// thread_pool.h
+// A fixed-size thread pool executor built on the synchronized buffer.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Background:
+//
+// A thread pool amortizes the cost of creating and destroying
+// threads across many short-lived units of work ("tasks"). Rather
+// than spawning a thread per task, a fixed set of worker threads
+// is created up front, and each worker repeatedly removes a task
+// from a shared queue and runs it to completion.
+//
+// In this implementation the shared queue is a synchronized bounded
+// buffer (see sync_buffer.h): submitting a task is a put() into the
+// buffer, and each worker loops on get(). Because the buffer is
+// bounded, submission blocks when the workers fall behind by more
+// than the queue capacity, which provides natural backpressure.
+//
+// Each submission returns a "future", a handle that may later be
+// joined to wait for the task to complete and retrieve its result.
+// Tasks whose result is not needed may instead be submitted with
+// pool_execute(), in which case no future is returned.
+//
+// Finally, each worker maintains statistics describing how it spends
+// its time: the number of tasks it has run, the time it has spent
+// idle waiting for work, the time it has spent running tasks, and
+// the cumulative time the tasks it ran spent queued before it picked
+// them up. These make it possible to size a pool from data: long
+// queue waits with little idle time suggest too few workers, and
+// the reverse suggests too many.
+
+// The signature for user-provided tasks.
+typedef void* (*task_f)(void*);
+
+// The thread pool.
+typedef struct thread_pool thread_pool_t;
+
+// The handle to a task submitted with pool_submit().
+typedef struct future future_t;
+
+// The type returned by pool_worker_stats().
+typedef struct worker_stats
+{
+    // The number of tasks the worker has run.
+    uint64_t n_tasks;
+
+    // The time the worker has spent waiting for a task, in nanoseconds.
+    uint64_t idle_ns;
+
+    // The time the worker has spent running tasks, in nanoseconds.
+    uint64_t busy_ns;
+
+    // The total time the tasks run by this worker spent in the
+    // queue between submission and being picked up, in nanoseconds.
+    uint64_t queue_wait_ns;
+} worker_stats_t;
+
+// pool_new()
+//
+// Construct a new thread pool and start its workers.
+//
+// Arguments:
+//  n_workers      - the number of worker threads
+//  queue_capacity - the maximum number of tasks queued at once
+//
+// Returns:
+//  A pointer to a newly constructed thread pool on success
+//  NULL on failure (invalid argument, allocation failure)
+thread_pool_t* pool_new(size_t n_workers, size_t queue_capacity);
+
+// pool_delete()
+//
+// Shut down and destroy an existing thread pool.
+//
+// Closes the pool to further submissions, waits for the workers
+// to run every task that was already submitted, and joins them.
+// Futures for those tasks remain valid and must still be joined.
+//
+// This function IS NOT threadsafe with respect to concurrent
+// submissions to the same pool.
+//
+// Arguments:
+//  pool - pointer to an existing thread pool
+void pool_delete(thread_pool_t* pool);
+
+// pool_submit()
+//
+// Submit a task to the thread pool.
+//
+// This function is threadsafe. It blocks while the
+// queue of submitted tasks is full. The returned future
+// must eventually be passed to future_join(), which
+// releases it.
+//
+// Arguments:
+//  pool - pointer to an existing thread pool
+//  fn   - the task to run
+//  arg  - the argument passed to `fn`
+//
+// Returns:
+//  A future for the submitted task on success
+//  NULL on failure (invalid argument, allocation failure)
+future_t* pool_submit(thread_pool_t* pool, task_f fn, void* arg);
+
+// pool_execute()
+//
+// Submit a task to the thread pool, discarding its result.
+//
+// This function is threadsafe. It blocks while the
+// queue of submitted tasks is full.
+//
+// Arguments:
+//  pool - pointer to an existing thread pool
+//  fn   - the task to run
+//  arg  - the argument passed to `fn`
+//
+// Returns:
+//  `true` if the task was submitted
+//  `false` otherwise (invalid argument, allocation failure)
+bool pool_execute(thread_pool_t* pool, task_f fn, void* arg);
+
+// future_join()
+//
+// Wait for a submitted task to complete and retrieve its result.
+//
+// Blocks until the task associated with `future` has run,
+// then releases the future. Each future must be joined
+// exactly once, and is invalid after this function returns.
+//
+// Arguments:
+//  future - the future returned by pool_submit()
+//
+// Returns:
+//  The value returned by the task
+void* future_join(future_t* future);
+
+// pool_size()
+//
+// Return the number of workers in the thread pool.
+//
+// Arguments:
+//  pool - pointer to an existing thread pool
+//
+// Returns:
+//  The number of workers in the pool, 0 on invalid argument
+size_t pool_size(thread_pool_t* pool);
+
+// pool_worker_stats()
+//
+// Return the statistics for a single worker in the thread pool.
+//
+// This function is threadsafe. The statistics are a snapshot,
+// and may be read while the workers are running; each field
+// is individually consistent, but fields are not updated
+// together atomically.
+//
+// Arguments:
+//  pool   - pointer to an existing thread pool
+//  worker - the index of the worker, in [0, pool_size())
+//
+// Returns:
+//  A structure populated with the worker's statistics;
+//  all zero on invalid argument
+worker_stats_t pool_worker_stats(thread_pool_t* pool, size_t worker);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,344 @@
+// bench.c
+// Timeout-management benchmark for the timer wheel.
+//
+// Models a server that sets a timeout for each request it receives and
+// cancels it when the response arrives: at each tick, a batch of timers
+// is set with timeouts drawn uniformly from a range, and 95% of the
+// timers set a fixed number of ticks earlier are cancelled, leaving the
+// remainder to expire. Timers are drawn from a preallocated pool and
+// returned to it when they fire or are cancelled, so neither structure
+// allocates per timer.
+//
+// The timer wheel is compared against a binary min-heap ordered by
+// expiry, in which each timer records its index in the heap so that it
+// can be cancelled in O(log n) (reproduced below as heap_timers_t).
+//
+// Usage:
+//  ./bench [total timers]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "timer_wheel.h"
+
+#define DEFAULT_N_TIMERS 10000000
+
+// Timers set at each tick, and the percentage subsequently cancelled.
+#define TIMERS_PER_TICK 1000
+#define CANCEL_PERCENT  95
+
+// Cancellation happens this many ticks after a timer is set.
+#define CANCEL_LAG 100
+
+// Timeouts are drawn uniformly from (CANCEL_LAG, MAX_TIMEOUT].
+#define MAX_TIMEOUT 30000
+
+// Enough timers for those awaiting cancellation, plus those left
+// to expire, with a margin for the variance in the latter.
+#define POOL_CAPACITY \
+    (TIMERS_PER_TICK*CANCEL_LAG + 2*TIMERS_PER_TICK*(100 - CANCEL_PERCENT)*MAX_TIMEOUT / 100)
+
+// ----------------------------------------------------------------------------
+// Timer Pool
+
+typedef struct bench_timer
+{
+    wheel_timer_t wheel_timer;
+
+    // The expiry, and the index in the heap, for the baseline.
+    uint64_t expiry;
+    size_t   heap_index;
+
+    struct bench_timer* next_free;
+} bench_timer_t;
+
+typedef struct timer_pool
+{
+    bench_timer_t* timers;
+    bench_timer_t* free_list;
+    size_t         n_fired;
+} timer_pool_t;
+
+static void pool_init(timer_pool_t* pool, size_t capacity)
+{
+    pool->timers = malloc(capacity*sizeof(bench_timer_t));
+    if (NULL == pool->timers)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pool->free_list = NULL;
+    for (size_t i = capacity; i-- > 0;)
+    {
+        wheel_timer_init(&pool->timers[i].wheel_timer);
+        pool->timers[i].next_free = pool->free_list;
+        pool->free_list = &pool->timers[i];
+    }
+
+    pool->n_fired = 0;
+}
+
+static bench_timer_t* pool_get(timer_pool_t* pool)
+{
+    bench_timer_t* timer = pool->free_list;
+    if (NULL == timer)
+    {
+        fprintf(stderr, "timer pool exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pool->free_list = timer->next_free;
+    return timer;
+}
+
+static void pool_put(timer_pool_t* pool, bench_timer_t* timer)
+{
+    timer->next_free = pool->free_list;
+    pool->free_list  = timer;
+}
+
+// ----------------------------------------------------------------------------
+// Baseline: Binary Heap
+
+typedef struct heap_timers
+{
+    bench_timer_t** heap;
+    size_t          count;
+} heap_timers_t;
+
+static void heap_set(heap_timers_t* h, size_t index, bench_timer_t* timer)
+{
+    h->heap[index] = timer;
+    timer->heap_index = index;
+}
+
+static void heap_sift_up(heap_timers_t* h, size_t index)
+{
+    bench_timer_t* timer = h->heap[index];
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / 2;
+        if (h->heap[parent]->expiry <= timer->expiry)
+        {
+            break;
+        }
+
+        heap_set(h, index, h->heap[parent]);
+        index = parent;
+    }
+
+    heap_set(h, index, timer);
+}
+
+static void heap_sift_down(heap_timers_t* h, size_t index)
+{
+    bench_timer_t* timer = h->heap[index];
+    for (;;)
+    {
+        size_t child = 2*index + 1;
+        if (child >= h->count)
+        {
+            break;
+        }
+
+        if (child + 1 < h->count && h->heap[child + 1]->expiry < h->heap[child]->expiry)
+        {
+            ++child;
+        }
+
+        if (timer->expiry <= h->heap[child]->expiry)
+        {
+            break;
+        }
+
+        heap_set(h, index, h->heap[child]);
+        index = child;
+    }
+
+    heap_set(h, index, timer);
+}
+
+static void heap_add(heap_timers_t* h, bench_timer_t* timer)
+{
+    heap_set(h, h->count, timer);
+    heap_sift_up(h, h->count++);
+}
+
+static void heap_remove(heap_timers_t* h, bench_timer_t* timer)
+{
+    const size_t index = timer->heap_index;
+    if (--h->count > index)
+    {
+        // the last timer fills the hole, and moves in at most one direction
+        bench_timer_t* moved = h->heap[h->count];
+        heap_set(h, index, moved);
+        heap_sift_up(h, index);
+        heap_sift_down(h, moved->heap_index);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+static uint64_t next_random(uint64_t* state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static timer_pool_t pool;
+
+// Timers awaiting cancellation, for each of the last CANCEL_LAG ticks.
+static bench_timer_t* to_cancel[CANCEL_LAG][TIMERS_PER_TICK];
+static size_t         n_to_cancel[CANCEL_LAG];
+
+static void on_expiry(void* arg)
+{
+    pool.n_fired++;
+    pool_put(&pool, (bench_timer_t*) arg);
+}
+
+static void run(const char* name, bool use_wheel, size_t n_timers)
+{
+    const uint64_t n_ticks = n_timers / TIMERS_PER_TICK;
+
+    pool_init(&pool, POOL_CAPACITY);
+
+    timer_wheel_t* wheel = timer_wheel_new(0);
+    heap_timers_t  heap  = {
+        .heap  = malloc(POOL_CAPACITY*sizeof(bench_timer_t*)),
+        .count = 0
+    };
+
+    if (NULL == wheel || NULL == heap.heap)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < CANCEL_LAG; ++i)
+    {
+        n_to_cancel[i] = 0;
+    }
+
+    uint64_t rng = 1;
+    size_t n_cancelled = 0;
+
+    const double start = now_seconds();
+
+    for (uint64_t tick = 1; tick <= n_ticks + MAX_TIMEOUT; ++tick)
+    {
+        // fire the timers that expire at this tick
+        if (use_wheel)
+        {
+            timer_wheel_advance(wheel, tick);
+        }
+        else
+        {
+            while (heap.count > 0 && heap.heap[0]->expiry <= tick)
+            {
+                bench_timer_t* timer = heap.heap[0];
+                heap_remove(&heap, timer);
+                on_expiry(timer);
+            }
+        }
+
+        // responses arrive for most of the requests made CANCEL_LAG ticks ago
+        const size_t lagged = tick % CANCEL_LAG;
+        for (size_t i = 0; i < n_to_cancel[lagged]; ++i)
+        {
+            bench_timer_t* timer = to_cancel[lagged][i];
+            if (use_wheel)
+            {
+                timer_wheel_cancel(wheel, &timer->wheel_timer);
+            }
+            else
+            {
+                heap_remove(&heap, timer);
+            }
+
+            pool_put(&pool, timer);
+            n_cancelled++;
+        }
+
+        n_to_cancel[lagged] = 0;
+
+        if (tick > n_ticks)
+        {
+            // no more requests; let the remaining timers expire
+            continue;
+        }
+
+        // new requests arrive
+        for (size_t i = 0; i < TIMERS_PER_TICK; ++i)
+        {
+            const uint64_t r = next_random(&rng);
+
+            bench_timer_t* timer = pool_get(&pool);
+            timer->expiry = tick + CANCEL_LAG + 1 + (r >> 32) % (MAX_TIMEOUT - CANCEL_LAG);
+
+            if (use_wheel)
+            {
+                timer_wheel_add(wheel, &timer->wheel_timer, timer->expiry, on_expiry, timer);
+            }
+            else
+            {
+                heap_add(&heap, timer);
+            }
+
+            if ((r & 0xffff) % 100 < CANCEL_PERCENT)
+            {
+                to_cancel[lagged][n_to_cancel[lagged]++] = timer;
+            }
+        }
+    }
+
+    const double elapsed = now_seconds() - start;
+
+    const size_t n_set = (size_t) n_ticks*TIMERS_PER_TICK;
+    if (pool.n_fired + n_cancelled != n_set)
+    {
+        fprintf(stderr, "%s: timers lost\n", name);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%6s  %10zu  %10zu  %10zu  %10.3f  %10.1f\n",
+        name, n_set, n_cancelled, pool.n_fired, elapsed, elapsed*1e9 / (double) n_set);
+
+    timer_wheel_delete(wheel);
+    free(heap.heap);
+    free(pool.timers);
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t n_timers = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_N_TIMERS;
+
+    printf("%6s  %10s  %10s  %10s  %10s  %10s\n",
+        "timers", "set", "cancelled", "fired", "seconds", "ns/timer");
+
+    run("wheel", true, n_timers);
+    run("heap", false, n_timers);
+
+    return EXIT_SUCCESS;
+}
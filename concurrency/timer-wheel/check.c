@@ -0,0 +1,262 @@
+// check.c
+// Driver program for timer wheel tests.
+
+// attribute gnu_printf
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "timer_wheel.h"
+
+#define N_RANDOM_TIMERS 10000
+
+// ----------------------------------------------------------------------------
+// Definitions for Testing
+
+// A timer along with a record of when it fired.
+typedef struct test_timer
+{
+    wheel_timer_t  timer;
+    timer_wheel_t* wheel;
+    uint64_t       expiry;
+    uint64_t       fired_at;
+    size_t         n_fired;
+    bool           cancelled;
+} test_timer_t;
+
+static void record(void* arg)
+{
+    test_timer_t* t = (test_timer_t*) arg;
+    t->fired_at = timer_wheel_now(t->wheel);
+    t->n_fired++;
+}
+
+static void rearm(void* arg)
+{
+    // a periodic timer, with a period of 10 ticks
+    test_timer_t* t = (test_timer_t*) arg;
+    t->n_fired++;
+    timer_wheel_add(t->wheel, &t->timer, timer_wheel_now(t->wheel) + 10, rearm, t);
+}
+
+static void make_timer(test_timer_t* t, timer_wheel_t* wheel, uint64_t expiry)
+{
+    wheel_timer_init(&t->timer);
+    t->wheel     = wheel;
+    t->expiry    = expiry;
+    t->fired_at  = 0;
+    t->n_fired   = 0;
+    t->cancelled = false;
+}
+
+static uint64_t next_random(uint64_t* state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+// ----------------------------------------------------------------------------
+// Test Cases
+
+START_TEST(test_timer_wheel_new)
+{
+    timer_wheel_t* wheel = timer_wheel_new(100);
+    ck_assert_msg(wheel != NULL, "timer_wheel_new() returned NULL");
+
+    ck_assert(100 == timer_wheel_now(wheel));
+    ck_assert(0 == timer_wheel_count(wheel));
+    ck_assert(UINT64_MAX == timer_wheel_next_expiry(wheel));
+
+    // advancing an empty wheel simply moves time forward
+    ck_assert(0 == timer_wheel_advance(wheel, 1000000));
+    ck_assert(1000000 == timer_wheel_now(wheel));
+
+    timer_wheel_delete(wheel);
+}
+END_TEST
+
+START_TEST(test_timer_wheel_add_cancel)
+{
+    timer_wheel_t* wheel = timer_wheel_new(0);
+    ck_assert_msg(wheel != NULL, "timer_wheel_new() returned NULL");
+
+    test_timer_t a;
+    test_timer_t b;
+    make_timer(&a, wheel, 10);
+    make_timer(&b, wheel, 20);
+
+    ck_assert(timer_wheel_add(wheel, &a.timer, a.expiry, record, &a));
+    ck_assert(timer_wheel_add(wheel, &b.timer, b.expiry, record, &b));
+    ck_assert_msg(!timer_wheel_add(wheel, &a.timer, 5, record, &a), "pending timer added twice");
+
+    ck_assert(2 == timer_wheel_count(wheel));
+    ck_assert(wheel_timer_pending(&a.timer));
+    ck_assert(10 == timer_wheel_next_expiry(wheel));
+
+    ck_assert(timer_wheel_cancel(wheel, &a.timer));
+    ck_assert(!timer_wheel_cancel(wheel, &a.timer));
+    ck_assert(!wheel_timer_pending(&a.timer));
+    ck_assert(20 == timer_wheel_next_expiry(wheel));
+
+    ck_assert(1 == timer_wheel_advance(wheel, 100));
+    ck_assert(0 == a.n_fired);
+    ck_assert(1 == b.n_fired && 20 == b.fired_at);
+    ck_assert(!wheel_timer_pending(&b.timer));
+
+    // a cancelled or fired timer may be reused, and
+    // one that has already expired fires on the next tick
+    ck_assert(timer_wheel_add(wheel, &a.timer, 50, record, &a));
+    ck_assert(101 == timer_wheel_next_expiry(wheel));
+    ck_assert(1 == timer_wheel_advance(wheel, 101));
+    ck_assert(1 == a.n_fired && 101 == a.fired_at);
+
+    timer_wheel_delete(wheel);
+}
+END_TEST
+
+START_TEST(test_timer_wheel_levels)
+{
+    timer_wheel_t* wheel = timer_wheel_new(0);
+    ck_assert_msg(wheel != NULL, "timer_wheel_new() returned NULL");
+
+    // expiries on either side of the boundaries between levels,
+    // and beyond the span of the hierarchy
+    const uint64_t expiries[] = {
+        1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144,
+        (1ULL << 30) + 7, (1ULL << 36) - 1, (1ULL << 36), (1ULL << 37) + 5
+    };
+    const size_t n_timers = sizeof(expiries) / sizeof(expiries[0]);
+
+    test_timer_t timers[sizeof(expiries) / sizeof(expiries[0])];
+    for (size_t i = 0; i < n_timers; ++i)
+    {
+        make_timer(&timers[i], wheel, expiries[i]);
+        ck_assert(timer_wheel_add(wheel, &timers[i].timer, expiries[i], record, &timers[i]));
+    }
+
+    // follow next_expiry() as an event loop would
+    size_t n_fired = 0;
+    while (timer_wheel_count(wheel) > 0)
+    {
+        const uint64_t next = timer_wheel_next_expiry(wheel);
+        ck_assert(next > timer_wheel_now(wheel));
+        n_fired += timer_wheel_advance(wheel, next);
+    }
+
+    ck_assert(n_timers == n_fired);
+
+    for (size_t i = 0; i < n_timers; ++i)
+    {
+        ck_assert_msg(1 == timers[i].n_fired, "timer did not fire exactly once");
+        ck_assert_msg(timers[i].fired_at == expiries[i], "timer fired at the wrong time");
+    }
+
+    timer_wheel_delete(wheel);
+}
+END_TEST
+
+START_TEST(test_timer_wheel_random)
+{
+    timer_wheel_t* wheel = timer_wheel_new(12345);
+    ck_assert_msg(wheel != NULL, "timer_wheel_new() returned NULL");
+
+    static test_timer_t timers[N_RANDOM_TIMERS];
+
+    uint64_t rng = 1;
+    for (size_t i = 0; i < N_RANDOM_TIMERS; ++i)
+    {
+        const uint64_t expiry = 12345 + 1 + (next_random(&rng) >> 44);
+        make_timer(&timers[i], wheel, expiry);
+        ck_assert(timer_wheel_add(wheel, &timers[i].timer, expiry, record, &timers[i]));
+    }
+
+    // cancel every third timer
+    for (size_t i = 0; i < N_RANDOM_TIMERS; i += 3)
+    {
+        ck_assert(timer_wheel_cancel(wheel, &timers[i].timer));
+        timers[i].cancelled = true;
+    }
+
+    // advance by irregular amounts, firing timers in batches
+    uint64_t now = 12345;
+    while (timer_wheel_count(wheel) > 0)
+    {
+        now += 1 + (next_random(&rng) >> 52);
+        timer_wheel_advance(wheel, now);
+    }
+
+    for (size_t i = 0; i < N_RANDOM_TIMERS; ++i)
+    {
+        if (timers[i].cancelled)
+        {
+            ck_assert_msg(0 == timers[i].n_fired, "cancelled timer fired");
+        }
+        else
+        {
+            ck_assert_msg(1 == timers[i].n_fired, "timer did not fire exactly once");
+            ck_assert_msg(timers[i].fired_at == timers[i].expiry, "timer fired at the wrong time");
+        }
+    }
+
+    timer_wheel_delete(wheel);
+}
+END_TEST
+
+START_TEST(test_timer_wheel_rearm)
+{
+    timer_wheel_t* wheel = timer_wheel_new(0);
+    ck_assert_msg(wheel != NULL, "timer_wheel_new() returned NULL");
+
+    test_timer_t t;
+    make_timer(&t, wheel, 10);
+    ck_assert(timer_wheel_add(wheel, &t.timer, 10, rearm, &t));
+
+    // each firing adds the timer again from within its own callback
+    ck_assert(100 == timer_wheel_advance(wheel, 1000));
+    ck_assert(100 == t.n_fired);
+    ck_assert(wheel_timer_pending(&t.timer));
+    ck_assert(1010 == timer_wheel_next_expiry(wheel));
+
+    ck_assert(timer_wheel_cancel(wheel, &t.timer));
+
+    timer_wheel_delete(wheel);
+}
+END_TEST
+
+// ----------------------------------------------------------------------------
+// Infrastructure
+
+Suite* timer_wheel_suite(void)
+{
+    Suite* s = suite_create("timer-wheel");
+    TCase* tc_core = tcase_create("timer-wheel-core");
+
+    tcase_add_test(tc_core, test_timer_wheel_new);
+    tcase_add_test(tc_core, test_timer_wheel_add_cancel);
+    tcase_add_test(tc_core, test_timer_wheel_levels);
+    tcase_add_test(tc_core, test_timer_wheel_random);
+    tcase_add_test(tc_core, test_timer_wheel_rearm);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    Suite* suite = timer_wheel_suite();
+    SRunner* runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    srunner_free(runner);
+
+    return EXIT_SUCCESS;
+}
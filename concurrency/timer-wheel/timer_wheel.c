@@ -0,0 +1,352 @@
+// timer_wheel.c
+// A hierarchical timing wheel for managing timeouts.
+
+#include <stdlib.h>
+
+#include "timer_wheel.h"
+
+// Each level has 2^LEVEL_BITS slots.
+#define LEVEL_BITS 6
+#define LEVEL_SIZE (1u << LEVEL_BITS)
+#define LEVEL_MASK (LEVEL_SIZE - 1)
+
+// The number of levels; the level of a timer in the overflow list.
+#define N_LEVELS       6
+#define OVERFLOW_LEVEL N_LEVELS
+
+// The number of low-order bits of a time below which level `level` varies.
+#define LEVEL_SHIFT(level) ((level)*LEVEL_BITS)
+
+// The span of time covered by the whole of the hierarchy.
+#define WHEEL_SHIFT LEVEL_SHIFT(N_LEVELS)
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+struct timer_wheel
+{
+    // The lists of timers in each slot of each level.
+    wheel_timer_t* slots[N_LEVELS][LEVEL_SIZE];
+
+    // Timers beyond the span of the hierarchy.
+    wheel_timer_t* overflow;
+
+    // For each level, a mask with bit i set if slot i is non-empty.
+    uint64_t occupied[N_LEVELS];
+
+    // The current time; every tick up to and including it has been processed.
+    uint64_t now;
+
+    // The number of pending timers.
+    size_t count;
+};
+
+static void place(timer_wheel_t* wheel, wheel_timer_t* timer);
+static void link_timer(timer_wheel_t* wheel, wheel_timer_t* timer, unsigned level, unsigned slot);
+static void unlink_timer(timer_wheel_t* wheel, wheel_timer_t* timer);
+static wheel_timer_t** list_of(timer_wheel_t* wheel, unsigned level, unsigned slot);
+
+static void process_tick(timer_wheel_t* wheel, size_t* n_fired);
+static void cascade(timer_wheel_t* wheel, unsigned level, unsigned slot);
+static uint64_t next_event(timer_wheel_t* wheel);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+void wheel_timer_init(wheel_timer_t* timer)
+{
+    if (NULL == timer)
+    {
+        return;
+    }
+
+    timer->next     = NULL;
+    timer->prev     = NULL;
+    timer->expiry   = 0;
+    timer->callback = NULL;
+    timer->arg      = NULL;
+    timer->level    = 0;
+    timer->slot     = 0;
+    timer->pending  = false;
+}
+
+bool wheel_timer_pending(wheel_timer_t* timer)
+{
+    return (NULL != timer) && timer->pending;
+}
+
+timer_wheel_t* timer_wheel_new(uint64_t now)
+{
+    timer_wheel_t* wheel = malloc(sizeof(timer_wheel_t));
+    if (NULL == wheel)
+    {
+        return NULL;
+    }
+
+    for (unsigned level = 0; level < N_LEVELS; ++level)
+    {
+        for (unsigned slot = 0; slot < LEVEL_SIZE; ++slot)
+        {
+            wheel->slots[level][slot] = NULL;
+        }
+
+        wheel->occupied[level] = 0;
+    }
+
+    wheel->overflow = NULL;
+    wheel->now      = now;
+    wheel->count    = 0;
+
+    return wheel;
+}
+
+void timer_wheel_delete(timer_wheel_t* wheel)
+{
+    free(wheel);
+}
+
+bool timer_wheel_add(
+    timer_wheel_t*   wheel,
+    wheel_timer_t*   timer,
+    uint64_t         expiry,
+    timer_callback_f callback,
+    void*            arg)
+{
+    if (NULL == wheel || NULL == timer || NULL == callback || timer->pending)
+    {
+        return false;
+    }
+
+    // the current tick has already been processed
+    timer->expiry   = (expiry > wheel->now) ? expiry : wheel->now + 1;
+    timer->callback = callback;
+    timer->arg      = arg;
+    timer->pending  = true;
+
+    place(wheel, timer);
+    wheel->count++;
+
+    return true;
+}
+
+bool timer_wheel_cancel(timer_wheel_t* wheel, wheel_timer_t* timer)
+{
+    if (NULL == wheel || NULL == timer || !timer->pending)
+    {
+        return false;
+    }
+
+    unlink_timer(wheel, timer);
+    timer->pending = false;
+    wheel->count--;
+
+    return true;
+}
+
+size_t timer_wheel_advance(timer_wheel_t* wheel, uint64_t now)
+{
+    if (NULL == wheel || now <= wheel->now)
+    {
+        return 0;
+    }
+
+    size_t n_fired = 0;
+
+    // visit only the ticks at which a slot must be cascaded or fired
+    while (wheel->count > 0)
+    {
+        const uint64_t tick = next_event(wheel);
+        if (tick > now)
+        {
+            break;
+        }
+
+        wheel->now = tick;
+        process_tick(wheel, &n_fired);
+    }
+
+    // nothing happens between the last event and `now`, so the time of
+    // every pending timer remains within the span of its current slot
+    wheel->now = now;
+
+    return n_fired;
+}
+
+uint64_t timer_wheel_next_expiry(timer_wheel_t* wheel)
+{
+    if (NULL == wheel || 0 == wheel->count)
+    {
+        return UINT64_MAX;
+    }
+
+    return next_event(wheel);
+}
+
+uint64_t timer_wheel_now(timer_wheel_t* wheel)
+{
+    return (NULL == wheel) ? 0 : wheel->now;
+}
+
+size_t timer_wheel_count(timer_wheel_t* wheel)
+{
+    return (NULL == wheel) ? 0 : wheel->count;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static void place(timer_wheel_t* wheel, wheel_timer_t* timer)
+{
+    // the finest level in which the expiry falls within the current
+    // window of the level above: the levels then agree on every
+    // higher-order bit, and the slot is the bits that differ
+    for (unsigned level = 0; level < N_LEVELS; ++level)
+    {
+        const unsigned above = LEVEL_SHIFT(level + 1);
+        if ((timer->expiry >> above) == (wheel->now >> above))
+        {
+            const unsigned slot = (timer->expiry >> LEVEL_SHIFT(level)) & LEVEL_MASK;
+            link_timer(wheel, timer, level, slot);
+            return;
+        }
+    }
+
+    link_timer(wheel, timer, OVERFLOW_LEVEL, 0);
+}
+
+static void link_timer(timer_wheel_t* wheel, wheel_timer_t* timer, unsigned level, unsigned slot)
+{
+    wheel_timer_t** head = list_of(wheel, level, slot);
+
+    timer->level = (uint8_t) level;
+    timer->slot  = (uint8_t) slot;
+    timer->prev  = NULL;
+    timer->next  = *head;
+
+    if (*head != NULL)
+    {
+        (*head)->prev = timer;
+    }
+
+    *head = timer;
+
+    if (level < N_LEVELS)
+    {
+        wheel->occupied[level] |= 1ULL << slot;
+    }
+}
+
+static void unlink_timer(timer_wheel_t* wheel, wheel_timer_t* timer)
+{
+    wheel_timer_t** head = list_of(wheel, timer->level, timer->slot);
+
+    if (timer->prev != NULL)
+    {
+        timer->prev->next = timer->next;
+    }
+    else
+    {
+        *head = timer->next;
+    }
+
+    if (timer->next != NULL)
+    {
+        timer->next->prev = timer->prev;
+    }
+
+    if (NULL == *head && timer->level < N_LEVELS)
+    {
+        wheel->occupied[timer->level] &= ~(1ULL << timer->slot);
+    }
+
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+static wheel_timer_t** list_of(timer_wheel_t* wheel, unsigned level, unsigned slot)
+{
+    return (OVERFLOW_LEVEL == level) ? &wheel->overflow : &wheel->slots[level][slot];
+}
+
+static void process_tick(timer_wheel_t* wheel, size_t* n_fired)
+{
+    const uint64_t tick = wheel->now;
+
+    // cascade, coarsest first, every level whose current slot starts now
+    if (0 == (tick & ((1ULL << WHEEL_SHIFT) - 1)))
+    {
+        cascade(wheel, OVERFLOW_LEVEL, 0);
+    }
+
+    for (unsigned level = N_LEVELS - 1; level > 0; --level)
+    {
+        if (0 == (tick & ((1ULL << LEVEL_SHIFT(level)) - 1)))
+        {
+            cascade(wheel, level, (tick >> LEVEL_SHIFT(level)) & LEVEL_MASK);
+        }
+    }
+
+    // fire the slot for this tick; a callback may add timers, but
+    // never into this slot, since the tick is already processed
+    wheel_timer_t** head = &wheel->slots[0][tick & LEVEL_MASK];
+    while (*head != NULL)
+    {
+        wheel_timer_t* timer = *head;
+
+        unlink_timer(wheel, timer);
+        timer->pending = false;
+        wheel->count--;
+        (*n_fired)++;
+
+        timer->callback(timer->arg);
+    }
+}
+
+static void cascade(timer_wheel_t* wheel, unsigned level, unsigned slot)
+{
+    // detach the list, then place each timer anew; none returns to this slot
+    wheel_timer_t** head = list_of(wheel, level, slot);
+
+    wheel_timer_t* timer = *head;
+    *head = NULL;
+
+    if (level < N_LEVELS)
+    {
+        wheel->occupied[level] &= ~(1ULL << slot);
+    }
+
+    while (timer != NULL)
+    {
+        wheel_timer_t* next = timer->next;
+        place(wheel, timer);
+        timer = next;
+    }
+}
+
+static uint64_t next_event(timer_wheel_t* wheel)
+{
+    const uint64_t now = wheel->now;
+
+    // every occupied slot lies after the current slot of its level, and
+    // an event in a finer level always precedes any in a coarser one
+    for (unsigned level = 0; level < N_LEVELS; ++level)
+    {
+        const unsigned shift   = LEVEL_SHIFT(level);
+        const unsigned current = (now >> shift) & LEVEL_MASK;
+
+        const uint64_t later = (LEVEL_MASK == current)
+            ? 0
+            : wheel->occupied[level] & (~0ULL << (current + 1));
+
+        if (later != 0)
+        {
+            const unsigned above  = shift + LEVEL_BITS;
+            const uint64_t window = (now >> above) << above;
+            return window | ((uint64_t) __builtin_ctzll(later) << shift);
+        }
+    }
+
+    // only the overflow list remains; it is next examined
+    // when the time reaches the next span of the hierarchy
+    return ((now >> WHEEL_SHIFT) + 1) << WHEEL_SHIFT;
+}
@@ -0,0 +1,226 @@
+// timer_wheel.h
+// A hierarchical timing wheel for managing timeouts.
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Background:
+//
+// Programs that manage many timeouts (network servers, RPC systems,
+// event loops) set a timer for almost every operation they begin, and
+// cancel almost every one of those timers when the operation completes
+// before its deadline. Keeping timers in a priority queue ordered by
+// expiry makes both setting and cancelling a timer O(log n), and the
+// cost is paid for every timer, even though nearly all of them never
+// fire.
+//
+// A timing wheel (Varghese and Lauck) instead discretizes time into
+// ticks, and keeps a circular array of slots, each holding a list of
+// the timers that expire in one tick. Setting a timer appends it to the
+// list of the slot for its expiry, and cancelling it unlinks it from
+// that list, both in O(1). As time advances, the wheel visits the slot
+// for each tick in turn and fires every timer in it as a batch.
+//
+// A single wheel of 64 slots only covers deadlines up to 64 ticks away.
+// A hierarchical wheel stacks several wheels of increasing granularity,
+// much like the hands of a clock: each slot of the second level covers
+// 64 ticks, each slot of the third level covers 64*64 ticks, and so on.
+// A timer is placed in the finest level that can represent its expiry.
+// When time reaches the start of a slot in a coarser level, the timers
+// in that slot are "cascaded" down into finer levels, and so each timer
+// moves at most once per level before it fires. This implementation has
+// six levels, covering deadlines up to 2^36 ticks away (about two years
+// of one-millisecond ticks); timers beyond that are parked on an
+// overflow list and re-examined as the top level turns over.
+//
+// Each level keeps a 64-bit mask of its occupied slots, which allows
+// the wheel to skip directly over stretches of time in which nothing
+// happens, and to report when the next timer may fire. The latter is
+// the deadline for an event loop's blocking wait: a thread that waits
+// on a synchronized buffer (see concurrency/sync-buffer) while also
+// servicing timers with one-millisecond ticks might run
+//
+//     const uint64_t next = timer_wheel_next_expiry(wheel);
+//     void* item = (UINT64_MAX == next)
+//         ? sync_buffer_get(buffer)
+//         : sync_buffer_get_timeout(buffer, next - timer_wheel_now(wheel));
+//
+//     timer_wheel_advance(wheel, current_time_ms());
+//
+// The wheel does not read a clock itself: time, in ticks of whatever
+// length the user chooses, is supplied to timer_wheel_advance(). Timers
+// are "intrusive": the user embeds a wheel_timer_t in their own state,
+// so adding a timer never allocates.
+//
+// This implementation is not threadsafe; a wheel is intended to be
+// owned by a single thread (e.g. an event loop).
+
+// The signature for the user-provided timer callback.
+typedef void (*timer_callback_f)(void* arg);
+
+// A timer; storage is provided by the user. The
+// members are private to the timer wheel implementation.
+typedef struct wheel_timer
+{
+    struct wheel_timer* next;
+    struct wheel_timer* prev;
+
+    uint64_t expiry;
+
+    timer_callback_f callback;
+    void*            arg;
+
+    // The level and slot in which the timer is linked, if pending.
+    uint8_t level;
+    uint8_t slot;
+    bool    pending;
+} wheel_timer_t;
+
+// The timer wheel.
+typedef struct timer_wheel timer_wheel_t;
+
+// wheel_timer_init()
+//
+// Initialize a timer before its first use.
+//
+// Arguments:
+//  timer - the timer to initialize
+void wheel_timer_init(wheel_timer_t* timer);
+
+// wheel_timer_pending()
+//
+// Determine whether a timer is set and has not yet fired.
+//
+// Arguments:
+//  timer - an initialized timer
+//
+// Returns:
+//  `true` if the timer is pending in a wheel
+//  `false` otherwise
+bool wheel_timer_pending(wheel_timer_t* timer);
+
+// timer_wheel_new()
+//
+// Construct a new timer wheel.
+//
+// Arguments:
+//  now - the current time, in ticks
+//
+// Returns:
+//  A pointer to a newly constructed timer wheel on success
+//  NULL on failure (allocation failure)
+timer_wheel_t* timer_wheel_new(uint64_t now);
+
+// timer_wheel_delete()
+//
+// Destroy an existing timer wheel.
+//
+// Timers that are still pending are abandoned without being fired;
+// their storage remains owned by the user.
+//
+// Arguments:
+//  wheel - pointer to an existing timer wheel
+void timer_wheel_delete(timer_wheel_t* wheel);
+
+// timer_wheel_add()
+//
+// Set a timer to fire at the given time. O(1).
+//
+// A timer whose expiry is not after the current time of
+// the wheel fires on the next tick that the wheel advances.
+//
+// Arguments:
+//  wheel    - pointer to an existing timer wheel
+//  timer    - an initialized timer that is not pending
+//  expiry   - the time, in ticks, at which the timer fires
+//  callback - the function called when the timer fires
+//  arg      - the argument passed to `callback`
+//
+// Returns:
+//  `true` if the timer was set
+//  `false` on failure (invalid argument, timer already pending)
+bool timer_wheel_add(
+    timer_wheel_t*   wheel,
+    wheel_timer_t*   timer,
+    uint64_t         expiry,
+    timer_callback_f callback,
+    void*            arg);
+
+// timer_wheel_cancel()
+//
+// Cancel a pending timer. O(1).
+//
+// Once cancelled, the timer may be set again with timer_wheel_add().
+//
+// Arguments:
+//  wheel - pointer to an existing timer wheel
+//  timer - the timer to cancel
+//
+// Returns:
+//  `true` if the timer was pending, and has been cancelled
+//  `false` otherwise (invalid argument, timer not pending)
+bool timer_wheel_cancel(timer_wheel_t* wheel, wheel_timer_t* timer);
+
+// timer_wheel_advance()
+//
+// Advance the current time of the wheel, firing expired timers.
+//
+// Every pending timer with an expiry at or before `now` fires, in order
+// of expiry; the order among timers with the same expiry is unspecified.
+// A timer is no longer pending by the time its callback runs, and
+// callbacks may add and cancel timers (including the one that fired).
+//
+// Arguments:
+//  wheel - pointer to an existing timer wheel
+//  now   - the current time, in ticks; if earlier than
+//          the current time of the wheel, nothing happens
+//
+// Returns:
+//  The number of timers fired
+size_t timer_wheel_advance(timer_wheel_t* wheel, uint64_t now);
+
+// timer_wheel_next_expiry()
+//
+// Return the time by which the wheel next needs to be advanced.
+//
+// No timer fires before the returned time. The returned time is exact
+// for timers due within the next 64 ticks; for timers further out it
+// may be earlier than the first expiry, at the point at which that
+// timer is cascaded to a finer level, after which this function
+// reports a later time.
+//
+// Arguments:
+//  wheel - pointer to an existing timer wheel
+//
+// Returns:
+//  The time, in ticks, at which to next advance the wheel
+//  UINT64_MAX if no timers are pending (or invalid argument)
+uint64_t timer_wheel_next_expiry(timer_wheel_t* wheel);
+
+// timer_wheel_now()
+//
+// Return the current time of the wheel.
+//
+// Arguments:
+//  wheel - pointer to an existing timer wheel
+//
+// Returns:
+//  The time, in ticks, to which the wheel was last advanced
+uint64_t timer_wheel_now(timer_wheel_t* wheel);
+
+// timer_wheel_count()
+//
+// Return the number of pending timers in the wheel.
+//
+// Arguments:
+//  wheel - pointer to an existing timer wheel
+//
+// Returns:
+//  The number of pending timers, 0 on invalid argument
+size_t timer_wheel_count(timer_wheel_t* wheel);
+
+#endif // TIMER_WHEEL_H
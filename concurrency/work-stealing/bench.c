@@ -0,0 +1,241 @@
+// bench.c
+// Speedup benchmark for the work-stealing runtime: parallel quicksort.
+//
+// Sorts the same array of random integers sequentially, and then with
+// the runtime at 1, 2, 4, ... workers up to the number of online
+// processors, reporting the speedup of each relative to sequential.
+//
+// Usage:
+//  ./bench [number of items]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "work_stealing.h"
+
+#define DEFAULT_N_ITEMS (1 << 24)
+
+// Below this many items, a partition is sorted sequentially.
+#define SEQUENTIAL_CUTOFF 4096
+
+// ----------------------------------------------------------------------------
+// Quicksort
+
+typedef struct sort_args
+{
+    int*   array;
+    size_t n;
+} sort_args_t;
+
+static void swap(int* array, size_t i, size_t j)
+{
+    const int tmp = array[i];
+    array[i] = array[j];
+    array[j] = tmp;
+}
+
+static void insertion_sort(int* array, size_t n)
+{
+    for (size_t i = 1; i < n; ++i)
+    {
+        const int value = array[i];
+
+        size_t j = i;
+        while (j > 0 && array[j - 1] > value)
+        {
+            array[j] = array[j - 1];
+            --j;
+        }
+
+        array[j] = value;
+    }
+}
+
+// Hoare partition about the median of the first, middle and last
+// items; returns the index that splits [0, p) and [p, n).
+static size_t partition(int* array, size_t n)
+{
+    const size_t mid = n / 2;
+    if (array[mid] < array[0])
+    {
+        swap(array, mid, 0);
+    }
+    if (array[n - 1] < array[0])
+    {
+        swap(array, n - 1, 0);
+    }
+    if (array[n - 1] < array[mid])
+    {
+        swap(array, n - 1, mid);
+    }
+
+    const int pivot = array[mid];
+
+    size_t i = 0;
+    size_t j = n - 1;
+    for (;;)
+    {
+        while (array[i] < pivot)
+        {
+            ++i;
+        }
+        while (array[j] > pivot)
+        {
+            --j;
+        }
+
+        if (i >= j)
+        {
+            return j + 1;
+        }
+
+        swap(array, i++, j--);
+    }
+}
+
+static void sequential_quicksort(int* array, size_t n)
+{
+    while (n > 16)
+    {
+        const size_t p = partition(array, n);
+
+        // recurse on the smaller side to bound stack depth
+        if (p < n - p)
+        {
+            sequential_quicksort(array, p);
+            array += p;
+            n     -= p;
+        }
+        else
+        {
+            sequential_quicksort(array + p, n - p);
+            n = p;
+        }
+    }
+
+    insertion_sort(array, n);
+}
+
+static void parallel_quicksort(void* arg)
+{
+    sort_args_t* args = (sort_args_t*) arg;
+    if (args->n <= SEQUENTIAL_CUTOFF)
+    {
+        sequential_quicksort(args->array, args->n);
+        return;
+    }
+
+    const size_t p = partition(args->array, args->n);
+
+    sort_args_t lo = { .array = args->array,     .n = p };
+    sort_args_t hi = { .array = args->array + p, .n = args->n - p };
+
+    // fork the low half, sort the high half ourselves, then join
+    ws_task_t child;
+    ws_spawn(&child, parallel_quicksort, &lo);
+    parallel_quicksort(&hi);
+    ws_sync(&child);
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void check_sorted(const int* array, size_t n)
+{
+    for (size_t i = 1; i < n; ++i)
+    {
+        if (array[i - 1] > array[i])
+        {
+            fprintf(stderr, "array not sorted at index %zu\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void run_parallel(
+    const int* input,
+    int*       array,
+    size_t     n,
+    size_t     n_workers,
+    double     sequential)
+{
+    ws_pool_t* pool = ws_new(n_workers);
+    if (NULL == pool)
+    {
+        fprintf(stderr, "ws_new() failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(array, input, n*sizeof(int));
+
+    sort_args_t args = { .array = array, .n = n };
+
+    const double start = now_seconds();
+    ws_run(pool, parallel_quicksort, &args);
+    const double elapsed = now_seconds() - start;
+
+    check_sorted(array, n);
+    ws_delete(pool);
+
+    printf("%10zu  %10.3f  %10.2f\n", n_workers, elapsed, sequential / elapsed);
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t n = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_N_ITEMS;
+
+    const size_t n_cpus = (size_t) sysconf(_SC_NPROCESSORS_ONLN);
+
+    int* input = malloc(n*sizeof(int));
+    int* array = malloc(n*sizeof(int));
+    if (NULL == input || NULL == array)
+    {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    srand(1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        input[i] = rand();
+    }
+
+    memcpy(array, input, n*sizeof(int));
+
+    const double start = now_seconds();
+    sequential_quicksort(array, n);
+    const double sequential = now_seconds() - start;
+
+    check_sorted(array, n);
+
+    printf("%zu items, %zu processors\n", n, n_cpus);
+    printf("%10s  %10s  %10s\n", "workers", "seconds", "speedup");
+    printf("%10s  %10.3f  %10.2f\n", "sequential", sequential, 1.0);
+
+    // powers of two, finishing with exactly the number of processors
+    for (size_t n_workers = 1; n_workers < n_cpus; n_workers *= 2)
+    {
+        run_parallel(input, array, n, n_workers, sequential);
+    }
+
+    run_parallel(input, array, n, n_cpus, sequential);
+
+    free(array);
+    free(input);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,299 @@
+// check.c
+// Driver program for work-stealing runtime tests.
+
+// attribute gnu_printf
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "deque.h"
+#include "work_stealing.h"
+
+#define N_WORKERS 4
+#define N_THIEVES 3
+#define N_ITEMS   100000
+
+// ----------------------------------------------------------------------------
+// Definitions for Testing
+
+typedef struct steal_args
+{
+    deque_t*      deque;
+    atomic_bool*  done;
+    atomic_uchar* seen;
+} steal_args_t;
+
+static void* thief(void* arg)
+{
+    steal_args_t* args = (steal_args_t*) arg;
+
+    size_t stolen = 0;
+    while (!atomic_load(args->done) || deque_count(args->deque) > 0)
+    {
+        void* item = deque_steal(args->deque);
+        if (item != NULL)
+        {
+            atomic_fetch_add(&args->seen[(uintptr_t) item - 1], 1);
+            stolen++;
+        }
+    }
+
+    return (void*) stolen;
+}
+
+typedef struct fib_args
+{
+    unsigned n;
+    uint64_t result;
+} fib_args_t;
+
+static void fib(void* arg)
+{
+    fib_args_t* args = (fib_args_t*) arg;
+    if (args->n < 2)
+    {
+        args->result = args->n;
+        return;
+    }
+
+    fib_args_t a = { .n = args->n - 1 };
+    fib_args_t b = { .n = args->n - 2 };
+
+    ws_task_t child;
+    ws_spawn(&child, fib, &a);
+    fib(&b);
+    ws_sync(&child);
+
+    args->result = a.result + b.result;
+}
+
+static uint64_t fib_sequential(unsigned n)
+{
+    return (n < 2) ? n : fib_sequential(n - 1) + fib_sequential(n - 2);
+}
+
+typedef struct sum_args
+{
+    const uint32_t* values;
+    size_t          n;
+    uint64_t        result;
+} sum_args_t;
+
+static void parallel_sum(void* arg)
+{
+    sum_args_t* args = (sum_args_t*) arg;
+    if (args->n <= 64)
+    {
+        args->result = 0;
+        for (size_t i = 0; i < args->n; ++i)
+        {
+            args->result += args->values[i];
+        }
+        return;
+    }
+
+    const size_t half = args->n / 2;
+    sum_args_t lo = { .values = args->values, .n = half };
+    sum_args_t hi = { .values = args->values + half, .n = args->n - half };
+
+    ws_task_t child;
+    ws_spawn(&child, parallel_sum, &lo);
+    parallel_sum(&hi);
+    ws_sync(&child);
+
+    args->result = lo.result + hi.result;
+}
+
+// ----------------------------------------------------------------------------
+// Test Cases
+
+START_TEST(test_deque_owner)
+{
+    deque_t* deque = deque_new(4);
+    ck_assert_msg(deque != NULL, "deque_new() returned NULL");
+
+    // push beyond the initial capacity to force growth
+    for (uintptr_t i = 1; i <= 100; ++i)
+    {
+        ck_assert_msg(deque_push(deque, (void*) i), "deque_push() failed");
+    }
+
+    ck_assert_msg(deque_count(deque) == 100, "deque_count() returned incorrect value");
+
+    // thieves take from the top (oldest)...
+    ck_assert_msg((uintptr_t) deque_steal(deque) == 1, "deque_steal() returned incorrect item");
+    ck_assert_msg((uintptr_t) deque_steal(deque) == 2, "deque_steal() returned incorrect item");
+
+    // ...while the owner takes from the bottom (newest)
+    for (uintptr_t i = 100; i >= 3; --i)
+    {
+        ck_assert_msg((uintptr_t) deque_take(deque) == i, "deque_take() returned incorrect item");
+    }
+
+    ck_assert_msg(NULL == deque_take(deque), "deque_take() returned item from empty deque");
+    ck_assert_msg(NULL == deque_steal(deque), "deque_steal() returned item from empty deque");
+
+    deque_delete(deque);
+}
+END_TEST
+
+START_TEST(test_deque_concurrent)
+{
+    pthread_t thieves[N_THIEVES];
+
+    atomic_bool done;
+    atomic_init(&done, false);
+
+    atomic_uchar* seen = calloc(N_ITEMS, sizeof(atomic_uchar));
+    ck_assert(seen != NULL);
+
+    deque_t* deque = deque_new(16);
+    ck_assert_msg(deque != NULL, "deque_new() returned NULL");
+
+    steal_args_t args = { .deque = deque, .done = &done, .seen = seen };
+    for (size_t i = 0; i < N_THIEVES; ++i)
+    {
+        ck_assert(0 == pthread_create(&thieves[i], NULL, thief, &args));
+    }
+
+    // the owner interleaves pushes and takes while thieves steal
+    size_t taken = 0;
+    for (uintptr_t i = 1; i <= N_ITEMS; ++i)
+    {
+        ck_assert_msg(deque_push(deque, (void*) i), "deque_push() failed");
+        if (0 == i % 3)
+        {
+            void* item = deque_take(deque);
+            if (item != NULL)
+            {
+                atomic_fetch_add(&seen[(uintptr_t) item - 1], 1);
+                taken++;
+            }
+        }
+    }
+
+    atomic_store(&done, true);
+
+    size_t stolen = 0;
+    for (size_t i = 0; i < N_THIEVES; ++i)
+    {
+        void* ret;
+        pthread_join(thieves[i], &ret);
+        stolen += (size_t) ret;
+    }
+
+    // every item is removed exactly once
+    ck_assert_msg(taken + stolen == N_ITEMS, "items lost or duplicated");
+    for (size_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(1 == atomic_load(&seen[i]), "item removed other than exactly once");
+    }
+
+    deque_delete(deque);
+    free(seen);
+}
+END_TEST
+
+START_TEST(test_ws_new)
+{
+    ws_pool_t* pool = ws_new(N_WORKERS);
+    ck_assert_msg(pool != NULL, "ws_new() returned NULL");
+    ck_assert_msg(ws_size(pool) == N_WORKERS, "ws_size() returned incorrect value");
+
+    ck_assert_msg(NULL == ws_new(0), "ws_new() succeeded with no workers");
+
+    ws_delete(pool);
+}
+END_TEST
+
+START_TEST(test_ws_fib)
+{
+    ws_pool_t* pool = ws_new(N_WORKERS);
+    ck_assert_msg(pool != NULL, "ws_new() returned NULL");
+
+    fib_args_t args = { .n = 24 };
+    ck_assert_msg(ws_run(pool, fib, &args), "ws_run() failed");
+    ck_assert_msg(args.result == fib_sequential(24), "parallel fib returned incorrect result");
+
+    // the runtime may be reused for subsequent roots
+    args.n = 16;
+    ck_assert_msg(ws_run(pool, fib, &args), "ws_run() failed");
+    ck_assert_msg(args.result == fib_sequential(16), "parallel fib returned incorrect result");
+
+    ws_delete(pool);
+}
+END_TEST
+
+START_TEST(test_ws_sum)
+{
+    const size_t n = 1 << 20;
+
+    uint32_t* values = malloc(n*sizeof(uint32_t));
+    ck_assert(values != NULL);
+
+    uint64_t expected = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        values[i] = (uint32_t) (i*2654435761u);
+        expected += values[i];
+    }
+
+    ws_pool_t* pool = ws_new(N_WORKERS);
+    ck_assert_msg(pool != NULL, "ws_new() returned NULL");
+
+    sum_args_t args = { .values = values, .n = n };
+    ck_assert_msg(ws_run(pool, parallel_sum, &args), "ws_run() failed");
+    ck_assert_msg(args.result == expected, "parallel sum returned incorrect result");
+
+    ws_delete(pool);
+    free(values);
+}
+END_TEST
+
+START_TEST(test_ws_spawn_outside)
+{
+    // outside of a worker, spawned tasks run immediately
+    fib_args_t args = { .n = 10 };
+
+    ws_task_t task;
+    ws_spawn(&task, fib, &args);
+    ws_sync(&task);
+
+    ck_assert_msg(args.result == fib_sequential(10), "fib returned incorrect result");
+}
+END_TEST
+
+// ----------------------------------------------------------------------------
+// Infrastructure
+ 
+Suite* work_stealing_suite(void)
+{
+    Suite* s = suite_create("work-stealing");
+    TCase* tc_core = tcase_create("work-stealing-core");
+    
+    tcase_add_test(tc_core, test_deque_owner);
+    tcase_add_test(tc_core, test_deque_concurrent);
+    tcase_add_test(tc_core, test_ws_new);
+    tcase_add_test(tc_core, test_ws_fib);
+    tcase_add_test(tc_core, test_ws_sum);
+    tcase_add_test(tc_core, test_ws_spawn_outside);
+
+    suite_add_tcase(s, tc_core);
+    
+    return s;
+}
+
+int main(void)
+{
+    Suite* suite = work_stealing_suite();
+    SRunner* runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);    
+    srunner_free(runner);
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,250 @@
+// deque.c
+// A lock-free work-stealing deque (Chase-Lev).
+
+#include <stdlib.h>
+
+#include "deque.h"
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+// A circular array of items.
+typedef struct deque_array
+{
+    // The next array in the list of retired arrays.
+    struct deque_array* next;
+
+    // The capacity of the array (a power of two), less one.
+    long mask;
+
+    // The items; accessed atomically because thieves read
+    // slots concurrently with the owner writing other slots.
+    _Atomic(void*) items[];
+} deque_array_t;
+
+static deque_array_t* new_array(long capacity);
+static deque_array_t* grow_array(deque_t* deque, deque_array_t* array, long top, long bottom);
+
+static void* array_get(deque_array_t* array, long index);
+static void array_put(deque_array_t* array, long index, void* item);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+deque_t* deque_new(size_t capacity)
+{
+    if (0 == capacity)
+    {
+        return NULL;
+    }
+
+    // round the capacity up to a power of two
+    long rounded = 1;
+    while ((size_t) rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+
+    deque_t* deque = malloc(sizeof(deque_t));
+    if (NULL == deque)
+    {
+        return NULL;
+    }
+
+    deque_array_t* array = new_array(rounded);
+    if (NULL == array)
+    {
+        free(deque);
+        return NULL;
+    }
+
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->array, array);
+
+    deque->retired = NULL;
+
+    return deque;
+}
+
+void deque_delete(deque_t* deque)
+{
+    if (NULL == deque)
+    {
+        return;
+    }
+
+    deque_array_t* retired = deque->retired;
+    while (retired != NULL)
+    {
+        deque_array_t* next = retired->next;
+        free(retired);
+        retired = next;
+    }
+
+    free(atomic_load_explicit(&deque->array, memory_order_relaxed));
+    free(deque);
+}
+
+bool deque_push(deque_t* deque, void* item)
+{
+    if (NULL == deque || NULL == item)
+    {
+        return false;
+    }
+
+    const long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    const long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    deque_array_t* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    if (b - t > array->mask)
+    {
+        // the array is full
+        array = grow_array(deque, array, t, b);
+        if (NULL == array)
+        {
+            return false;
+        }
+    }
+
+    array_put(array, b, item);
+
+    // publish the item along with the new bottom; a release store
+    // rather than the paper's release fence, which ThreadSanitizer
+    // does not model, and which is no cheaper on common hardware
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_release);
+
+    return true;
+}
+
+void* deque_take(deque_t* deque)
+{
+    if (NULL == deque)
+    {
+        return NULL;
+    }
+
+    // reserve the bottom item before examining top
+    const long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    deque_array_t* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_seq_cst);
+
+    long t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (t > b)
+    {
+        // the deque was empty; restore bottom
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    void* item = array_get(array, b);
+    if (t == b)
+    {
+        // the last item; race thieves for it by advancing top
+        if (!atomic_compare_exchange_strong_explicit(
+            &deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+            // a thief won the race
+            item = NULL;
+        }
+
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return item;
+}
+
+void* deque_steal(deque_t* deque)
+{
+    if (NULL == deque)
+    {
+        return NULL;
+    }
+
+    long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const long b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (t >= b)
+    {
+        // the deque is empty
+        return NULL;
+    }
+
+    deque_array_t* array = atomic_load_explicit(&deque->array, memory_order_acquire);
+    void* item = array_get(array, t);
+
+    // claim the item by advancing top; fails if another thread took it first
+    if (!atomic_compare_exchange_strong_explicit(
+        &deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        return NULL;
+    }
+
+    return item;
+}
+
+size_t deque_count(deque_t* deque)
+{
+    if (NULL == deque)
+    {
+        return 0;
+    }
+
+    const long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    const long t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    return (b > t) ? (size_t) (b - t) : 0;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static deque_array_t* new_array(long capacity)
+{
+    deque_array_t* array = malloc(sizeof(deque_array_t) + (size_t) capacity*sizeof(void*));
+    if (NULL == array)
+    {
+        return NULL;
+    }
+
+    array->next = NULL;
+    array->mask = capacity - 1;
+
+    return array;
+}
+
+static deque_array_t* grow_array(deque_t* deque, deque_array_t* array, long top, long bottom)
+{
+    deque_array_t* grown = new_array(2*(array->mask + 1));
+    if (NULL == grown)
+    {
+        return NULL;
+    }
+
+    // items keep their logical indices; only their slots change
+    for (long i = top; i < bottom; ++i)
+    {
+        array_put(grown, i, array_get(array, i));
+    }
+
+    // thieves may still be reading from the old array
+    array->next    = deque->retired;
+    deque->retired = array;
+
+    atomic_store_explicit(&deque->array, grown, memory_order_release);
+
+    return grown;
+}
+
+static void* array_get(deque_array_t* array, long index)
+{
+    return atomic_load_explicit(&array->items[index & array->mask], memory_order_relaxed);
+}
+
+static void array_put(deque_array_t* array, long index, void* item)
+{
+    atomic_store_explicit(&array->items[index & array->mask], item, memory_order_relaxed);
+}
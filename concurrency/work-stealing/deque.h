@@ -0,0 +1,134 @@
+// deque.h
+// A lock-free work-stealing deque (Chase-Lev).
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Background:
+//
+// A work-stealing deque is a double-ended queue with asymmetric
+// access: a single "owner" thread pushes and takes items at the
+// bottom end, in last-in first-out order, while any number of
+// "thief" threads concurrently steal items from the top end, in
+// first-in first-out order.
+//
+// This asymmetry is what makes work-stealing schedulers efficient.
+// The owner works on the most recently created (and therefore most
+// cache-resident) work, and only contends with thieves when the deque
+// is nearly empty. Thieves take the oldest work, which in recursive
+// divide-and-conquer computations tends to be the largest.
+//
+// This implementation follows the algorithm of Chase and Lev
+// ("Dynamic Circular Work-Stealing Deque", SPAA 2005), with the
+// C11 memory orderings given by Le, Pop, Cohen and Zappa Nardelli
+// ("Correct and Efficient Work-Stealing for Weak Memory Models",
+// PPoPP 2013). Items are stored in a circular array that the owner
+// grows when it fills; because a thief may still be reading from an
+// array after it has been replaced, replaced arrays are retained
+// until the deque is destroyed.
+
+struct deque_array;
+
+// The work-stealing deque.
+typedef struct deque
+{
+    // The index one past the most recently pushed item; owner-only writes.
+    atomic_long bottom;
+
+    // The index of the oldest item; advanced by thieves (and the owner).
+    atomic_long top;
+
+    // The current circular array of items.
+    _Atomic(struct deque_array*) array;
+
+    // Arrays replaced by growth, retained until destruction.
+    struct deque_array* retired;
+} deque_t;
+
+// deque_new()
+//
+// Construct a new work-stealing deque.
+//
+// Arguments:
+//  capacity - the initial capacity, rounded up to a power of two
+//
+// Returns:
+//  A pointer to a newly constructed deque on success
+//  NULL on failure (invalid argument, allocation failure)
+deque_t* deque_new(size_t capacity);
+
+// deque_delete()
+//
+// Destroy an existing work-stealing deque.
+//
+// This function IS NOT threadsafe. The items remaining
+// in the deque, if any, are not destroyed.
+//
+// Arguments:
+//  deque - pointer to an existing deque
+void deque_delete(deque_t* deque);
+
+// deque_push()
+//
+// Push an item onto the bottom of the deque.
+//
+// This function may only be called by the owner of the deque.
+//
+// Arguments:
+//  deque - pointer to an existing deque
+//  item  - the item to push; must not be NULL
+//
+// Returns:
+//  `true` if the item is pushed
+//  `false` on failure (invalid argument, allocation failure)
+bool deque_push(deque_t* deque, void* item);
+
+// deque_take()
+//
+// Take the most recently pushed item from the bottom of the deque.
+//
+// This function may only be called by the owner of the deque.
+//
+// Arguments:
+//  deque - pointer to an existing deque
+//
+// Returns:
+//  The item taken from the deque
+//  NULL if the deque is empty
+void* deque_take(deque_t* deque);
+
+// deque_steal()
+//
+// Steal the oldest item from the top of the deque.
+//
+// This function is threadsafe, and may be called by any thread.
+// It fails if it loses a race with another thread for the item,
+// in which case the caller may retry, or look for work elsewhere.
+//
+// Arguments:
+//  deque - pointer to an existing deque
+//
+// Returns:
+//  The item stolen from the deque
+//  NULL if the deque is empty, or the steal lost a race
+void* deque_steal(deque_t* deque);
+
+// deque_count()
+//
+// Return the approximate number of items in the deque.
+//
+// This function is threadsafe, but the count may be stale
+// by the time it is returned if other threads are active.
+//
+// Arguments:
+//  deque - pointer to an existing deque
+//
+// Returns:
+//  The number of items in the deque
+size_t deque_count(deque_t* deque);
+
+#endif // DEQUE_H
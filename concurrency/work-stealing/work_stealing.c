@@ -0,0 +1,476 @@
+// work_stealing.c
+// A work-stealing fork/join runtime.
+
+// pthread_cond_timedwait(), clock_gettime(), sched_yield()
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "deque.h"
+#include "work_stealing.h"
+
+// The assumed size of a cache line, used to separate per-worker state.
+#define CACHE_LINE_SIZE 64
+
+// The initial capacity of each worker's deque.
+#define DEQUE_CAPACITY 1024
+
+// Failed searches for work before an idle worker yields, and sleeps.
+#define IDLE_SPINS   64
+#define IDLE_YIELDS  128
+
+// The longest an idle worker sleeps before searching for work again.
+#define IDLE_SLEEP_NS 1000000L
+
+#define NS_PER_SEC 1000000000L
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+// A task submitted from outside the runtime by ws_run().
+typedef struct root_task
+{
+    ws_task_t         task;
+    struct root_task* next;
+} root_task_t;
+
+// The state maintained for each worker.
+typedef struct worker
+{
+    // Aligned so that workers do not share cache lines.
+    _Alignas(CACHE_LINE_SIZE) pthread_t thread;
+
+    // The runtime to which the worker belongs.
+    struct ws_pool* pool;
+
+    // The worker's own deque of spawned tasks.
+    deque_t* deque;
+
+    // State for the random selection of victims.
+    uint64_t rng;
+} worker_t;
+
+struct ws_pool
+{
+    // The array of `n_workers` workers, of which `n_started` have threads.
+    worker_t* workers;
+    size_t    n_workers;
+    size_t    n_started;
+
+    // Set when the runtime is shutting down.
+    atomic_bool stop;
+
+    // The number of workers asleep waiting for work.
+    atomic_size_t n_sleeping;
+
+    // Guards the list of root tasks and the condition variables.
+    pthread_mutex_t lock;
+
+    // Signaled when work may be available for sleeping workers.
+    pthread_cond_t work_available;
+
+    // Broadcast when a root task completes.
+    pthread_cond_t root_done;
+
+    // Root tasks waiting to be picked up by a worker.
+    root_task_t* roots_head;
+    root_task_t* roots_tail;
+
+    // The length of the list of root tasks, which may be read without the lock.
+    atomic_size_t n_roots;
+};
+
+// The worker running on the current thread, if any.
+static _Thread_local worker_t* current_worker = NULL;
+
+static void* worker_main(void* arg);
+
+static ws_task_t* find_task(worker_t* worker);
+static root_task_t* take_root(ws_pool_t* pool);
+static void execute(ws_task_t* task);
+static void idle(worker_t* worker, size_t failures);
+static void wake_sleeper(ws_pool_t* pool);
+
+static size_t random_victim(worker_t* worker);
+static void cpu_relax(void);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+ws_pool_t* ws_new(size_t n_workers)
+{
+    if (0 == n_workers)
+    {
+        return NULL;
+    }
+
+    ws_pool_t* pool = malloc(sizeof(ws_pool_t));
+    if (NULL == pool)
+    {
+        return NULL;
+    }
+
+    pool->workers = aligned_alloc(CACHE_LINE_SIZE, n_workers*sizeof(worker_t));
+    if (NULL == pool->workers)
+    {
+        free(pool);
+        return NULL;
+    }
+
+    // create every deque before starting any worker, since workers steal
+    for (size_t i = 0; i < n_workers; ++i)
+    {
+        pool->workers[i].deque = deque_new(DEQUE_CAPACITY);
+        if (NULL == pool->workers[i].deque)
+        {
+            while (i-- > 0)
+            {
+                deque_delete(pool->workers[i].deque);
+            }
+
+            free(pool->workers);
+            free(pool);
+            return NULL;
+        }
+
+        pool->workers[i].pool = pool;
+        pool->workers[i].rng  = 0x9e3779b97f4a7c15ULL*(i + 1);
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->root_done, NULL);
+
+    atomic_init(&pool->stop, false);
+    atomic_init(&pool->n_sleeping, 0);
+    atomic_init(&pool->n_roots, 0);
+
+    pool->roots_head = NULL;
+    pool->roots_tail = NULL;
+    pool->n_workers  = n_workers;
+    pool->n_started  = 0;
+
+    for (size_t i = 0; i < n_workers; ++i)
+    {
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]) != 0)
+        {
+            // shut down the workers that were started
+            ws_delete(pool);
+            return NULL;
+        }
+
+        pool->n_started++;
+    }
+
+    return pool;
+}
+
+void ws_delete(ws_pool_t* pool)
+{
+    if (NULL == pool)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->stop, true);
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->n_started; ++i)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    for (size_t i = 0; i < pool->n_workers; ++i)
+    {
+        deque_delete(pool->workers[i].deque);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_cond_destroy(&pool->root_done);
+
+    free(pool->workers);
+    free(pool);
+}
+
+bool ws_run(ws_pool_t* pool, ws_task_f fn, void* arg)
+{
+    if (NULL == pool || NULL == fn)
+    {
+        return false;
+    }
+
+    if (current_worker != NULL && current_worker->pool == pool)
+    {
+        // already running on this runtime; no need to hand off
+        fn(arg);
+        return true;
+    }
+
+    root_task_t root;
+    root.task.fn  = fn;
+    root.task.arg = arg;
+    root.next     = NULL;
+    atomic_init(&root.task.done, false);
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (NULL == pool->roots_tail)
+    {
+        pool->roots_head = &root;
+    }
+    else
+    {
+        pool->roots_tail->next = &root;
+    }
+
+    pool->roots_tail = &root;
+    atomic_fetch_add(&pool->n_roots, 1);
+
+    pthread_cond_signal(&pool->work_available);
+
+    while (!atomic_load_explicit(&root.task.done, memory_order_acquire))
+    {
+        pthread_cond_wait(&pool->root_done, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return true;
+}
+
+void ws_spawn(ws_task_t* task, ws_task_f fn, void* arg)
+{
+    if (NULL == task || NULL == fn)
+    {
+        return;
+    }
+
+    task->fn  = fn;
+    task->arg = arg;
+    atomic_store_explicit(&task->done, false, memory_order_relaxed);
+
+    worker_t* worker = current_worker;
+    if (NULL == worker || !deque_push(worker->deque, task))
+    {
+        // no deque to push to (or it could not grow); run the child now
+        execute(task);
+        return;
+    }
+
+    wake_sleeper(worker->pool);
+}
+
+void ws_sync(ws_task_t* task)
+{
+    if (NULL == task)
+    {
+        return;
+    }
+
+    worker_t* worker = current_worker;
+    while (!atomic_load_explicit(&task->done, memory_order_acquire))
+    {
+        // the child is either still in our deque, or was stolen;
+        // either way, make progress on whatever work we can find
+        ws_task_t* other = (NULL == worker) ? NULL : find_task(worker);
+        if (other != NULL)
+        {
+            execute(other);
+        }
+        else
+        {
+            cpu_relax();
+        }
+    }
+}
+
+size_t ws_size(ws_pool_t* pool)
+{
+    return (NULL == pool) ? 0 : pool->n_workers;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static void* worker_main(void* arg)
+{
+    worker_t* worker = (worker_t*) arg;
+    ws_pool_t* pool  = worker->pool;
+
+    current_worker = worker;
+
+    size_t failures = 0;
+    while (!atomic_load_explicit(&pool->stop, memory_order_relaxed))
+    {
+        ws_task_t* task = find_task(worker);
+        if (task != NULL)
+        {
+            execute(task);
+            failures = 0;
+            continue;
+        }
+
+        root_task_t* root = take_root(pool);
+        if (root != NULL)
+        {
+            execute(&root->task);
+
+            // the submitter may return (and release `root`) as soon as it
+            // observes completion; take the lock so it cannot miss the wakeup
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_broadcast(&pool->root_done);
+            pthread_mutex_unlock(&pool->lock);
+
+            failures = 0;
+            continue;
+        }
+
+        idle(worker, ++failures);
+    }
+
+    return NULL;
+}
+
+static ws_task_t* find_task(worker_t* worker)
+{
+    // prefer our own most recently spawned work
+    ws_task_t* task = deque_take(worker->deque);
+    if (task != NULL)
+    {
+        return task;
+    }
+
+    ws_pool_t* pool = worker->pool;
+    if (1 == pool->n_workers)
+    {
+        return NULL;
+    }
+
+    // otherwise attempt a round of steals from randomly chosen victims
+    for (size_t i = 0; i < pool->n_workers; ++i)
+    {
+        worker_t* victim = &pool->workers[random_victim(worker)];
+        if (victim == worker)
+        {
+            continue;
+        }
+
+        task = deque_steal(victim->deque);
+        if (task != NULL)
+        {
+            return task;
+        }
+    }
+
+    return NULL;
+}
+
+static root_task_t* take_root(ws_pool_t* pool)
+{
+    // peek without the lock, to keep idle workers off of it
+    if (0 == atomic_load_explicit(&pool->n_roots, memory_order_relaxed))
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    root_task_t* root = pool->roots_head;
+    if (root != NULL)
+    {
+        pool->roots_head = root->next;
+        if (NULL == pool->roots_head)
+        {
+            pool->roots_tail = NULL;
+        }
+
+        atomic_fetch_sub(&pool->n_roots, 1);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return root;
+}
+
+static void execute(ws_task_t* task)
+{
+    task->fn(task->arg);
+
+    // last access to the task; its storage may be released once this is seen
+    atomic_store_explicit(&task->done, true, memory_order_release);
+}
+
+static void idle(worker_t* worker, size_t failures)
+{
+    if (failures < IDLE_SPINS)
+    {
+        cpu_relax();
+        return;
+    }
+
+    if (failures < IDLE_YIELDS)
+    {
+        sched_yield();
+        return;
+    }
+
+    ws_pool_t* pool = worker->pool;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += IDLE_SLEEP_NS;
+    if (deadline.tv_nsec >= NS_PER_SEC)
+    {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= NS_PER_SEC;
+    }
+
+    // spawns wake sleepers on a best-effort basis, so sleep with a
+    // timeout to bound the delay should one of those wakeups be missed
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->n_sleeping, 1);
+
+    if (NULL == pool->roots_head && !atomic_load(&pool->stop))
+    {
+        pthread_cond_timedwait(&pool->work_available, &pool->lock, &deadline);
+    }
+
+    atomic_fetch_sub(&pool->n_sleeping, 1);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void wake_sleeper(ws_pool_t* pool)
+{
+    if (atomic_load_explicit(&pool->n_sleeping, memory_order_relaxed) > 0)
+    {
+        pthread_cond_signal(&pool->work_available);
+    }
+}
+
+static size_t random_victim(worker_t* worker)
+{
+    // xorshift64*
+    uint64_t x = worker->rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    worker->rng = x;
+
+    return (size_t) ((x*0x2545f4914f6cdd1dULL) >> 32) % worker->pool->n_workers;
+}
+
+static void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
@@ -0,0 +1,140 @@
+// work_stealing.h
+// A work-stealing fork/join runtime.
+
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Background:
+//
+// Recursive divide-and-conquer algorithms (quicksort, mergesort,
+// tree and graph traversals) expose parallelism in a nested, dynamic
+// way: each call splits its input and recurses on the parts, which
+// could run in parallel, and then joins the results. This pattern is
+// known as "fork/join" parallelism. In this module a task forks a
+// child with ws_spawn(), and later joins it with ws_sync().
+//
+// A shared queue of tasks (e.g. a thread pool) is a poor fit for
+// fork/join workloads: every fork contends on the queue, and a task
+// blocked waiting to join its children ties up a worker thread.
+// A work-stealing runtime instead gives each worker its own deque
+// (see deque.h). A worker pushes the tasks it spawns onto the bottom
+// of its own deque and pops them from there, without contention, in
+// the order a sequential program would run them. A worker that runs
+// out of work picks another worker at random (the "victim") and
+// steals the task at the top of the victim's deque; in recursive
+// computations, the oldest task is typically the largest piece of
+// remaining work, so steals are rare relative to spawns.
+//
+// When a worker syncs on a child that has been stolen, rather than
+// blocking, it runs other tasks (its own, or stolen ones) until the
+// child completes. A worker is therefore never idle while there is
+// work available anywhere in the system.
+//
+// Spawned tasks are described by a ws_task_t, which the spawning
+// code provides storage for, typically on its own stack. Spawning
+// therefore never allocates, but it imposes a constraint: a task
+// must sync every child it spawns before it returns (or before the
+// storage for the child's ws_task_t goes out of scope).
+
+// The signature for user-provided tasks.
+typedef void (*ws_task_f)(void* arg);
+
+// A spawned task; storage is provided by the spawner.
+typedef struct ws_task
+{
+    // The task and its argument.
+    ws_task_f fn;
+    void*     arg;
+
+    // Set once the task has run to completion.
+    atomic_bool done;
+} ws_task_t;
+
+// The work-stealing runtime.
+typedef struct ws_pool ws_pool_t;
+
+// ws_new()
+//
+// Construct a new work-stealing runtime and start its workers.
+//
+// Arguments:
+//  n_workers - the number of worker threads
+//
+// Returns:
+//  A pointer to a newly constructed runtime on success
+//  NULL on failure (invalid argument, allocation failure)
+ws_pool_t* ws_new(size_t n_workers);
+
+// ws_delete()
+//
+// Stop the workers and destroy an existing work-stealing runtime.
+//
+// This function must not be called while any call
+// to ws_run() on the same runtime is in progress.
+//
+// Arguments:
+//  pool - pointer to an existing runtime
+void ws_delete(ws_pool_t* pool);
+
+// ws_run()
+//
+// Run a root task on the runtime and wait for it to complete.
+//
+// This function is threadsafe, and is the entry point into the
+// runtime from threads that are not workers. The task runs on one
+// of the workers, and may spawn children with ws_spawn(). It is
+// complete once it returns, which implies all of its descendants
+// have been synced.
+//
+// Arguments:
+//  pool - pointer to an existing runtime
+//  fn   - the root task
+//  arg  - the argument passed to `fn`
+//
+// Returns:
+//  `true` once the task has run
+//  `false` on failure (invalid argument)
+bool ws_run(ws_pool_t* pool, ws_task_f fn, void* arg);
+
+// ws_spawn()
+//
+// Fork a child task that may run in parallel with the caller.
+//
+// The child is pushed onto the calling worker's deque, where it
+// may be stolen by another worker. If this function is called
+// from a thread that is not a worker, the child runs immediately.
+// The storage for `task` must remain valid until ws_sync(task).
+//
+// Arguments:
+//  task - storage for the task record
+//  fn   - the child task
+//  arg  - the argument passed to `fn`
+void ws_spawn(ws_task_t* task, ws_task_f fn, void* arg);
+
+// ws_sync()
+//
+// Join a child task forked by ws_spawn().
+//
+// Returns once the child has run to completion. While
+// waiting, the calling worker runs other available tasks.
+//
+// Arguments:
+//  task - the task record passed to ws_spawn()
+void ws_sync(ws_task_t* task);
+
+// ws_size()
+//
+// Return the number of workers in the runtime.
+//
+// Arguments:
+//  pool - pointer to an existing runtime
+//
+// Returns:
+//  The number of workers, 0 on invalid argument
+size_t ws_size(ws_pool_t* pool);
+
+#endif // WORK_STEALING_H
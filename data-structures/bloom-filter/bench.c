@@ -0,0 +1,847 @@
+// bench.c
+// Throughput benchmarks for the bloom filters.
+//
+// The hashing benchmark inserts keys into a filter and then tests for
+// them, for k (the number of hash functions) from 1 to 16 and keys from
+// 8 bytes to 4KB, reporting the mean time per insert and per test. Every
+// test probes all k bits, since every key tested is present.
+//
+// The filter, which derives its k bits from a single 128-bit Murmur3 hash
+// by double hashing, is compared against the previous implementation
+// (reproduced below as old_insert() and old_test()), which computed a
+// separate 32-bit Murmur3 hash with a different seed for each bit. Keys
+// are drawn from a buffer of random bytes; the number of keys in each
+// run is scaled down with their size, so that each run hashes about the
+// same number of bytes.
+//
+// The layout benchmark compares the standard filter (with k = 7) against
+// the blocked filter, at 10 bits per item, for filters that fit in the
+// L2 cache and filters much larger than the last-level cache. It fills
+// each filter, then reports the mean time to test for items that are
+// present and for items that are absent, and the measured rate of false
+// positives among the latter. It then repeats the tests with the batch
+// operations, in batches of LAYOUT_BATCH items.
+//
+// The deletable benchmark compares the filters that support removal,
+// the counting bloom filter and the cuckoo filter, against the standard
+// filter, each sized for the same number of items at false-positive
+// rates of 1%, 0.1% and 0.01%. It reports the memory used per item, the
+// mean time to test for present and absent items and to remove an item,
+// and the measured rate of false positives.
+//
+// The concurrent benchmark inserts distinct keys from t threads at once,
+// for t from 1 to 8, into a concurrent filter, and into a standard filter
+// guarded by a single mutex, and reports the total throughput in millions
+// of inserts per second. The scaling of the concurrent filter depends on
+// the number of cores.
+//
+// The merge benchmark saves a filter of MERGE_BITS bits to a file, and
+// reports the time to load it with filter_load() and with filter_map()
+// and then test for 1000 items, and the rates at which filter_union()
+// and filter_intersect() combine two such filters.
+//
+// The storage benchmark fills a filter of STORAGE_BITS bits to about
+// half its bits, and reports the time to clear it bit by bit (as the
+// previous implementation did, reproduced below as old_clear()) and with
+// filter_clear(), and the time for filter_stats() to count its set bits
+// and compute its estimates.
+//
+// Usage:
+//  ./bench [bytes hashed per run]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "murmur3.h"
+#include "bloom_filter.h"
+#include "blocked_bloom_filter.h"
+#include "counting_bloom_filter.h"
+#include "cuckoo_filter.h"
+#include "concurrent_bloom_filter.h"
+
+#define DEFAULT_BYTES_PER_RUN (64*1024*1024)
+
+// The number of bits in the filter.
+#define N_BITS (1 << 24)
+
+// The most keys in any run.
+#define MAX_KEYS 1000000
+
+#define MAX_HASHES 16
+
+// The buffer from which keys are drawn.
+#define BUFFER_SIZE (1 << 22)
+
+// Bits per item, and hashes for the standard filter, in the layout benchmark.
+#define LAYOUT_BITS_PER_ITEM 10
+#define LAYOUT_HASHES        7
+
+// The most tests of each kind in each run of the layout benchmark.
+#define LAYOUT_MAX_TESTS 4000000
+
+// The number of items in each batch in the layout benchmark.
+#define LAYOUT_BATCH 1024
+
+// The number of items in each filter in the deletable benchmark,
+// which fills a cuckoo filter of 2^18 buckets to about 90%.
+#define DELETABLE_ITEMS 950000
+
+// The filter size, and inserts by each thread, in the concurrent benchmark.
+#define CONCURRENT_BITS        (1 << 27)
+#define CONCURRENT_INSERTS     1000000
+#define CONCURRENT_MAX_THREADS 8
+
+// The filter size in the merge benchmark, and the file it is saved to.
+#define MERGE_BITS ((size_t) 1 << 30)
+#define MERGE_PATH "/tmp/bloom-filter-bench"
+
+// The filter size in the storage benchmark.
+#define STORAGE_BITS ((size_t) 1 << 30)
+
+// Absent keys are offset from the inserted keys by this amount.
+#define ABSENT_OFFSET (1ULL << 40)
+
+// ----------------------------------------------------------------------------
+// Baseline: One Hash Per Bit
+
+#define SET_BIT(A,k)   ( A[(k) / 64] |=  (1ULL << ((k) % 64)) )
+#define TEST_BIT(A,k)  ( A[(k) / 64] &   (1ULL << ((k) % 64)) )
+#define CLEAR_BIT(A,k) ( A[(k) / 64] &= ~(1ULL << ((k) % 64)) )
+
+static void old_insert(bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    uint32_t hash;
+    uint32_t seed = 0;
+
+    for (size_t i = 0; i < filter->n_hashes; ++i)
+    {
+        MurmurHash3_x86_32(data, (int) len, seed++, &hash);
+
+        const size_t bit = hash % filter->n_bits;
+        SET_BIT(filter->bitvector, bit);
+    }
+
+    filter->n_items++;
+}
+
+static filter_test_t old_test(bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    uint32_t hash;
+    uint32_t seed = 0;
+
+    for (size_t i = 0; i < filter->n_hashes; ++i)
+    {
+        MurmurHash3_x86_32(data, (int) len, seed++, &hash);
+
+        const size_t bit = hash % filter->n_bits;
+        if (!TEST_BIT(filter->bitvector, bit))
+        {
+            return ABSENT;
+        }
+    }
+
+    return PRESENT;
+}
+
+static void old_clear(bloom_filter_t* filter)
+{
+    for (size_t i = 0; i < filter->n_bits; ++i)
+    {
+        CLEAR_BIT(filter->bitvector, i);
+    }
+
+    filter->n_items = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+static uint64_t next_random(uint64_t* state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void fail(const char* message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+static byte_t buffer[BUFFER_SIZE];
+
+// The offset of each key in the buffer.
+static size_t offsets[MAX_KEYS];
+
+// Time n_keys inserts and then n_keys tests, in nanoseconds per operation.
+static void run_hashing(bool old, size_t n_hashes, size_t len, size_t n_keys, double* insert_ns, double* test_ns)
+{
+    bloom_filter_t* filter = filter_new(N_BITS, n_hashes);
+    if (NULL == filter)
+    {
+        fail("allocation failed");
+    }
+
+    const double start = now_seconds();
+
+    for (size_t i = 0; i < n_keys; ++i)
+    {
+        if (old)
+        {
+            old_insert(filter, buffer + offsets[i], len);
+        }
+        else
+        {
+            filter_insert(filter, buffer + offsets[i], len);
+        }
+    }
+
+    const double middle = now_seconds();
+
+    size_t n_present = 0;
+    for (size_t i = 0; i < n_keys; ++i)
+    {
+        const filter_test_t result = old
+            ? old_test(filter, buffer + offsets[i], len)
+            : filter_test(filter, buffer + offsets[i], len);
+
+        n_present += (PRESENT == result);
+    }
+
+    const double end = now_seconds();
+
+    if (n_present != n_keys)
+    {
+        fail("false negative");
+    }
+
+    *insert_ns = (middle - start)*1e9 / (double) n_keys;
+    *test_ns   = (end - middle)*1e9 / (double) n_keys;
+
+    filter_delete(filter);
+}
+
+static filter_test_t layout_test(bloom_filter_t* standard, blocked_bloom_filter_t* blocked, uint64_t key)
+{
+    return (standard != NULL)
+        ? filter_test(standard, (byte_t*) &key, sizeof(key))
+        : blocked_filter_test(blocked, (byte_t*) &key, sizeof(key));
+}
+
+static size_t layout_test_batch(bloom_filter_t* standard, blocked_bloom_filter_t* blocked, uint64_t* keys, size_t n)
+{
+    static byte_t*  data[LAYOUT_BATCH];
+    static size_t   lens[LAYOUT_BATCH];
+    static uint64_t results[FILTER_BATCH_WORDS(LAYOUT_BATCH)];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        data[i] = (byte_t*) &keys[i];
+        lens[i] = sizeof(keys[i]);
+    }
+
+    return (standard != NULL)
+        ? filter_test_batch(standard, data, lens, n, results)
+        : blocked_filter_test_batch(blocked, data, lens, n, results);
+}
+
+// Time n_tests tests in batches, for present or absent keys, in nanoseconds per test.
+static double time_batches(bloom_filter_t* standard, blocked_bloom_filter_t* blocked, uint64_t n_items, size_t n_tests, bool present)
+{
+    static uint64_t keys[LAYOUT_BATCH];
+
+    uint64_t rng = 2;
+    size_t   n_found = 0;
+
+    const double start = now_seconds();
+
+    for (size_t done = 0; done < n_tests; done += LAYOUT_BATCH)
+    {
+        const size_t n = (n_tests - done < LAYOUT_BATCH) ? n_tests - done : LAYOUT_BATCH;
+        for (size_t i = 0; i < n; ++i)
+        {
+            keys[i] = present
+                ? next_random(&rng) % n_items
+                : ABSENT_OFFSET + next_random(&rng);
+        }
+
+        n_found += layout_test_batch(standard, blocked, keys, n);
+    }
+
+    const double elapsed = now_seconds() - start;
+
+    if (present && n_found != n_tests)
+    {
+        fail("false negative");
+    }
+
+    return elapsed*1e9 / (double) n_tests;
+}
+
+static void run_layout(const char* name, bool use_blocked, size_t n_bits)
+{
+    bloom_filter_t*         standard = NULL;
+    blocked_bloom_filter_t* blocked  = NULL;
+
+    if (use_blocked)
+    {
+        blocked = blocked_filter_new(n_bits);
+    }
+    else
+    {
+        standard = filter_new(n_bits, LAYOUT_HASHES);
+    }
+
+    if (NULL == standard && NULL == blocked)
+    {
+        fail("allocation failed");
+    }
+
+    const uint64_t n_items = n_bits / LAYOUT_BITS_PER_ITEM;
+    for (uint64_t key = 0; key < n_items; ++key)
+    {
+        if (use_blocked)
+        {
+            blocked_filter_insert(blocked, (byte_t*) &key, sizeof(key));
+        }
+        else
+        {
+            filter_insert(standard, (byte_t*) &key, sizeof(key));
+        }
+    }
+
+    const size_t n_tests = (n_items < LAYOUT_MAX_TESTS) ? n_items : LAYOUT_MAX_TESTS;
+
+    // present keys are tested in a random order, so that
+    // each test for a large filter misses in the cache
+    uint64_t rng = 1;
+    double start = now_seconds();
+
+    size_t n_present = 0;
+    for (size_t i = 0; i < n_tests; ++i)
+    {
+        const uint64_t key = next_random(&rng) % n_items;
+        n_present += (PRESENT == layout_test(standard, blocked, key));
+    }
+
+    const double present_ns = (now_seconds() - start)*1e9 / (double) n_tests;
+
+    start = now_seconds();
+
+    size_t n_false_positives = 0;
+    for (size_t i = 0; i < n_tests; ++i)
+    {
+        const uint64_t key = ABSENT_OFFSET + next_random(&rng);
+        n_false_positives += (PRESENT == layout_test(standard, blocked, key));
+    }
+
+    const double absent_ns = (now_seconds() - start)*1e9 / (double) n_tests;
+
+    if (n_present != n_tests)
+    {
+        fail("false negative");
+    }
+
+    const double batch_present_ns = time_batches(standard, blocked, n_items, n_tests, true);
+    const double batch_absent_ns  = time_batches(standard, blocked, n_items, n_tests, false);
+
+    printf("%8s  %10zu  %10llu  %12.1f  %12.1f  %12.1f  %12.1f  %10.3f\n",
+        name, n_bits / 8 / 1024, (unsigned long long) n_items,
+        present_ns, absent_ns, batch_present_ns, batch_absent_ns,
+        100.0*(double) n_false_positives / (double) n_tests);
+
+    filter_delete(standard);
+    blocked_filter_delete(blocked);
+}
+
+typedef enum deletable
+{
+    STANDARD,
+    COUNTING,
+    CUCKOO
+} deletable_t;
+
+typedef struct deletable_filter
+{
+    deletable_t              kind;
+    bloom_filter_t*          standard;
+    counting_bloom_filter_t* counting;
+    cuckoo_filter_t*         cuckoo;
+} deletable_filter_t;
+
+static filter_test_t deletable_test(deletable_filter_t* f, uint64_t key)
+{
+    switch (f->kind)
+    {
+    case STANDARD:
+        return filter_test(f->standard, (byte_t*) &key, sizeof(key));
+    case COUNTING:
+        return counting_filter_test(f->counting, (byte_t*) &key, sizeof(key));
+    case CUCKOO:
+        return cuckoo_filter_test(f->cuckoo, (byte_t*) &key, sizeof(key));
+    }
+
+    return ERROR;
+}
+
+static bool deletable_remove(deletable_filter_t* f, uint64_t key)
+{
+    switch (f->kind)
+    {
+    case STANDARD:
+        return false;
+    case COUNTING:
+        return counting_filter_remove(f->counting, (byte_t*) &key, sizeof(key));
+    case CUCKOO:
+        return cuckoo_filter_remove(f->cuckoo, (byte_t*) &key, sizeof(key));
+    }
+
+    return false;
+}
+
+static void run_deletable(const char* name, deletable_t kind, double fpr)
+{
+    deletable_filter_t f = { .kind = kind };
+
+    // the memory of the filter's bits, counters or entries
+    double n_bits = 0.0;
+
+    switch (kind)
+    {
+    case STANDARD:
+        f.standard = filter_new_optimal(DELETABLE_ITEMS, fpr);
+        n_bits = (NULL == f.standard) ? 0.0 : (double) f.standard->n_bits;
+        break;
+    case COUNTING:
+        f.counting = counting_filter_new_optimal(DELETABLE_ITEMS, fpr);
+        n_bits = (NULL == f.counting) ? 0.0 : 4.0*(double) f.counting->n_counters;
+        break;
+    case CUCKOO:
+        f.cuckoo = cuckoo_filter_new_optimal(DELETABLE_ITEMS, fpr);
+        n_bits = (NULL == f.cuckoo) ? 0.0
+            : (double) (f.cuckoo->n_buckets*CUCKOO_BUCKET_SIZE*f.cuckoo->fingerprint_bits);
+        break;
+    }
+
+    if (0.0 == n_bits)
+    {
+        fail("allocation failed");
+    }
+
+    for (uint64_t key = 0; key < DELETABLE_ITEMS; ++key)
+    {
+        bool inserted = true;
+        switch (kind)
+        {
+        case STANDARD:
+            filter_insert(f.standard, (byte_t*) &key, sizeof(key));
+            break;
+        case COUNTING:
+            counting_filter_insert(f.counting, (byte_t*) &key, sizeof(key));
+            break;
+        case CUCKOO:
+            inserted = cuckoo_filter_insert(f.cuckoo, (byte_t*) &key, sizeof(key));
+            break;
+        }
+
+        if (!inserted)
+        {
+            fail("filter full");
+        }
+    }
+
+    uint64_t rng = 1;
+    double start = now_seconds();
+
+    size_t n_present = 0;
+    for (size_t i = 0; i < DELETABLE_ITEMS; ++i)
+    {
+        const uint64_t key = next_random(&rng) % DELETABLE_ITEMS;
+        n_present += (PRESENT == deletable_test(&f, key));
+    }
+
+    const double present_ns = (now_seconds() - start)*1e9 / DELETABLE_ITEMS;
+
+    start = now_seconds();
+
+    size_t n_false_positives = 0;
+    for (size_t i = 0; i < DELETABLE_ITEMS; ++i)
+    {
+        const uint64_t key = ABSENT_OFFSET + next_random(&rng);
+        n_false_positives += (PRESENT == deletable_test(&f, key));
+    }
+
+    const double absent_ns = (now_seconds() - start)*1e9 / DELETABLE_ITEMS;
+
+    if (n_present != DELETABLE_ITEMS)
+    {
+        fail("false negative");
+    }
+
+    // remove every item, in order
+    start = now_seconds();
+
+    for (uint64_t key = 0; key < DELETABLE_ITEMS && kind != STANDARD; ++key)
+    {
+        if (!deletable_remove(&f, key))
+        {
+            fail("remove failed");
+        }
+    }
+
+    const double remove_ns = (now_seconds() - start)*1e9 / DELETABLE_ITEMS;
+
+    if (STANDARD == kind)
+    {
+        printf("%8s  %8.3f  %10.2f  %12.1f  %12.1f  %12s  %10.4f\n",
+            name, 100.0*fpr, n_bits / DELETABLE_ITEMS, present_ns, absent_ns, "-",
+            100.0*(double) n_false_positives / DELETABLE_ITEMS);
+    }
+    else
+    {
+        printf("%8s  %8.3f  %10.2f  %12.1f  %12.1f  %12.1f  %10.4f\n",
+            name, 100.0*fpr, n_bits / DELETABLE_ITEMS, present_ns, absent_ns, remove_ns,
+            100.0*(double) n_false_positives / DELETABLE_ITEMS);
+    }
+
+    filter_delete(f.standard);
+    counting_filter_delete(f.counting);
+    cuckoo_filter_delete(f.cuckoo);
+}
+
+typedef struct insert_args
+{
+    bool                       use_concurrent;
+    bloom_filter_t*            standard;
+    pthread_mutex_t*           lock;
+    concurrent_bloom_filter_t* concurrent;
+    pthread_barrier_t*         barrier;
+    uint64_t                   first;
+} insert_args_t;
+
+static void* insert_worker(void* arg)
+{
+    insert_args_t* args = (insert_args_t*) arg;
+
+    pthread_barrier_wait(args->barrier);
+
+    for (uint64_t key = args->first; key < args->first + CONCURRENT_INSERTS; ++key)
+    {
+        if (args->use_concurrent)
+        {
+            concurrent_filter_insert(args->concurrent, (byte_t*) &key, sizeof(key));
+        }
+        else
+        {
+            pthread_mutex_lock(args->lock);
+            filter_insert(args->standard, (byte_t*) &key, sizeof(key));
+            pthread_mutex_unlock(args->lock);
+        }
+    }
+
+    return NULL;
+}
+
+// Time inserts from n_threads threads, in millions of inserts per second.
+static double run_concurrent(bool use_concurrent, size_t n_threads)
+{
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+
+    bloom_filter_t*            standard   = use_concurrent ? NULL : filter_new(CONCURRENT_BITS, LAYOUT_HASHES);
+    concurrent_bloom_filter_t* concurrent = use_concurrent ? concurrent_filter_new(CONCURRENT_BITS, LAYOUT_HASHES) : NULL;
+
+    if (NULL == standard && NULL == concurrent)
+    {
+        fail("allocation failed");
+    }
+
+    // the threads start together, once all have been created
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned) n_threads + 1);
+
+    pthread_t     threads[CONCURRENT_MAX_THREADS];
+    insert_args_t args[CONCURRENT_MAX_THREADS];
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        args[i] = (insert_args_t) {
+            .use_concurrent = use_concurrent,
+            .standard       = standard,
+            .lock           = &lock,
+            .concurrent     = concurrent,
+            .barrier        = &barrier,
+            .first          = i*CONCURRENT_INSERTS
+        };
+
+        if (pthread_create(&threads[i], NULL, insert_worker, &args[i]) != 0)
+        {
+            fail("pthread_create() failed");
+        }
+    }
+
+    pthread_barrier_wait(&barrier);
+    const double start = now_seconds();
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    const double elapsed = now_seconds() - start;
+
+    const filter_stats_t stats = use_concurrent
+        ? concurrent_filter_stats(concurrent)
+        : filter_stats(standard);
+
+    if (stats.n_items != n_threads*CONCURRENT_INSERTS)
+    {
+        fail("inserts lost");
+    }
+
+    pthread_barrier_destroy(&barrier);
+    pthread_mutex_destroy(&lock);
+    filter_delete(standard);
+    concurrent_filter_delete(concurrent);
+
+    return (double) (n_threads*CONCURRENT_INSERTS) / elapsed / 1e6;
+}
+
+// Load the saved filter by filter_load() or filter_map(), and test
+// for some items, returning the elapsed time in milliseconds.
+static double time_open(bool use_map)
+{
+    const double start = now_seconds();
+
+    bloom_filter_t* filter = use_map ? filter_map(MERGE_PATH) : filter_load(MERGE_PATH);
+    if (NULL == filter)
+    {
+        fail("load failed");
+    }
+
+    for (uint64_t key = 0; key < 1000; ++key)
+    {
+        if (filter_test(filter, (byte_t*) &key, sizeof(key)) != PRESENT)
+        {
+            fail("false negative");
+        }
+    }
+
+    const double elapsed = now_seconds() - start;
+
+    filter_delete(filter);
+    return elapsed*1e3;
+}
+
+static void run_merge(void)
+{
+    bloom_filter_t* a = filter_new(MERGE_BITS, LAYOUT_HASHES);
+    bloom_filter_t* b = filter_new(MERGE_BITS, LAYOUT_HASHES);
+    if (NULL == a || NULL == b)
+    {
+        fail("allocation failed");
+    }
+
+    const uint64_t n_items = MERGE_BITS / LAYOUT_BITS_PER_ITEM / 2;
+    for (uint64_t key = 0; key < n_items; ++key)
+    {
+        const uint64_t other = ABSENT_OFFSET + key;
+        filter_insert(a, (byte_t*) &key, sizeof(key));
+        filter_insert(b, (byte_t*) &other, sizeof(other));
+    }
+
+    if (!filter_save(a, MERGE_PATH))
+    {
+        fail("save failed");
+    }
+
+    const double load_ms = time_open(false);
+    const double map_ms  = time_open(true);
+
+    unlink(MERGE_PATH);
+
+    // each operation reads two vectors and writes one
+    const double bytes = 3.0*(double) (MERGE_BITS / 8);
+
+    double start = now_seconds();
+    if (!filter_union(a, b))
+    {
+        fail("union failed");
+    }
+
+    const double union_gbs = bytes / (now_seconds() - start) / 1e9;
+
+    start = now_seconds();
+    if (!filter_intersect(a, b))
+    {
+        fail("intersect failed");
+    }
+
+    const double intersect_gbs = bytes / (now_seconds() - start) / 1e9;
+
+    printf("%10s  %10s  %10s  %12s  %12s\n", "MB", "load ms", "map ms", "union GB/s", "isect GB/s");
+    printf("%10zu  %10.1f  %10.1f  %12.2f  %12.2f\n",
+        MERGE_BITS / 8 / 1024 / 1024, load_ms, map_ms, union_gbs, intersect_gbs);
+
+    filter_delete(a);
+    filter_delete(b);
+}
+
+static void fill_half(bloom_filter_t* filter)
+{
+    // with k hashes, m / (2k) items set about 40% of the bits
+    const uint64_t n_items = filter->n_bits / (2*filter->n_hashes);
+    for (uint64_t key = 0; key < n_items; ++key)
+    {
+        filter_insert(filter, (byte_t*) &key, sizeof(key));
+    }
+}
+
+static void run_storage(void)
+{
+    bloom_filter_t* filter = filter_new(STORAGE_BITS, LAYOUT_HASHES);
+    if (NULL == filter)
+    {
+        fail("allocation failed");
+    }
+
+    fill_half(filter);
+
+    double start = now_seconds();
+    old_clear(filter);
+    const double old_clear_ms = (now_seconds() - start)*1e3;
+
+    fill_half(filter);
+
+    start = now_seconds();
+    filter_clear(filter);
+    const double clear_ms = (now_seconds() - start)*1e3;
+
+    fill_half(filter);
+
+    start = now_seconds();
+    const filter_stats_t stats = filter_stats(filter);
+    const double stats_ms = (now_seconds() - start)*1e3;
+
+    printf("%10s  %12s  %10s  %10s  %12s  %10s\n",
+        "MB", "old clear ms", "clear ms", "stats ms", "est. items", "fpr %");
+    printf("%10zu  %12.1f  %10.1f  %10.1f  %12.0f  %10.3f\n",
+        STORAGE_BITS / 8 / 1024 / 1024, old_clear_ms, clear_ms, stats_ms,
+        stats.n_items_estimate, 100.0*stats.fpr_estimate);
+    printf("(%zu items inserted)\n", stats.n_items);
+
+    filter_delete(filter);
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t bytes_per_run = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_BYTES_PER_RUN;
+
+    uint64_t rng = 1;
+    for (size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        buffer[i] = (byte_t) (next_random(&rng) >> 56);
+    }
+
+    const size_t key_sizes[] = { 8, 64, 512, 4096 };
+
+    printf("%6s  %3s  %8s  %12s  %12s  %12s  %12s\n",
+        "bytes", "k", "keys", "old insert", "insert", "old test", "test");
+
+    for (size_t s = 0; s < sizeof(key_sizes) / sizeof(key_sizes[0]); ++s)
+    {
+        const size_t len = key_sizes[s];
+
+        size_t n_keys = bytes_per_run / len;
+        if (n_keys > MAX_KEYS)
+        {
+            n_keys = MAX_KEYS;
+        }
+
+        if (0 == n_keys)
+        {
+            n_keys = 1;
+        }
+
+        for (size_t i = 0; i < n_keys; ++i)
+        {
+            offsets[i] = next_random(&rng) % (BUFFER_SIZE - len);
+        }
+
+        for (size_t k = 1; k <= MAX_HASHES; ++k)
+        {
+            double old_insert_ns;
+            double old_test_ns;
+            double insert_ns;
+            double test_ns;
+
+            run_hashing(true, k, len, n_keys, &old_insert_ns, &old_test_ns);
+            run_hashing(false, k, len, n_keys, &insert_ns, &test_ns);
+
+            printf("%6zu  %3zu  %8zu  %12.1f  %12.1f  %12.1f  %12.1f\n",
+                len, k, n_keys, old_insert_ns, insert_ns, old_test_ns, test_ns);
+        }
+    }
+
+    printf("(nanoseconds per operation)\n\n");
+
+    printf("%8s  %10s  %10s  %12s  %12s  %12s  %12s  %10s\n",
+        "filter", "KB", "items", "present ns", "absent ns", "batch pres", "batch abs", "fpr %");
+
+    for (size_t log_bits = 20; log_bits <= 28; log_bits += 4)
+    {
+        run_layout("standard", false, (size_t) 1 << log_bits);
+        run_layout("blocked", true, (size_t) 1 << log_bits);
+    }
+
+    printf("\n%8s  %8s  %10s  %12s  %12s  %12s  %10s\n",
+        "filter", "target %", "bits/item", "present ns", "absent ns", "remove ns", "fpr %");
+
+    const double rates[] = { 0.01, 0.001, 0.0001 };
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r)
+    {
+        run_deletable("standard", STANDARD, rates[r]);
+        run_deletable("counting", COUNTING, rates[r]);
+        run_deletable("cuckoo", CUCKOO, rates[r]);
+    }
+
+    printf("\n%7s  %12s  %12s\n", "threads", "mutex", "concurrent");
+
+    for (size_t n_threads = 1; n_threads <= CONCURRENT_MAX_THREADS; n_threads *= 2)
+    {
+        const double locked     = run_concurrent(false, n_threads);
+        const double concurrent = run_concurrent(true, n_threads);
+
+        printf("%7zu  %12.2f  %12.2f\n", n_threads, locked, concurrent);
+    }
+
+    printf("(millions of inserts per second)\n\n");
+
+    run_merge();
+
+    printf("\n");
+    run_storage();
+
+    return EXIT_SUCCESS;
+}
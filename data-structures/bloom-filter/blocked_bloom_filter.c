@@ -0,0 +1,392 @@
+// blocked_bloom_filter.c
+// A cache-friendly bloom filter whose bits for each item share a cache line.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "murmur3.h"
+#include "blocked_bloom_filter.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_AVX2 1
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+// The number of items hashed and prefetched together by batch operations.
+#define BATCH_GROUP 16
+
+// The number of bytes in each block.
+#define BLOCK_BYTES (BLOCK_BITS / 8)
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+// Odd multipliers, one per word, that spread a 32-bit hash over the
+// bits of each word (the constants are those of Apache Parquet).
+static const uint32_t SALT[BLOCK_HASHES] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+// Test or set the bits for a hash in a block.
+typedef bool (*test_block_f)(const uint64_t* block, uint64_t hash);
+typedef void (*set_block_f)(uint64_t* block, uint64_t hash);
+
+static uint64_t* block_of(blocked_bloom_filter_t* filter, uint64_t hash);
+static void make_mask(uint64_t hash, uint64_t mask[BLOCK_HASHES]);
+
+static bool test_block_scalar(const uint64_t* block, uint64_t hash);
+static void set_block_scalar(uint64_t* block, uint64_t hash);
+
+#ifdef HAVE_AVX2
+static bool test_block_avx2(const uint64_t* block, uint64_t hash);
+static void set_block_avx2(uint64_t* block, uint64_t hash);
+#endif
+
+static test_block_f select_test_block(void);
+static set_block_f select_set_block(void);
+static bool valid_item(byte_t* data, size_t len);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+blocked_bloom_filter_t* blocked_filter_new(const size_t n_bits)
+{
+    const size_t n_blocks = n_bits / BLOCK_BITS + (n_bits % BLOCK_BITS != 0);
+
+    // blocks are selected by a 32-bit hash
+    if (0 == n_blocks || n_blocks > UINT32_MAX)
+    {
+        return NULL;
+    }
+
+    blocked_bloom_filter_t* filter = malloc(sizeof(blocked_bloom_filter_t));
+    if (NULL == filter)
+    {
+        return NULL;
+    }
+
+    filter->blocks = aligned_alloc(CACHE_LINE_SIZE, n_blocks*BLOCK_BYTES);
+    if (NULL == filter->blocks)
+    {
+        free(filter);
+        return NULL;
+    }
+
+    memset(filter->blocks, 0, n_blocks*BLOCK_BYTES);
+
+    filter->n_blocks = n_blocks;
+    filter->n_items  = 0;
+
+    return filter;
+}
+
+void blocked_filter_delete(blocked_bloom_filter_t* filter)
+{
+    if (filter != NULL)
+    {
+        free(filter->blocks);
+        free(filter);
+    }
+}
+
+void blocked_filter_insert(blocked_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return;
+    }
+
+    uint64_t hash[2];
+    MurmurHash3_x64_128(data, (int) len, 0, hash);
+
+    set_block_scalar(block_of(filter, hash[0]), hash[1]);
+
+    filter->n_items++;
+}
+
+filter_test_t blocked_filter_test(blocked_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return ERROR;
+    }
+
+    uint64_t hash[2];
+    MurmurHash3_x64_128(data, (int) len, 0, hash);
+
+    return test_block_scalar(block_of(filter, hash[0]), hash[1]) ? PRESENT : ABSENT;
+}
+
+void blocked_filter_insert_batch(blocked_bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n)
+{
+    if (NULL == filter || NULL == data || NULL == lens)
+    {
+        return;
+    }
+
+    const set_block_f set_block = select_set_block();
+
+    uint64_t* blocks[BATCH_GROUP];
+    uint64_t  hashes[BATCH_GROUP];
+
+    for (size_t start = 0; start < n; start += BATCH_GROUP)
+    {
+        const size_t end = (n - start < BATCH_GROUP) ? n : start + BATCH_GROUP;
+
+        for (size_t i = start; i < end; ++i)
+        {
+            if (valid_item(data[i], lens[i]))
+            {
+                uint64_t hash[2];
+                MurmurHash3_x64_128(data[i], (int) lens[i], 0, hash);
+
+                blocks[i - start] = block_of(filter, hash[0]);
+                hashes[i - start] = hash[1];
+                __builtin_prefetch(blocks[i - start], 1);
+            }
+        }
+
+        for (size_t i = start; i < end; ++i)
+        {
+            if (valid_item(data[i], lens[i]))
+            {
+                set_block(blocks[i - start], hashes[i - start]);
+                filter->n_items++;
+            }
+        }
+    }
+}
+
+size_t blocked_filter_test_batch(blocked_bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n, uint64_t* results)
+{
+    if (NULL == filter || NULL == data || NULL == lens || NULL == results)
+    {
+        return 0;
+    }
+
+    const test_block_f test_block = select_test_block();
+
+    for (size_t i = 0; i < FILTER_BATCH_WORDS(n); ++i)
+    {
+        results[i] = 0;
+    }
+
+    const uint64_t* blocks[BATCH_GROUP];
+    uint64_t        hashes[BATCH_GROUP];
+    size_t          n_present = 0;
+
+    for (size_t start = 0; start < n; start += BATCH_GROUP)
+    {
+        const size_t end = (n - start < BATCH_GROUP) ? n : start + BATCH_GROUP;
+
+        for (size_t i = start; i < end; ++i)
+        {
+            if (valid_item(data[i], lens[i]))
+            {
+                uint64_t hash[2];
+                MurmurHash3_x64_128(data[i], (int) lens[i], 0, hash);
+
+                blocks[i - start] = block_of(filter, hash[0]);
+                hashes[i - start] = hash[1];
+                __builtin_prefetch(blocks[i - start], 0);
+            }
+        }
+
+        for (size_t i = start; i < end; ++i)
+        {
+            if (valid_item(data[i], lens[i]) && test_block(blocks[i - start], hashes[i - start]))
+            {
+                results[i / 64] |= 1ULL << (i % 64);
+                n_present++;
+            }
+        }
+    }
+
+    return n_present;
+}
+
+void blocked_filter_clear(blocked_bloom_filter_t* filter)
+{
+    if (NULL == filter)
+    {
+        return;
+    }
+
+    memset(filter->blocks, 0, filter->n_blocks*BLOCK_BYTES);
+    filter->n_items = 0;
+}
+
+filter_stats_t blocked_filter_stats(blocked_bloom_filter_t* filter)
+{
+    filter_stats_t stats = {
+        .n_items          = 0,
+        .n_bits           = 0,
+        .n_setbits        = 0,
+        .n_items_estimate = 0.0,
+        .fpr_estimate     = 0.0
+    };
+
+    if (filter != NULL)
+    {
+        stats.n_items = filter->n_items;
+        stats.n_bits  = filter->n_blocks*BLOCK_BITS;
+
+        // a test for an absent item finds its bit set in each word of its
+        // block with probability (bits set in the word) / 64
+        double fpr_sum = 0.0;
+
+        for (size_t b = 0; b < filter->n_blocks; ++b)
+        {
+            const uint64_t* block = filter->blocks + b*BLOCK_HASHES;
+
+            double fpr = 1.0;
+            for (size_t i = 0; i < BLOCK_HASHES; ++i)
+            {
+                const size_t n = (size_t) __builtin_popcountll(block[i]);
+                stats.n_setbits += n;
+                fpr *= (double) n / 64.0;
+            }
+
+            fpr_sum += fpr;
+        }
+
+        stats.fpr_estimate = fpr_sum / (double) filter->n_blocks;
+
+        // each item sets one bit of each of the words of its block, so
+        // after n items a word has (1 - (1 - 1/64)^(n / n_blocks)) set
+        const double f = (double) stats.n_setbits / (double) stats.n_bits;
+        stats.n_items_estimate = (stats.n_setbits == stats.n_bits)
+            ? INFINITY
+            : (double) filter->n_blocks*log1p(-f) / log1p(-1.0 / 64.0);
+    }
+
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static uint64_t* block_of(blocked_bloom_filter_t* filter, uint64_t hash)
+{
+    // map the hash onto [0, n_blocks) by multiplication rather than modulo
+    const uint64_t index = ((hash >> 32)*(uint64_t) filter->n_blocks) >> 32;
+    return filter->blocks + index*BLOCK_HASHES;
+}
+
+static void make_mask(uint64_t hash, uint64_t mask[BLOCK_HASHES])
+{
+    const uint32_t h = (uint32_t) hash;
+
+    // the top six bits of each product select a bit of the word
+    for (size_t i = 0; i < BLOCK_HASHES; ++i)
+    {
+        mask[i] = 1ULL << ((h*SALT[i]) >> 26);
+    }
+}
+
+static bool test_block_scalar(const uint64_t* block, uint64_t hash)
+{
+    uint64_t mask[BLOCK_HASHES];
+    make_mask(hash, mask);
+
+    // examine every word, without branching, since they share a cache line
+    uint64_t missing = 0;
+    for (size_t i = 0; i < BLOCK_HASHES; ++i)
+    {
+        missing |= mask[i] & ~block[i];
+    }
+
+    return 0 == missing;
+}
+
+static void set_block_scalar(uint64_t* block, uint64_t hash)
+{
+    uint64_t mask[BLOCK_HASHES];
+    make_mask(hash, mask);
+
+    for (size_t i = 0; i < BLOCK_HASHES; ++i)
+    {
+        block[i] |= mask[i];
+    }
+}
+
+#ifdef HAVE_AVX2
+
+// Build the masks for words 0-3 and 4-7 of a block, as make_mask() does.
+__attribute__((target("avx2")))
+static inline void make_mask_avx2(uint64_t hash, __m256i* low, __m256i* high)
+{
+    const __m256i salt = _mm256_setr_epi32(
+        (int) SALT[0], (int) SALT[1], (int) SALT[2], (int) SALT[3],
+        (int) SALT[4], (int) SALT[5], (int) SALT[6], (int) SALT[7]);
+
+    const __m256i products = _mm256_mullo_epi32(_mm256_set1_epi32((int) (uint32_t) hash), salt);
+    const __m256i shifts   = _mm256_srli_epi32(products, 26);
+
+    // widen the eight shift counts to 64 bits, and shift a one by each
+    const __m256i one = _mm256_set1_epi64x(1);
+    *low  = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shifts)));
+    *high = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shifts, 1)));
+}
+
+__attribute__((target("avx2")))
+static bool test_block_avx2(const uint64_t* block, uint64_t hash)
+{
+    __m256i low;
+    __m256i high;
+    make_mask_avx2(hash, &low, &high);
+
+    // blocks are aligned to a cache line, so both halves are aligned
+    const __m256i words_low  = _mm256_load_si256((const __m256i*) block);
+    const __m256i words_high = _mm256_load_si256((const __m256i*) (block + 4));
+
+    // testc() is set if every bit of the mask is set in the words
+    return _mm256_testc_si256(words_low, low) & _mm256_testc_si256(words_high, high);
+}
+
+__attribute__((target("avx2")))
+static void set_block_avx2(uint64_t* block, uint64_t hash)
+{
+    __m256i low;
+    __m256i high;
+    make_mask_avx2(hash, &low, &high);
+
+    __m256i* words = (__m256i*) block;
+    _mm256_store_si256(words, _mm256_or_si256(_mm256_load_si256(words), low));
+    _mm256_store_si256(words + 1, _mm256_or_si256(_mm256_load_si256(words + 1), high));
+}
+
+#endif // HAVE_AVX2
+
+static test_block_f select_test_block(void)
+{
+#ifdef HAVE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return test_block_avx2;
+    }
+#endif
+
+    return test_block_scalar;
+}
+
+static set_block_f select_set_block(void)
+{
+#ifdef HAVE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return set_block_avx2;
+    }
+#endif
+
+    return set_block_scalar;
+}
+
+static bool valid_item(byte_t* data, size_t len)
+{
+    return (data != NULL) && (len > 0);
+}
@@ -0,0 +1,170 @@
+// blocked_bloom_filter.h
+// A cache-friendly bloom filter whose bits for each item share a cache line.
+
+#ifndef BLOCKED_BLOOM_FILTER_H
+#define BLOCKED_BLOOM_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bloom_filter.h"
+
+// Background:
+//
+// In a standard bloom filter (bloom_filter.h), the k bits for an item are
+// scattered across the whole bit vector. Once the vector is larger than
+// the processor's caches, each of those bits is likely to be a separate
+// cache miss, and a test for an item that is present (which must examine
+// every bit) costs k misses.
+//
+// A blocked bloom filter (Putze, Sanders and Singler, 2007) divides the
+// vector into blocks the size of a cache line, here 64 bytes, and uses
+// one hash to select a block for the item and the rest to select bits
+// within the block. An insert or test then touches exactly one cache line.
+//
+// This implementation follows the "split block" design (as used by Apache
+// Parquet and Impala), in which each block is itself divided into eight
+// 64-bit words and an item sets exactly one bit in each word: bit
+// (h * SALT[i]) >> 26 of word i, for a 32-bit hash h and eight fixed odd
+// multipliers. The number of hash functions is thus fixed at eight, and
+// the eight bit positions are computed by independent multiplications
+// and shifts, which map directly onto SIMD lanes.
+//
+// Confining each item to a block makes the load on blocks uneven, so for
+// the same number of bits per item the false-positive rate is somewhat
+// higher than that of a standard filter; at 10 bits per item it is about
+// 1.05% rather than 0.82%. In exchange, a test costs a single cache miss.
+//
+// Both filters return filter_test_t and filter_stats_t, so they may be
+// substituted for one another.
+//
+// The batch operations hash items in small groups and prefetch the block
+// of each item in a group before examining any of them, so that the
+// cache misses of a group overlap. On processors that support AVX2, they
+// build the eight masks for an item in a single vector multiply, shift
+// and variable shift, and test or set the whole block with two 256-bit
+// operations; the implementation is selected at run time, and the scalar
+// implementation is used elsewhere.
+
+// The number of bits in each block, one cache line.
+#define BLOCK_BITS 512
+
+// The number of hash functions, one per 64-bit word of a block.
+#define BLOCK_HASHES 8
+
+// The blocked bloom filter data structure.
+typedef struct blocked_bloom_filter
+{
+    // The number of blocks in the filter.
+    size_t n_blocks;
+
+    // The number of items inserted into the filter.
+    size_t n_items;
+
+    // The blocks, each of BLOCK_HASHES words, aligned to a cache line.
+    uint64_t* blocks;
+} blocked_bloom_filter_t;
+
+// blocked_filter_new()
+//
+// Construct a new blocked bloom filter data structure.
+//
+// Arguments:
+//  n_bits - the number of bits in the filter, rounded up to a
+//           whole number of blocks (BLOCK_BITS bits each)
+//
+// Returns:
+//  A pointer to a newly constructed filter on success
+//  NULL on failure (invalid arguments, allocation failure)
+blocked_bloom_filter_t* blocked_filter_new(const size_t n_bits);
+
+// blocked_filter_delete()
+//
+// Destroy an existing blocked bloom filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void blocked_filter_delete(blocked_bloom_filter_t* filter);
+
+// blocked_filter_insert()
+//
+// Insert new data into the filter.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - arbitrary user data to insert
+//  len    - the length of the user data (in bytes)
+void blocked_filter_insert(blocked_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// blocked_filter_test()
+//
+// Test for the presence of `data` in an existing filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//  data   - arbitrary user data for which to test
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  ABSENT  if the data is not present in the filter
+//  PRESENT if the data is likely present in the filter
+//  ERROR   on error
+filter_test_t blocked_filter_test(blocked_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// blocked_filter_insert_batch()
+//
+// Insert `n` items into the filter, as if by
+// blocked_filter_insert() for each item in turn.
+// Items with NULL data or zero length are ignored.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - pointers to the items to insert
+//  lens   - the length of each item (in bytes)
+//  n      - the number of items
+void blocked_filter_insert_batch(blocked_bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n);
+
+// blocked_filter_test_batch()
+//
+// Test for the presence of `n` items in an existing filter.
+//
+// The results are written to a bitmap, in which bit (i % 64) of word
+// (i / 64) is set if item i is likely present, and cleared if it is
+// not present (or has NULL data or zero length).
+//
+// Arguments:
+//  filter  - pointer to existing filter
+//  data    - pointers to the items for which to test
+//  lens    - the length of each item (in bytes)
+//  n       - the number of items
+//  results - the result bitmap, of FILTER_BATCH_WORDS(n) words
+//
+// Returns:
+//  The number of items likely present in the filter
+//  0 on error (invalid arguments), in which case `results` is unchanged
+size_t blocked_filter_test_batch(blocked_bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n, uint64_t* results);
+
+// blocked_filter_clear()
+//
+// Clear all data from the filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void blocked_filter_clear(blocked_bloom_filter_t* filter);
+
+// blocked_filter_stats()
+//
+// Return metadata about the current state of the filter. The estimated
+// false-positive rate is averaged over the blocks, since the bits of each
+// block fill at their own rate; the estimated number of items assumes
+// that items are spread evenly over the blocks.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//
+// Returns:
+//  A structure populated with metadata regarding the filter state
+filter_stats_t blocked_filter_stats(blocked_bloom_filter_t* filter);
+
+#endif // BLOCKED_BLOOM_FILTER_H
@@ -1,25 +1,54 @@
 // bloom_filter.c
 // A probabilistic set implemented as a bloom filter.
 
+#define _DEFAULT_SOURCE
+
 #include <math.h>
+#include <stdio.h>
+#include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-#include "murmur3.h"
 #include "bloom_filter.h"
+#include "filter_internal.h"
 
 // set bit k in bit vector A
-#define SET_BIT(A,k) ( A[(k/8)] |=  (1 << (k % 8)) )
+#define SET_BIT(A,k)  ( A[(k) / 64] |= (1ULL << ((k) % 64)) )
 
 // test bit k in bit vector A
-#define TEST_BIT(A,k) ( A[(k/8)] &   (1 << (k % 8)) )
+#define TEST_BIT(A,k) ( A[(k) / 64] &  (1ULL << ((k) % 64)) )
+
+// The number of words converted at once when saving or loading a filter.
+#define IO_WORDS 512
+
+// The number of items hashed and prefetched together by batch operations.
+#define BATCH_GROUP 16
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
 
-// clear bit k in bit vector A 
-#define CLEAR_BIT(A,k) ( A[(k/8)] &= ~(1 << (k % 8)) )
+static void prefetch_probes(bloom_filter_t* filter, probe_t probe, int for_write);
+
+static size_t vector_words(size_t n_bits);
+static bool alloc_vector(bloom_filter_t* filter);
+static size_t count_setbits(bloom_filter_t* filter);
+static bool valid_tail(bloom_filter_t* filter);
+static void encode_header(bloom_filter_t* filter, byte_t header[FILTER_FILE_HEADER_SIZE]);
+static bool decode_header(const byte_t header[FILTER_FILE_HEADER_SIZE], bloom_filter_t* filter);
+static void put_le(byte_t* p, uint64_t value, size_t n);
+static uint64_t get_le(const byte_t* p, size_t n);
+static bool compatible(bloom_filter_t* a, bloom_filter_t* b);
+
+// ----------------------------------------------------------------------------
+// Exported
 
 bloom_filter_t* filter_new(const size_t n_bits, const size_t n_hashes)
 {
-	if (0 == n_bits || n_hashes == 0)
+	if (0 == n_bits || n_hashes == 0 || n_bits > SIZE_MAX - 64)
 	{
 		// invalid parameters
 		return NULL;
@@ -31,32 +60,51 @@ bloom_filter_t* filter_new(const size_t n_bits, const size_t n_hashes)
 		return NULL;
 	}
 
-	// compute the minimum number of bytes needed to represent
-	// a vector of the desired length
-	const size_t vector_len 
-		= (size_t) ceil((float) n_bits / (float) (sizeof(uint8_t)*CHAR_BIT)); 
+	filter->n_items  = 0;
+	filter->n_hashes = n_hashes;
+	filter->n_bits   = n_bits;
 
-	uint8_t* vector = calloc(vector_len, sizeof(uint8_t));
-	if (NULL == vector)
+	if (!alloc_vector(filter))
 	{
 		free(filter);
 		return NULL;
 	}
 
-	filter->bitvector  = vector;
-	filter->n_items    = 0;
-	filter->n_hashes   = n_hashes;
-	filter->n_bits     = n_bits;
-	filter->n_setbits  = 0;
-
 	return filter;
 }
 
+bloom_filter_t* filter_new_optimal(const size_t n_items, const double fpr)
+{
+	if (0 == n_items || !(fpr > 0.0 && fpr < 1.0))
+	{
+		// invalid parameters
+		return NULL;
+	}
+
+	const double ln2    = log(2.0);
+	const double n_bits = ceil(-(double) n_items*log(fpr) / (ln2*ln2));
+
+	// the vector must be addressable in bytes
+	if (n_bits > (double) (SIZE_MAX / CHAR_BIT))
+	{
+		return NULL;
+	}
+
+	const double n_hashes = round(n_bits / (double) n_items*ln2);
+
+	return filter_new((size_t) n_bits, (n_hashes < 1.0) ? 1 : (size_t) n_hashes);
+}
+
 void filter_delete(bloom_filter_t* filter)
 {
 	if (filter != NULL)
 	{
-		if (filter->bitvector != NULL)
+		if (filter->storage != STORAGE_HEAP)
+		{
+			// the bit vector lies within the mapping
+			munmap(filter->mapping, filter->mapping_len);
+		}
+		else
 		{
 			free(filter->bitvector);
 		}
@@ -72,25 +120,13 @@ void filter_insert(bloom_filter_t* filter, byte_t* data, size_t len)
 		return;
 	}
 
-	uint32_t hash;
-	uint32_t seed = 0;
+	probe_t probe = first_probe(data, len, filter->n_bits);
 
 	for (size_t i = 0; i < filter->n_hashes; ++i) 
 	{
-		// perform the hash
-		MurmurHash3_x86_32(data, len, seed++, &hash); 
-
-		// determine bit to set based on filter size 
-		const size_t bit = hash % filter->n_bits;
-
-		// made insertion slightly more complex than necessary 
-		// in order to track number of bits set in filter
-		if (!TEST_BIT(filter->bitvector, bit)) 
-		{
-			// set the bit in the filter
-			SET_BIT(filter->bitvector, bit); 
-			filter->n_setbits++; 
-		}
+		// set bits are counted on demand, by filter_stats()
+		SET_BIT(filter->bitvector, probe.position);
+		next_probe(&probe, filter->n_bits);
 	}
 
 	filter->n_items++; 
@@ -103,29 +139,120 @@ filter_test_t filter_test(bloom_filter_t* filter, byte_t* data, size_t len)
 		return ERROR;
 	}
 
-	uint32_t hash;
-	uint32_t seed = 0;
+	probe_t probe = first_probe(data, len, filter->n_bits);
 
 	for (size_t i = 0; i < filter->n_hashes; ++i) 
 	{
-		// do the hash 
-		MurmurHash3_x86_32(data, len, seed, &hash);
-
-		// determine bit to set based on filter size 
-		const size_t bit = hash % filter->n_bits; 
-
 		// test if bit is set if not, can 
 		// immediately report key not in filter 
-		if (!TEST_BIT(filter->bitvector, bit)) 
+		if (!TEST_BIT(filter->bitvector, probe.position)) 
 		{
 			return ABSENT; 
 		}
+
+		next_probe(&probe, filter->n_bits);
 	}
 
 	// all bits corresponding to key set, report key in filter 
 	return PRESENT;
 }
 
+void filter_insert_batch(bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n)
+{
+	if (NULL == filter || NULL == data || NULL == lens)
+	{
+		return;
+	}
+
+	probe_t probes[BATCH_GROUP];
+
+	for (size_t start = 0; start < n; start += BATCH_GROUP)
+	{
+		const size_t end = (n - start < BATCH_GROUP) ? n : start + BATCH_GROUP;
+
+		for (size_t i = start; i < end; ++i)
+		{
+			if (valid_item(data[i], lens[i]))
+			{
+				probes[i - start] = first_probe(data[i], lens[i], filter->n_bits);
+				prefetch_probes(filter, probes[i - start], 1);
+			}
+		}
+
+		for (size_t i = start; i < end; ++i)
+		{
+			if (!valid_item(data[i], lens[i]))
+			{
+				continue;
+			}
+
+			probe_t probe = probes[i - start];
+			for (size_t j = 0; j < filter->n_hashes; ++j)
+			{
+				SET_BIT(filter->bitvector, probe.position);
+				next_probe(&probe, filter->n_bits);
+			}
+
+			filter->n_items++;
+		}
+	}
+}
+
+size_t filter_test_batch(bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n, uint64_t* results)
+{
+	if (NULL == filter || NULL == data || NULL == lens || NULL == results)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < FILTER_BATCH_WORDS(n); ++i)
+	{
+		results[i] = 0;
+	}
+
+	probe_t probes[BATCH_GROUP];
+	size_t  n_present = 0;
+
+	for (size_t start = 0; start < n; start += BATCH_GROUP)
+	{
+		const size_t end = (n - start < BATCH_GROUP) ? n : start + BATCH_GROUP;
+
+		for (size_t i = start; i < end; ++i)
+		{
+			if (valid_item(data[i], lens[i]))
+			{
+				probes[i - start] = first_probe(data[i], lens[i], filter->n_bits);
+				prefetch_probes(filter, probes[i - start], 0);
+			}
+		}
+
+		for (size_t i = start; i < end; ++i)
+		{
+			if (!valid_item(data[i], lens[i]))
+			{
+				continue;
+			}
+
+			probe_t probe = probes[i - start];
+
+			bool present = true;
+			for (size_t j = 0; j < filter->n_hashes && present; ++j)
+			{
+				present = TEST_BIT(filter->bitvector, probe.position);
+				next_probe(&probe, filter->n_bits);
+			}
+
+			if (present)
+			{
+				results[i / 64] |= 1ULL << (i % 64);
+				n_present++;
+			}
+		}
+	}
+
+	return n_present;
+}
+
 void filter_clear(bloom_filter_t* filter)
 {
 	if (NULL == filter)
@@ -133,31 +260,407 @@ void filter_clear(bloom_filter_t* filter)
 		return;
 	}
 
-	// clear all of the bits in internal bit vector 
-	for (size_t i = 0; i < filter->n_bits; ++i) 
+	filter->n_items = 0;
+
+	const size_t len = vector_words(filter->n_bits)*sizeof(uint64_t);
+
+#if defined(__linux__) && defined(MADV_DONTNEED)
+	// discarded pages of a private anonymous mapping read as zero,
+	// so a large vector is cleared without writing it
+	if (STORAGE_ANONYMOUS == filter->storage
+	 && 0 == madvise(filter->bitvector, len, MADV_DONTNEED))
 	{
-		CLEAR_BIT(filter->bitvector, i);
+		return;
 	}
+#endif
 
-	// reset running counts 
-	filter->n_items    = 0;
-	filter->n_setbits  = 0;
+	memset(filter->bitvector, 0, len);
 }
 
 filter_stats_t filter_stats(bloom_filter_t* filter)
 {
 	filter_stats_t stats = {
-		.n_items   = 0,
-		.n_bits    = 0,
-		.n_setbits = 0
+		.n_items          = 0,
+		.n_bits           = 0,
+		.n_setbits        = 0,
+		.n_items_estimate = 0.0,
+		.fpr_estimate     = 0.0
 	};
 
 	if (filter != NULL)
 	{
 		stats.n_items   = filter->n_items;
 		stats.n_bits    = filter->n_bits;
-		stats.n_setbits = filter->n_setbits;
+		stats.n_setbits = count_setbits(filter);
+
+		estimate_fill(&stats, filter->n_hashes);
 	}
 
 	return stats;
-}
\ No newline at end of file
+}
+
+bool filter_save(bloom_filter_t* filter, const char* path)
+{
+	if (NULL == filter || NULL == path || filter->n_hashes > FILTER_FILE_MAX_HASHES)
+	{
+		return false;
+	}
+
+	FILE* file = fopen(path, "wb");
+	if (NULL == file)
+	{
+		return false;
+	}
+
+	byte_t header[FILTER_FILE_HEADER_SIZE];
+	encode_header(filter, header);
+
+	bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+	// write the words little-endian, whatever the byte order of the host
+	const size_t n_words = vector_words(filter->n_bits);
+	for (size_t i = 0; i < n_words && ok; i += IO_WORDS)
+	{
+		const size_t n = (n_words - i < IO_WORDS) ? n_words - i : IO_WORDS;
+
+		byte_t buffer[IO_WORDS*sizeof(uint64_t)];
+		for (size_t j = 0; j < n; ++j)
+		{
+			put_le(buffer + j*sizeof(uint64_t), filter->bitvector[i + j], sizeof(uint64_t));
+		}
+
+		ok = fwrite(buffer, sizeof(uint64_t), n, file) == n;
+	}
+
+	// a write error may only be reported on close
+	ok = (0 == fclose(file)) && ok;
+
+	return ok;
+}
+
+bloom_filter_t* filter_load(const char* path)
+{
+	if (NULL == path)
+	{
+		return NULL;
+	}
+
+	FILE* file = fopen(path, "rb");
+	if (NULL == file)
+	{
+		return NULL;
+	}
+
+	byte_t         header[FILTER_FILE_HEADER_SIZE];
+	bloom_filter_t parsed;
+	struct stat    st;
+
+	// the size is checked before the vector is allocated, since
+	// the header alone may claim a vector of any size
+	bloom_filter_t* filter = NULL;
+	if (fread(header, 1, sizeof(header), file) == sizeof(header)
+	 && decode_header(header, &parsed)
+	 && 0 == fstat(fileno(file), &st)
+	 && (size_t) st.st_size - FILTER_FILE_HEADER_SIZE == vector_words(parsed.n_bits)*sizeof(uint64_t))
+	{
+		filter = filter_new(parsed.n_bits, parsed.n_hashes);
+	}
+
+	if (filter != NULL)
+	{
+		filter->n_items = parsed.n_items;
+
+		bool ok = true;
+
+		const size_t n_words = vector_words(filter->n_bits);
+		for (size_t i = 0; i < n_words && ok; i += IO_WORDS)
+		{
+			const size_t n = (n_words - i < IO_WORDS) ? n_words - i : IO_WORDS;
+
+			byte_t buffer[IO_WORDS*sizeof(uint64_t)];
+			ok = fread(buffer, sizeof(uint64_t), n, file) == n;
+
+			for (size_t j = 0; j < n && ok; ++j)
+			{
+				filter->bitvector[i + j] = get_le(buffer + j*sizeof(uint64_t), sizeof(uint64_t));
+			}
+		}
+
+		// the bit vector must end the file exactly
+		if (!ok || fgetc(file) != EOF || !valid_tail(filter))
+		{
+			filter_delete(filter);
+			filter = NULL;
+		}
+	}
+
+	fclose(file);
+	return filter;
+}
+
+bloom_filter_t* filter_map(const char* path)
+{
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+	// the words of the file are not in the order of the host
+	(void) path;
+	return NULL;
+#endif
+
+	if (NULL == path)
+	{
+		return NULL;
+	}
+
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < FILTER_FILE_HEADER_SIZE)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	// writable but private, so that changes never reach the file
+	const size_t len     = (size_t) st.st_size;
+	void*        mapping = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	// the mapping remains valid once the descriptor is closed
+	close(fd);
+
+	if (MAP_FAILED == mapping)
+	{
+		return NULL;
+	}
+
+	bloom_filter_t parsed;
+	if (!decode_header(mapping, &parsed)
+	 || len - FILTER_FILE_HEADER_SIZE != vector_words(parsed.n_bits)*sizeof(uint64_t))
+	{
+		munmap(mapping, len);
+		return NULL;
+	}
+
+	bloom_filter_t* filter = malloc(sizeof(bloom_filter_t));
+	if (NULL == filter)
+	{
+		munmap(mapping, len);
+		return NULL;
+	}
+
+	*filter = parsed;
+	filter->bitvector   = (uint64_t*) ((byte_t*) mapping + FILTER_FILE_HEADER_SIZE);
+	filter->storage     = STORAGE_FILE;
+	filter->mapping     = mapping;
+	filter->mapping_len = len;
+
+	if (!valid_tail(filter))
+	{
+		filter_delete(filter);
+		return NULL;
+	}
+
+	return filter;
+}
+
+bool filter_union(bloom_filter_t* dst, bloom_filter_t* src)
+{
+	if (!compatible(dst, src))
+	{
+		return false;
+	}
+
+	const size_t n_words = vector_words(dst->n_bits);
+	for (size_t i = 0; i < n_words; ++i)
+	{
+		dst->bitvector[i] |= src->bitvector[i];
+	}
+
+	dst->n_items += src->n_items;
+
+	return true;
+}
+
+bool filter_intersect(bloom_filter_t* dst, bloom_filter_t* src)
+{
+	if (!compatible(dst, src))
+	{
+		return false;
+	}
+
+	const size_t n_words = vector_words(dst->n_bits);
+	for (size_t i = 0; i < n_words; ++i)
+	{
+		dst->bitvector[i] &= src->bitvector[i];
+	}
+
+	if (src->n_items < dst->n_items)
+	{
+		dst->n_items = src->n_items;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static void prefetch_probes(bloom_filter_t* filter, probe_t probe, int for_write)
+{
+	for (size_t i = 0; i < filter->n_hashes; ++i)
+	{
+		// the locality hint is a compile-time constant
+		if (for_write)
+		{
+			__builtin_prefetch(&filter->bitvector[probe.position / 64], 1);
+		}
+		else
+		{
+			__builtin_prefetch(&filter->bitvector[probe.position / 64], 0);
+		}
+
+		next_probe(&probe, filter->n_bits);
+	}
+}
+
+static size_t vector_words(size_t n_bits)
+{
+	return n_bits / 64 + (n_bits % 64 != 0);
+}
+
+// Allocate the zeroed bit vector for a filter of n_bits bits.
+static bool alloc_vector(bloom_filter_t* filter)
+{
+	const size_t n_words = vector_words(filter->n_bits);
+	const size_t len     = n_words*sizeof(uint64_t);
+
+	filter->mapping     = NULL;
+	filter->mapping_len = 0;
+
+#ifdef MAP_ANONYMOUS
+	if (len >= FILTER_HUGE_BYTES)
+	{
+		void* mapping = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping != MAP_FAILED)
+		{
+#ifdef MADV_HUGEPAGE
+			// only a hint; the vector works the same in ordinary pages
+			madvise(mapping, len, MADV_HUGEPAGE);
+#endif
+			filter->bitvector   = mapping;
+			filter->storage     = STORAGE_ANONYMOUS;
+			filter->mapping     = mapping;
+			filter->mapping_len = len;
+
+			return true;
+		}
+	}
+#endif
+
+	filter->bitvector = calloc(n_words, sizeof(uint64_t));
+	filter->storage   = STORAGE_HEAP;
+
+	return filter->bitvector != NULL;
+}
+
+static size_t count_setbits(bloom_filter_t* filter)
+{
+	const size_t n_words = vector_words(filter->n_bits);
+
+	size_t n_setbits = 0;
+	for (size_t i = 0; i < n_words; ++i)
+	{
+		n_setbits += (size_t) __builtin_popcountll(filter->bitvector[i]);
+	}
+
+	return n_setbits;
+}
+
+// Whether the bits of the last word past n_bits are all zero, as
+// count_setbits() assumes; a file may have been damaged or forged.
+static bool valid_tail(bloom_filter_t* filter)
+{
+	const size_t n_tail = filter->n_bits % 64;
+	if (0 == n_tail)
+	{
+		return true;
+	}
+
+	const uint64_t last = filter->bitvector[vector_words(filter->n_bits) - 1];
+	return 0 == (last & ~((1ULL << n_tail) - 1));
+}
+
+static void encode_header(bloom_filter_t* filter, byte_t header[FILTER_FILE_HEADER_SIZE])
+{
+	memset(header, 0, FILTER_FILE_HEADER_SIZE);
+	memcpy(header, FILTER_FILE_MAGIC, 8);
+
+	put_le(header + 8,  FILTER_FILE_VERSION, 4);
+	put_le(header + 12, filter->n_hashes, 4);
+	put_le(header + 16, filter->n_bits, 8);
+	put_le(header + 24, FILTER_SEED, 8);
+	put_le(header + 32, filter->n_items, 8);
+	put_le(header + 40, count_setbits(filter), 8);
+}
+
+// Parse and validate a header into the counts of `filter`.
+static bool decode_header(const byte_t header[FILTER_FILE_HEADER_SIZE], bloom_filter_t* filter)
+{
+	if (memcmp(header, FILTER_FILE_MAGIC, 8) != 0
+	 || get_le(header + 8, 4) != FILTER_FILE_VERSION
+	 || get_le(header + 24, 8) != FILTER_SEED)
+	{
+		return false;
+	}
+
+	const uint64_t n_hashes  = get_le(header + 12, 4);
+	const uint64_t n_bits    = get_le(header + 16, 8);
+	const uint64_t n_items   = get_le(header + 32, 8);
+	const uint64_t n_setbits = get_le(header + 40, 8);
+
+	if (0 == n_hashes || n_hashes > FILTER_FILE_MAX_HASHES
+	 || 0 == n_bits || n_setbits > n_bits
+	 || n_bits > SIZE_MAX - 64 || n_items > SIZE_MAX)
+	{
+		return false;
+	}
+
+	filter->n_bits      = (size_t) n_bits;
+	filter->n_hashes    = (size_t) n_hashes;
+	filter->n_items     = (size_t) n_items;
+	filter->bitvector   = NULL;
+	filter->storage     = STORAGE_HEAP;
+	filter->mapping     = NULL;
+	filter->mapping_len = 0;
+
+	return true;
+}
+
+static void put_le(byte_t* p, uint64_t value, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		p[i] = (byte_t) (value >> (8*i));
+	}
+}
+
+static uint64_t get_le(const byte_t* p, size_t n)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		value |= (uint64_t) p[i] << (8*i);
+	}
+
+	return value;
+}
+
+static bool compatible(bloom_filter_t* a, bloom_filter_t* b)
+{
+	return (a != NULL) && (b != NULL)
+		&& (a->n_bits == b->n_bits)
+		&& (a->n_hashes == b->n_hashes);
+}
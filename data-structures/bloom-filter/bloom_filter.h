@@ -55,10 +55,26 @@
 // the probability of receiving a false poisitive result from a test.
 //
 // This implementation uses the Murmur3 hash function to perform the
-// hashing within the filter. The Murmur3 library is already included
-// (as source) in this directory and will be linked to the driver
-// program so that your filter implementation can make use of it. See the
-// header file (murmur3.h) for more details on its use.
+// hashing within the filter. Rather than hash each item once for each
+// of the k hash functions, it computes a single 128-bit hash of the item
+// and derives all k bits from its two 64-bit halves by double hashing
+// (bit i is h1 + i*h2, modulo the size of the bit vector), which is
+// as effective as k independent hash functions while reading the item
+// only once. The Murmur3 library is already included (as source) in
+// this directory and will be linked to the driver program so that your
+// filter implementation can make use of it. See the header file
+// (murmur3.h) for more details on its use.
+//
+// The bit vector is stored in 64-bit words. A vector of FILTER_HUGE_BYTES
+// or more is mapped directly from the operating system rather than taken
+// from the heap, and (on Linux) marked as a candidate for huge pages, so
+// that a large filter is covered by far fewer TLB entries; clearing such
+// a filter hands its pages back to the system, which supplies zeroed
+// pages on the next touch, rather than writing every word. Set bits are
+// not counted as items are inserted, which would cost a test before each
+// set; filter_stats() counts them with a popcount of each word instead,
+// and estimates from that count the number of distinct items inserted
+// and the current false-positive rate.
 
 // The representation of bytes-like objects.
 typedef uint8_t byte_t;
@@ -82,8 +98,31 @@ typedef struct filter_stats
 
 	// The number of set bits in the filter.
 	size_t n_setbits;
+
+	// The estimated number of distinct items in the filter, from the
+	// fraction of bits set, or infinity if every bit is set.
+	double n_items_estimate;
+
+	// The expected false-positive rate of a test, given the bits set.
+	double fpr_estimate;
 } filter_stats_t;
 
+// Bit vectors of at least this many bytes are mapped rather than allocated.
+#define FILTER_HUGE_BYTES (2*1024*1024)
+
+// The ways in which the bit vector of a bloom filter is stored.
+typedef enum
+{
+	// allocated on the heap
+	STORAGE_HEAP,
+
+	// an anonymous mapping, for vectors of FILTER_HUGE_BYTES or more
+	STORAGE_ANONYMOUS,
+
+	// a private mapping of a filter file, by filter_map()
+	STORAGE_FILE
+} filter_storage_t;
+
 // The bloom filter data structure.
 typedef struct bloom_filter {
 	// The number of bits used in filter.
@@ -95,11 +134,17 @@ typedef struct bloom_filter {
 	// The number of items inserted into filter.
 	size_t n_items;
 
-	// The number of bits set in the filter
-	size_t n_setbits;
+	// The bloom filter bit vector, in 64-bit words; bit i is bit
+	// (i % 64) of word (i / 64), and any bits past n_bits are zero
+	uint64_t* bitvector;
+
+	// How the bit vector is stored.
+	filter_storage_t storage;
 
-	// The bloom filter bit vector
-	uint8_t* bitvector;
+	// The mapping that holds the bit vector, and its length,
+	// unless the vector is stored on the heap
+	void*  mapping;
+	size_t mapping_len;
 } bloom_filter_t;
 
 // filter_new()
@@ -115,6 +160,26 @@ typedef struct bloom_filter {
 //	NULL on failure (invalid arguments, allocation failure)
 bloom_filter_t* filter_new(const size_t n_bits, const size_t n_hashes);
 
+// filter_new_optimal()
+//
+// Construct a new bloom filter sized for an expected number of items
+// and a target false-positive rate.
+//
+// For n items and a false-positive rate p, the number of bits that
+// minimizes the false-positive rate is m = -n ln(p) / (ln 2)^2, and the
+// best number of hash functions for m bits is k = (m / n) ln 2, at
+// which about half of the bits are set once all n items are inserted.
+// At 1% this is about 9.6 bits per item and 7 hash functions.
+//
+// Arguments:
+//	n_items - the expected number of items
+//	fpr     - the target false-positive rate, in (0, 1)
+//
+// Returns:
+//	A pointer to a newly constructed bloom filter on success
+//	NULL on failure (invalid arguments, allocation failure)
+bloom_filter_t* filter_new_optimal(const size_t n_items, const double fpr);
+
 // filter_delete()
 //
 // Destroy an existing bloom filter.
@@ -148,6 +213,48 @@ void filter_insert(bloom_filter_t* filter, byte_t* data, size_t len);
 //	ERROR   on error 
 filter_test_t filter_test(bloom_filter_t* filter, byte_t* data, size_t len);
 
+// The number of 64-bit words in the result bitmap for a batch of n items.
+#define FILTER_BATCH_WORDS(n) (((n) + 63) / 64)
+
+// filter_insert_batch()
+//
+// Insert `n` items into the bloom filter.
+//
+// This is equivalent to calling filter_insert() for each item in turn,
+// but is faster for filters larger than the processor's caches: items
+// are hashed in small groups, and the bits of every item in a group
+// are prefetched before any is set, so that the cache misses for the
+// items of a group overlap rather than occurring one after another.
+// Items with NULL data or zero length are ignored.
+//
+// Arguments:
+//	filter - pointer to an existing bloom filter
+//	data   - pointers to the items to insert
+//	lens   - the length of each item (in bytes)
+//	n      - the number of items
+void filter_insert_batch(bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n);
+
+// filter_test_batch()
+//
+// Test for the presence of `n` items in an existing bloom filter.
+//
+// The results are written to a bitmap, in which bit (i % 64) of word
+// (i / 64) is set if item i is likely present, and cleared if it is
+// not present (or has NULL data or zero length). As for
+// filter_insert_batch(), items are hashed and prefetched in groups.
+//
+// Arguments:
+//	filter  - pointer to existing bloom filter
+//	data    - pointers to the items for which to test
+//	lens    - the length of each item (in bytes)
+//	n       - the number of items
+//	results - the result bitmap, of FILTER_BATCH_WORDS(n) words
+//
+// Returns:
+//	The number of items likely present in the filter
+//	0 on error (invalid arguments), in which case `results` is unchanged
+size_t filter_test_batch(bloom_filter_t* filter, byte_t* const data[], const size_t lens[], size_t n, uint64_t* results);
+
 // filter_clear()
 //
 // Clear all data from the filter.
@@ -160,6 +267,14 @@ void filter_clear(bloom_filter_t* filter);
 //
 // Return metadata about the current state of the filter.
 //
+// The set bits are counted afresh, so this takes time in proportion to
+// the size of the filter. With a fraction f of the m bits set, a test
+// for an absent item finds each of its k bits set with probability f,
+// so the expected false-positive rate is f^k; and the expected number
+// of distinct items to set that fraction is -(m / k) ln(1 - f)
+// (Swamidass and Baldi, 2007), which, unlike n_items, does not count
+// items inserted more than once.
+//
 // Arguments:
 //	filter - pointer to existing bloom filter
 //
@@ -167,4 +282,128 @@ void filter_clear(bloom_filter_t* filter);
 //	A structure populated with metadata regarding the filter state
 filter_stats_t filter_stats(bloom_filter_t* filter); 
 
+// Filter files:
+//
+// A filter is saved to a file as a 64-byte header followed by its bit
+// vector, as ceil(n_bits / 64) 64-bit words, in which bit i is bit
+// (i % 64) of word (i / 64). The header holds, at the given byte
+// offsets, with the words and all integers little-endian:
+//
+//	 0  magic      - the 8 bytes FILTER_FILE_MAGIC
+//	 8  version    - a 32-bit format version, FILTER_FILE_VERSION
+//	12  n_hashes   - 32 bits
+//	16  n_bits     - 64 bits
+//	24  seed       - 64 bits, the Murmur3 seed, FILTER_SEED
+//	32  n_items    - 64 bits
+//	40  n_setbits  - 64 bits, for information only
+//	48  reserved   - 16 bytes, zero
+//
+// The bit vector thus starts 64 bytes into the file, so a filter that
+// is mapped into memory has the same alignment as one allocated by
+// filter_new(). The version is incremented whenever the format, or the
+// way that items are hashed, changes; files of another version, or
+// built with another seed, are rejected rather than misread.
+
+#define FILTER_FILE_MAGIC       "BLOOMFLT"
+#define FILTER_FILE_VERSION     1
+#define FILTER_FILE_HEADER_SIZE 64
+
+// The greatest n_hashes of a filter file, so that a damaged or forged
+// header cannot make every test of the loaded filter take seconds.
+#define FILTER_FILE_MAX_HASHES  256
+
+// The seed of the Murmur3 hash from which the bits for an item are derived.
+#define FILTER_SEED 0
+
+// filter_save()
+//
+// Save an existing bloom filter to a file, which is created
+// if it does not exist and replaced if it does.
+//
+// Arguments:
+//	filter - pointer to existing bloom filter
+//	path   - the path of the file
+//
+// Returns:
+//	`true` on success
+//	`false` on failure (invalid arguments, more than
+//	FILTER_FILE_MAX_HASHES hashes, I/O error)
+bool filter_save(bloom_filter_t* filter, const char* path);
+
+// filter_load()
+//
+// Construct a new bloom filter from a file saved by filter_save(),
+// reading the bit vector into memory.
+//
+// Arguments:
+//	path - the path of the file
+//
+// Returns:
+//	A pointer to a newly constructed bloom filter on success
+//	NULL on failure (I/O error, invalid or incompatible file,
+//	allocation failure)
+bloom_filter_t* filter_load(const char* path);
+
+// filter_map()
+//
+// Construct a new bloom filter from a file saved by filter_save(),
+// mapping the bit vector from the file rather than reading it.
+//
+// Pages of the bit vector are read from the file as they are first
+// tested, so a large filter is available for testing at once, and the
+// pages of a filter mapped by several processes are shared between them.
+// The mapping is private: items inserted into the filter, and
+// filter_clear(), modify a copy of the pages they touch, never the file.
+// filter_delete() unmaps the file. Filters cannot be mapped on hosts
+// that are not little-endian.
+//
+// Arguments:
+//	path - the path of the file
+//
+// Returns:
+//	A pointer to a newly constructed bloom filter on success
+//	NULL on failure (I/O error, invalid or incompatible file,
+//	allocation failure)
+bloom_filter_t* filter_map(const char* path);
+
+// filter_union()
+//
+// Merge the items of one bloom filter into another, so that `dst`
+// reports present every item that either filter reported present.
+//
+// Both filters must have the same number of bits and hash functions,
+// as for shards of one filter built on different machines. The number
+// of items in `dst` becomes the sum of both, which counts any item
+// inserted into both filters twice.
+//
+// Arguments:
+//	dst - pointer to the filter into which to merge
+//	src - pointer to the filter to merge
+//
+// Returns:
+//	`true` on success
+//	`false` on failure (invalid arguments, incompatible filters)
+bool filter_union(bloom_filter_t* dst, bloom_filter_t* src);
+
+// filter_intersect()
+//
+// Intersect one bloom filter with another, so that `dst` reports
+// present only items that both filters reported present.
+//
+// Both filters must have the same number of bits and hash functions.
+// The result may report present an item that is in neither set, with
+// at most the false-positive rate of either filter alone. The number of
+// items in `dst` becomes the lesser of the two, an upper bound on the
+// size of the intersection; n_items_estimate from filter_stats() is
+// generally the better estimate of it.
+//
+// Arguments:
+//	dst - pointer to the filter to intersect
+//	src - pointer to the filter with which to intersect
+//
+// Returns:
+//	`true` on success
+//	`false` on failure (invalid arguments, incompatible filters)
+bool filter_intersect(bloom_filter_t* dst, bloom_filter_t* src);
+
 #endif // BLOOM_FILTER_H 
\ No newline at end of file
@@ -1,13 +1,27 @@
 // check.c
-// Driver program for stack data structure tests.
+// Driver program for bloom filter data structure tests.
 
 // attribute gnu_printf
 #pragma GCC diagnostic ignored "-Wignored-attributes"
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <check.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "bloom_filter.h"
+#include "blocked_bloom_filter.h"
+#include "scalable_bloom_filter.h"
+#include "counting_bloom_filter.h"
+#include "cuckoo_filter.h"
+#include "concurrent_bloom_filter.h"
+#include "murmur3.h"
 
 // ----------------------------------------------------------------------------
 // Test Cases
@@ -49,6 +63,843 @@ START_TEST(test_bloom_filter)
 }
 END_TEST
 
+START_TEST(test_bloom_filter_false_positives)
+{
+    // 10 bits per item with 7 hashes gives a false-positive rate near 0.8%
+    const uint64_t N_ITEMS = 10000;
+
+    bloom_filter_t* filter = filter_new(10*N_ITEMS, 7);
+    ck_assert_msg(filter != NULL, "filter_new() returned NULL");
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        filter_insert(filter, (byte_t*)&i, sizeof(i));
+    }
+
+    // no false negatives
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT,
+            "filter_test() returned a false negative");
+    }
+
+    size_t n_false_positives = 0;
+    for (uint64_t i = N_ITEMS; i < 11*N_ITEMS; ++i)
+    {
+        if (filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT)
+        {
+            n_false_positives++;
+        }
+    }
+
+    ck_assert_msg(n_false_positives < N_ITEMS / 5, "false-positive rate exceeds 2%%");
+
+    filter_stats_t stats = filter_stats(filter);
+    ck_assert(stats.n_items == N_ITEMS);
+    ck_assert(stats.n_setbits > 0 && stats.n_setbits <= 7*N_ITEMS);
+
+    // the estimates follow from the fraction of bits set
+    ck_assert(fabs(stats.n_items_estimate - (double) N_ITEMS) < 0.05*(double) N_ITEMS);
+    ck_assert(stats.fpr_estimate > 0.004 && stats.fpr_estimate < 0.016);
+
+    filter_clear(filter);
+    stats = filter_stats(filter);
+    ck_assert(stats.n_items_estimate == 0.0 && stats.fpr_estimate == 0.0);
+
+    filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_blocked_filter)
+{
+    const uint64_t N_ITEMS = 10000;
+
+    ck_assert_msg(NULL == blocked_filter_new(0), "blocked_filter_new() accepted zero bits");
+
+    // rounded up to a whole number of blocks
+    blocked_bloom_filter_t* filter = blocked_filter_new(10*N_ITEMS);
+    ck_assert_msg(filter != NULL, "blocked_filter_new() returned NULL");
+
+    filter_stats_t stats = blocked_filter_stats(filter);
+    ck_assert(stats.n_bits >= 10*N_ITEMS && stats.n_bits % BLOCK_BITS == 0);
+    ck_assert(stats.n_setbits == 0);
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        blocked_filter_insert(filter, (byte_t*)&i, sizeof(i));
+    }
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(blocked_filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT,
+            "blocked_filter_test() returned a false negative");
+    }
+
+    size_t n_false_positives = 0;
+    for (uint64_t i = N_ITEMS; i < 11*N_ITEMS; ++i)
+    {
+        if (blocked_filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT)
+        {
+            n_false_positives++;
+        }
+    }
+
+    ck_assert_msg(n_false_positives < N_ITEMS / 4, "false-positive rate exceeds 2.5%%");
+
+    // each insert sets at most one bit in each of the words of a block
+    stats = blocked_filter_stats(filter);
+    ck_assert(stats.n_items == N_ITEMS);
+    ck_assert(stats.n_setbits > 0 && stats.n_setbits <= BLOCK_HASHES*N_ITEMS);
+
+    // the estimated rate is within a factor of two of the measured rate
+    const double measured = (double) n_false_positives / (double) (10*N_ITEMS);
+    ck_assert(stats.fpr_estimate > measured / 2 && stats.fpr_estimate < measured*2);
+    ck_assert(fabs(stats.n_items_estimate - (double) N_ITEMS) < 0.1*(double) N_ITEMS);
+
+    ck_assert(blocked_filter_test(filter, NULL, 1) == ERROR);
+
+    blocked_filter_clear(filter);
+
+    stats = blocked_filter_stats(filter);
+    ck_assert(stats.n_items == 0 && stats.n_setbits == 0);
+    ck_assert(blocked_filter_test(filter, (byte_t*)"abc", 3) == ABSENT);
+
+    blocked_filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_filter_batch)
+{
+    // not a multiple of the bitmap word size, nor of any group size
+    enum { N_KEYS = 1000 };
+
+    static uint64_t keys[N_KEYS];
+    static byte_t*  data[N_KEYS];
+    static size_t   lens[N_KEYS];
+
+    for (size_t i = 0; i < N_KEYS; ++i)
+    {
+        keys[i] = i;
+        data[i] = (byte_t*)&keys[i];
+        lens[i] = sizeof(keys[i]);
+    }
+
+    bloom_filter_t* single  = filter_new(8*N_KEYS, 5);
+    bloom_filter_t* batched = filter_new(8*N_KEYS, 5);
+    blocked_bloom_filter_t* blocked_single  = blocked_filter_new(8*N_KEYS);
+    blocked_bloom_filter_t* blocked_batched = blocked_filter_new(8*N_KEYS);
+
+    ck_assert(single != NULL && batched != NULL);
+    ck_assert(blocked_single != NULL && blocked_batched != NULL);
+
+    // insert the even keys, singly and in a batch
+    for (size_t i = 0; i < N_KEYS; i += 2)
+    {
+        filter_insert(single, data[i], lens[i]);
+        blocked_filter_insert(blocked_single, data[i], lens[i]);
+    }
+
+    for (size_t i = 1; i < N_KEYS; i += 2)
+    {
+        lens[i] = 0;
+    }
+
+    filter_insert_batch(batched, data, lens, N_KEYS);
+    blocked_filter_insert_batch(blocked_batched, data, lens, N_KEYS);
+
+    ck_assert_msg(0 == memcmp(single->bitvector, batched->bitvector, ((8*N_KEYS + 63) / 64)*sizeof(uint64_t)),
+        "filter_insert_batch() set different bits");
+    ck_assert_msg(0 == memcmp(blocked_single->blocks, blocked_batched->blocks, blocked_single->n_blocks*BLOCK_BITS / 8),
+        "blocked_filter_insert_batch() set different bits");
+    ck_assert(filter_stats(batched).n_items == N_KEYS / 2);
+    ck_assert(filter_stats(batched).n_setbits == filter_stats(single).n_setbits);
+    ck_assert(blocked_filter_stats(blocked_batched).n_items == N_KEYS / 2);
+
+    // test every key, with one invalid item
+    for (size_t i = 0; i < N_KEYS; ++i)
+    {
+        lens[i] = sizeof(keys[i]);
+    }
+
+    data[7] = NULL;
+
+    uint64_t results[FILTER_BATCH_WORDS(N_KEYS)];
+    uint64_t blocked_results[FILTER_BATCH_WORDS(N_KEYS)];
+
+    const size_t n_present = filter_test_batch(batched, data, lens, N_KEYS, results);
+    const size_t n_blocked_present = blocked_filter_test_batch(blocked_batched, data, lens, N_KEYS, blocked_results);
+
+    size_t n_expected = 0;
+    size_t n_blocked_expected = 0;
+
+    for (size_t i = 0; i < N_KEYS; ++i)
+    {
+        const bool present = (results[i / 64] >> (i % 64)) & 1;
+        const bool blocked_present = (blocked_results[i / 64] >> (i % 64)) & 1;
+
+        if (NULL == data[i])
+        {
+            ck_assert_msg(!present && !blocked_present, "invalid item reported present");
+            continue;
+        }
+
+        ck_assert_msg(present == (filter_test(batched, data[i], lens[i]) == PRESENT),
+            "filter_test_batch() disagrees with filter_test()");
+        ck_assert_msg(blocked_present == (blocked_filter_test(blocked_batched, data[i], lens[i]) == PRESENT),
+            "blocked_filter_test_batch() disagrees with blocked_filter_test()");
+
+        n_expected += present;
+        n_blocked_expected += blocked_present;
+    }
+
+    ck_assert(n_present == n_expected && n_present >= N_KEYS / 2);
+    ck_assert(n_blocked_present == n_blocked_expected && n_blocked_present >= N_KEYS / 2);
+
+    ck_assert(0 == filter_test_batch(NULL, data, lens, N_KEYS, results));
+    ck_assert(0 == blocked_filter_test_batch(blocked_batched, data, NULL, N_KEYS, results));
+
+    filter_delete(single);
+    filter_delete(batched);
+    blocked_filter_delete(blocked_single);
+    blocked_filter_delete(blocked_batched);
+}
+END_TEST
+
+START_TEST(test_filter_new_optimal)
+{
+    const uint64_t N_ITEMS = 10000;
+
+    ck_assert(NULL == filter_new_optimal(0, 0.01));
+    ck_assert(NULL == filter_new_optimal(N_ITEMS, 0.0));
+    ck_assert(NULL == filter_new_optimal(N_ITEMS, 1.0));
+
+    // -n ln(p) / (ln 2)^2 bits, and (m / n) ln 2 hashes
+    bloom_filter_t* filter = filter_new_optimal(N_ITEMS, 0.01);
+    ck_assert_msg(filter != NULL, "filter_new_optimal() returned NULL");
+    ck_assert(filter->n_bits == 95851);
+    ck_assert(filter->n_hashes == 7);
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        filter_insert(filter, (byte_t*)&i, sizeof(i));
+    }
+
+    size_t n_false_positives = 0;
+    for (uint64_t i = N_ITEMS; i < 11*N_ITEMS; ++i)
+    {
+        if (filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT)
+        {
+            n_false_positives++;
+        }
+    }
+
+    ck_assert_msg(n_false_positives < N_ITEMS / 5, "false-positive rate exceeds 2%%");
+
+    filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_scalable_filter)
+{
+    // far more items than the first filter is sized for
+    const uint64_t N_ITEMS = 50000;
+
+    ck_assert(NULL == scalable_filter_new(0, 0.01));
+    ck_assert(NULL == scalable_filter_new(100, 1.5));
+
+    scalable_bloom_filter_t* filter = scalable_filter_new(100, 0.01);
+    ck_assert_msg(filter != NULL, "scalable_filter_new() returned NULL");
+    ck_assert(filter->n_filters == 1);
+
+    ck_assert(!scalable_filter_insert(filter, NULL, 8));
+    ck_assert(scalable_filter_test(filter, NULL, 8) == ERROR);
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert(scalable_filter_insert(filter, (byte_t*)&i, sizeof(i)));
+    }
+
+    // 100, 200, ... 25600 items, then 51200
+    ck_assert(filter->n_filters == 10);
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(scalable_filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT,
+            "scalable_filter_test() returned a false negative");
+    }
+
+    size_t n_false_positives = 0;
+    for (uint64_t i = N_ITEMS; i < 3*N_ITEMS; ++i)
+    {
+        if (scalable_filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT)
+        {
+            n_false_positives++;
+        }
+    }
+
+    ck_assert_msg(n_false_positives < N_ITEMS / 50, "false-positive rate exceeds 1%%");
+
+    filter_stats_t stats = scalable_filter_stats(filter);
+    ck_assert(stats.n_items == N_ITEMS);
+    ck_assert(stats.n_setbits <= stats.n_bits / 2 + stats.n_bits / 10);
+
+    scalable_filter_clear(filter);
+    ck_assert(filter->n_filters == 1);
+
+    stats = scalable_filter_stats(filter);
+    ck_assert(stats.n_items == 0);
+    ck_assert(stats.n_setbits == 0);
+
+    scalable_filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_counting_filter)
+{
+    const uint64_t N_ITEMS = 10000;
+
+    ck_assert(NULL == counting_filter_new(0, 3));
+    ck_assert(NULL == counting_filter_new_optimal(N_ITEMS, 0.0));
+
+    counting_bloom_filter_t* filter = counting_filter_new_optimal(N_ITEMS, 0.01);
+    ck_assert_msg(filter != NULL, "counting_filter_new_optimal() returned NULL");
+    ck_assert(filter->n_hashes == 7);
+
+    ck_assert(counting_filter_test(filter, NULL, 8) == ERROR);
+    ck_assert(!counting_filter_remove(filter, NULL, 8));
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        counting_filter_insert(filter, (byte_t*)&i, sizeof(i));
+    }
+
+    // remove the even items
+    for (uint64_t i = 0; i < N_ITEMS; i += 2)
+    {
+        ck_assert_msg(counting_filter_remove(filter, (byte_t*)&i, sizeof(i)),
+            "counting_filter_remove() failed for an inserted item");
+    }
+
+    // no false negatives for the odd items, and few
+    // of the even items are still reported present
+    size_t n_false_positives = 0;
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        const filter_test_t result = counting_filter_test(filter, (byte_t*)&i, sizeof(i));
+        if (i % 2)
+        {
+            ck_assert_msg(result == PRESENT, "counting_filter_test() returned a false negative");
+        }
+        else if (result == PRESENT)
+        {
+            n_false_positives++;
+        }
+    }
+
+    ck_assert_msg(n_false_positives < N_ITEMS / 100, "false-positive rate exceeds 2%%");
+
+    filter_stats_t stats = counting_filter_stats(filter);
+    ck_assert(stats.n_items == N_ITEMS / 2);
+
+    // a removed item that is absent leaves the filter unchanged
+    uint64_t absent = 0;
+    while (counting_filter_test(filter, (byte_t*)&absent, sizeof(absent)) == PRESENT)
+    {
+        absent += 2;
+    }
+
+    ck_assert(!counting_filter_remove(filter, (byte_t*)&absent, sizeof(absent)));
+    ck_assert(counting_filter_stats(filter).n_setbits == stats.n_setbits);
+
+    // every remaining item removed leaves every counter zero
+    for (uint64_t i = 1; i < N_ITEMS; i += 2)
+    {
+        ck_assert(counting_filter_remove(filter, (byte_t*)&i, sizeof(i)));
+    }
+
+    stats = counting_filter_stats(filter);
+    ck_assert(stats.n_items == 0);
+    ck_assert(stats.n_setbits == 0);
+
+    counting_filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_counting_filter_saturation)
+{
+    counting_bloom_filter_t* filter = counting_filter_new(64, 3);
+    ck_assert_msg(filter != NULL, "counting_filter_new() returned NULL");
+
+    // counters stick at their maximum, so the item is never removed
+    for (size_t i = 0; i < COUNTER_MAX + 5; ++i)
+    {
+        counting_filter_insert(filter, (byte_t*)"abc", 3);
+    }
+
+    for (size_t i = 0; i < COUNTER_MAX + 5; ++i)
+    {
+        ck_assert(counting_filter_remove(filter, (byte_t*)"abc", 3));
+    }
+
+    ck_assert(counting_filter_test(filter, (byte_t*)"abc", 3) == PRESENT);
+
+    counting_filter_clear(filter);
+    ck_assert(counting_filter_test(filter, (byte_t*)"abc", 3) == ABSENT);
+    ck_assert(counting_filter_stats(filter).n_setbits == 0);
+
+    counting_filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_cuckoo_filter)
+{
+    const uint64_t N_ITEMS = 10000;
+
+    ck_assert(NULL == cuckoo_filter_new(0, 8));
+    ck_assert(NULL == cuckoo_filter_new(16, 0));
+    ck_assert(NULL == cuckoo_filter_new(16, CUCKOO_MAX_FINGERPRINT_BITS + 1));
+    ck_assert(NULL == cuckoo_filter_new_optimal(N_ITEMS, 1.0));
+
+    // 2 * 4 / 2^f < 1% requires 10-bit fingerprints
+    cuckoo_filter_t* filter = cuckoo_filter_new_optimal(N_ITEMS, 0.01);
+    ck_assert_msg(filter != NULL, "cuckoo_filter_new_optimal() returned NULL");
+    ck_assert(filter->fingerprint_bits == 10);
+    ck_assert(filter->n_buckets == 4096);
+
+    ck_assert(!cuckoo_filter_insert(filter, NULL, 8));
+    ck_assert(cuckoo_filter_test(filter, NULL, 8) == ERROR);
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        ck_assert_msg(cuckoo_filter_insert(filter, (byte_t*)&i, sizeof(i)),
+            "cuckoo_filter_insert() failed below capacity");
+    }
+
+    for (uint64_t i = 0; i < N_ITEMS; i += 2)
+    {
+        ck_assert_msg(cuckoo_filter_remove(filter, (byte_t*)&i, sizeof(i)),
+            "cuckoo_filter_remove() failed for an inserted item");
+    }
+
+    size_t n_false_positives = 0;
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        const filter_test_t result = cuckoo_filter_test(filter, (byte_t*)&i, sizeof(i));
+        if (i % 2)
+        {
+            ck_assert_msg(result == PRESENT, "cuckoo_filter_test() returned a false negative");
+        }
+        else if (result == PRESENT)
+        {
+            n_false_positives++;
+        }
+    }
+
+    ck_assert_msg(n_false_positives < N_ITEMS / 100, "false-positive rate exceeds 2%%");
+
+    filter_stats_t stats = cuckoo_filter_stats(filter);
+    ck_assert(stats.n_items == N_ITEMS / 2);
+    ck_assert(stats.n_setbits == (N_ITEMS / 2)*10);
+    ck_assert(stats.n_items_estimate == (double) (N_ITEMS / 2));
+
+    cuckoo_filter_clear(filter);
+    stats = cuckoo_filter_stats(filter);
+    ck_assert(stats.n_items == 0);
+    ck_assert(stats.n_setbits == 0);
+
+    cuckoo_filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_cuckoo_filter_full)
+{
+    // 64 buckets of 4 entries
+    cuckoo_filter_t* filter = cuckoo_filter_new(64, 16);
+    ck_assert_msg(filter != NULL, "cuckoo_filter_new() returned NULL");
+
+    uint64_t n_inserted = 0;
+    while (cuckoo_filter_insert(filter, (byte_t*)&n_inserted, sizeof(n_inserted)))
+    {
+        n_inserted++;
+    }
+
+    // the table fills almost completely before an insert fails
+    ck_assert(n_inserted > 200 && n_inserted <= 64*CUCKOO_BUCKET_SIZE + 1);
+    ck_assert(filter->has_victim);
+
+    // no item is lost when the table fills
+    for (uint64_t i = 0; i < n_inserted; ++i)
+    {
+        ck_assert_msg(cuckoo_filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT,
+            "cuckoo_filter_test() returned a false negative");
+    }
+
+    // the victim is placed again once an entry is removed
+    uint64_t first = 0;
+    ck_assert(cuckoo_filter_remove(filter, (byte_t*)&first, sizeof(first)));
+
+    for (uint64_t i = 1; i < n_inserted; ++i)
+    {
+        ck_assert_msg(cuckoo_filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT,
+            "cuckoo_filter_test() returned a false negative");
+    }
+
+    ck_assert(cuckoo_filter_stats(filter).n_items == n_inserted - 1);
+
+    cuckoo_filter_delete(filter);
+}
+END_TEST
+
+#define N_WRITERS         4
+#define ITEMS_PER_WRITER  20000
+#define N_PREFILLED       1000
+
+typedef struct writer_args
+{
+    concurrent_bloom_filter_t* filter;
+    uint64_t                   first;
+} writer_args_t;
+
+static void* concurrent_writer(void* arg)
+{
+    writer_args_t* args = (writer_args_t*) arg;
+
+    for (uint64_t i = args->first; i < args->first + ITEMS_PER_WRITER; ++i)
+    {
+        concurrent_filter_insert(args->filter, (byte_t*)&i, sizeof(i));
+    }
+
+    return NULL;
+}
+
+// Repeatedly test for the items inserted before the writers started,
+// returning the number of false negatives.
+static void* concurrent_reader(void* arg)
+{
+    concurrent_bloom_filter_t* filter = (concurrent_bloom_filter_t*) arg;
+
+    uintptr_t n_false_negatives = 0;
+    for (size_t round = 0; round < 20; ++round)
+    {
+        for (uint64_t i = 0; i < N_PREFILLED; ++i)
+        {
+            const uint64_t key = ((uint64_t) 1 << 40) + i;
+            n_false_negatives += (concurrent_filter_test(filter, (byte_t*)&key, sizeof(key)) != PRESENT);
+        }
+    }
+
+    return (void*) n_false_negatives;
+}
+
+START_TEST(test_concurrent_filter)
+{
+    const size_t N_BITS = 10*N_WRITERS*ITEMS_PER_WRITER;
+
+    ck_assert(NULL == concurrent_filter_new(0, 7));
+
+    concurrent_bloom_filter_t* filter = concurrent_filter_new(N_BITS, 7);
+    ck_assert_msg(filter != NULL, "concurrent_filter_new() returned NULL");
+
+    bloom_filter_t* expected = filter_new(N_BITS, 7);
+    ck_assert(expected != NULL);
+
+    for (uint64_t i = 0; i < N_PREFILLED; ++i)
+    {
+        const uint64_t key = ((uint64_t) 1 << 40) + i;
+        concurrent_filter_insert(filter, (byte_t*)&key, sizeof(key));
+        filter_insert(expected, (byte_t*)&key, sizeof(key));
+    }
+
+    pthread_t     writers[N_WRITERS];
+    writer_args_t args[N_WRITERS];
+    pthread_t     reader;
+
+    ck_assert(0 == pthread_create(&reader, NULL, concurrent_reader, filter));
+    for (size_t i = 0; i < N_WRITERS; ++i)
+    {
+        args[i] = (writer_args_t) { .filter = filter, .first = i*ITEMS_PER_WRITER };
+        ck_assert(0 == pthread_create(&writers[i], NULL, concurrent_writer, &args[i]));
+    }
+
+    for (size_t i = 0; i < N_WRITERS; ++i)
+    {
+        pthread_join(writers[i], NULL);
+    }
+
+    void* n_false_negatives;
+    pthread_join(reader, &n_false_negatives);
+    ck_assert_msg(0 == (uintptr_t) n_false_negatives,
+        "concurrent_filter_test() returned a false negative during inserts");
+
+    for (uint64_t i = 0; i < N_WRITERS*ITEMS_PER_WRITER; ++i)
+    {
+        ck_assert_msg(concurrent_filter_test(filter, (byte_t*)&i, sizeof(i)) == PRESENT,
+            "concurrent_filter_test() returned a false negative");
+        filter_insert(expected, (byte_t*)&i, sizeof(i));
+    }
+
+    // the concurrent inserts set exactly the bits of the same inserts made serially
+    for (size_t bit = 0; bit < N_BITS; ++bit)
+    {
+        const bool set = (atomic_load(&filter->words[bit / 64]) >> (bit % 64)) & 1;
+        ck_assert(set == ((expected->bitvector[bit / 64] >> (bit % 64)) & 1));
+    }
+
+    filter_stats_t stats = concurrent_filter_stats(filter);
+    ck_assert(stats.n_items == N_PREFILLED + N_WRITERS*ITEMS_PER_WRITER);
+    ck_assert(stats.n_bits == N_BITS);
+    ck_assert(stats.n_setbits == filter_stats(expected).n_setbits);
+
+    concurrent_filter_clear(filter);
+    stats = concurrent_filter_stats(filter);
+    ck_assert(stats.n_items == 0);
+    ck_assert(stats.n_setbits == 0);
+
+    uint64_t first = 0;
+    ck_assert(concurrent_filter_test(filter, (byte_t*)&first, sizeof(first)) == ABSENT);
+
+    filter_delete(expected);
+    concurrent_filter_delete(filter);
+}
+END_TEST
+
+// Create an empty temporary file, writing its path to `path`.
+static void make_temp_file(char path[32])
+{
+    strcpy(path, "/tmp/bloom-filter-XXXXXX");
+
+    const int fd = mkstemp(path);
+    ck_assert_msg(fd >= 0, "mkstemp() failed");
+    close(fd);
+}
+
+START_TEST(test_filter_save_load)
+{
+    const uint64_t N_ITEMS = 1000;
+
+    char path[32];
+    make_temp_file(path);
+
+    // an odd number of bits, so that the vector ends with a partial byte
+    bloom_filter_t* filter = filter_new(10*N_ITEMS + 3, 7);
+    ck_assert_msg(filter != NULL, "filter_new() returned NULL");
+
+    for (uint64_t i = 0; i < N_ITEMS; ++i)
+    {
+        filter_insert(filter, (byte_t*)&i, sizeof(i));
+    }
+
+    ck_assert(!filter_save(NULL, path));
+    ck_assert(filter_save(filter, path));
+
+    bloom_filter_t* loaded = filter_load(path);
+    bloom_filter_t* mapped = filter_map(path);
+    ck_assert_msg(loaded != NULL, "filter_load() returned NULL");
+    ck_assert_msg(mapped != NULL, "filter_map() returned NULL");
+
+    bloom_filter_t* copies[] = { loaded, mapped };
+    for (size_t c = 0; c < 2; ++c)
+    {
+        ck_assert(copies[c]->n_bits == filter->n_bits);
+        ck_assert(copies[c]->n_hashes == filter->n_hashes);
+        ck_assert(0 == memcmp(copies[c]->bitvector, filter->bitvector, ((filter->n_bits + 63) / 64)*sizeof(uint64_t)));
+
+        filter_stats_t stats = filter_stats(copies[c]);
+        ck_assert(stats.n_items == N_ITEMS);
+        ck_assert(stats.n_setbits == filter_stats(filter).n_setbits);
+
+        for (uint64_t i = 0; i < N_ITEMS; ++i)
+        {
+            ck_assert(filter_test(copies[c], (byte_t*)&i, sizeof(i)) == PRESENT);
+        }
+    }
+
+    // changes to a mapped filter never reach the file
+    filter_clear(mapped);
+    ck_assert(filter_stats(mapped).n_setbits == 0);
+    filter_delete(mapped);
+
+    mapped = filter_map(path);
+    ck_assert(mapped != NULL);
+    ck_assert(filter_stats(mapped).n_setbits == filter_stats(filter).n_setbits);
+
+    filter_delete(mapped);
+    filter_delete(loaded);
+
+    // a truncated file, or one with a bad header, is rejected
+    FILE* file = fopen(path, "r+b");
+    ck_assert(file != NULL);
+    ck_assert(0 == ftruncate(fileno(file), FILTER_FILE_HEADER_SIZE + 10));
+    fclose(file);
+
+    ck_assert(NULL == filter_load(path));
+    ck_assert(NULL == filter_map(path));
+
+    ck_assert(filter_save(filter, path));
+    file = fopen(path, "r+b");
+    ck_assert(file != NULL);
+    fputc('X', file);
+    fclose(file);
+
+    ck_assert(NULL == filter_load(path));
+    ck_assert(NULL == filter_map(path));
+
+    // as is one with a bit set past n_bits, in the top byte of the last word
+    ck_assert(filter_save(filter, path));
+    file = fopen(path, "r+b");
+    ck_assert(file != NULL);
+    ck_assert(0 == fseek(file, FILTER_FILE_HEADER_SIZE + (long) (filter->n_bits / 64)*8 + 7, SEEK_SET));
+    fputc(0x80, file);
+    fclose(file);
+
+    ck_assert(NULL == filter_load(path));
+    ck_assert(NULL == filter_map(path));
+
+    // as is one whose header claims too many hashes (1000)
+    ck_assert(filter_save(filter, path));
+    file = fopen(path, "r+b");
+    ck_assert(file != NULL);
+    ck_assert(0 == fseek(file, 12, SEEK_SET));
+    fputc(0xE8, file);
+    fputc(0x03, file);
+    fclose(file);
+
+    ck_assert(NULL == filter_load(path));
+    ck_assert(NULL == filter_map(path));
+
+    // or a vector of 2^40 bits (128GB) that the file does not hold
+    file = fopen(path, "r+b");
+    ck_assert(file != NULL);
+    ck_assert(0 == ftruncate(fileno(file), FILTER_FILE_HEADER_SIZE));
+    ck_assert(0 == fseek(file, 12, SEEK_SET));
+    fputc(7, file);
+    fputc(0, file);
+    ck_assert(0 == fseek(file, 16, SEEK_SET));
+    for (size_t i = 0; i < 8; ++i)
+    {
+        fputc((5 == i) ? 1 : 0, file);
+    }
+    fclose(file);
+
+    ck_assert(NULL == filter_load(path));
+    ck_assert(NULL == filter_map(path));
+
+    // and such a file is never written
+    bloom_filter_t* many = filter_new(1024, FILTER_FILE_MAX_HASHES + 1);
+    ck_assert(many != NULL);
+    ck_assert(!filter_save(many, path));
+    filter_delete(many);
+
+    ck_assert(0 == unlink(path));
+    ck_assert(NULL == filter_load(path));
+    ck_assert(NULL == filter_map(path));
+
+    filter_delete(filter);
+}
+END_TEST
+
+START_TEST(test_filter_union_intersect)
+{
+    const uint64_t N_ITEMS = 1000;
+
+    // two shards, and the filter of all of their items
+    bloom_filter_t* a   = filter_new(20*N_ITEMS, 7);
+    bloom_filter_t* b   = filter_new(20*N_ITEMS, 7);
+    bloom_filter_t* all = filter_new(20*N_ITEMS, 7);
+    ck_assert(a != NULL && b != NULL && all != NULL);
+
+    // a holds [0, 2N), b holds [N, 3N)
+    for (uint64_t i = 0; i < 3*N_ITEMS; ++i)
+    {
+        if (i < 2*N_ITEMS)
+        {
+            filter_insert(a, (byte_t*)&i, sizeof(i));
+        }
+
+        if (i >= N_ITEMS)
+        {
+            filter_insert(b, (byte_t*)&i, sizeof(i));
+        }
+
+        filter_insert(all, (byte_t*)&i, sizeof(i));
+    }
+
+    bloom_filter_t* other = filter_new(20*N_ITEMS, 6);
+    ck_assert(!filter_union(a, other));
+    ck_assert(!filter_intersect(a, other));
+    ck_assert(!filter_union(a, NULL));
+    filter_delete(other);
+
+    bloom_filter_t* both = filter_new(20*N_ITEMS, 7);
+    ck_assert(filter_union(both, a));
+    ck_assert(filter_intersect(both, b));
+    ck_assert(filter_stats(both).n_items == 2*N_ITEMS);
+
+    // the union is exactly the filter of all the items
+    ck_assert(filter_union(a, b));
+    ck_assert(0 == memcmp(a->bitvector, all->bitvector, ((all->n_bits + 63) / 64)*sizeof(uint64_t)));
+    ck_assert(filter_stats(a).n_setbits == filter_stats(all).n_setbits);
+    ck_assert(filter_stats(a).n_items == 4*N_ITEMS);
+
+    // the intersection reports every common item present, and few others
+    size_t n_false_positives = 0;
+    for (uint64_t i = 0; i < 3*N_ITEMS; ++i)
+    {
+        const filter_test_t result = filter_test(both, (byte_t*)&i, sizeof(i));
+        if (i >= N_ITEMS && i < 2*N_ITEMS)
+        {
+            ck_assert(result == PRESENT);
+        }
+        else if (result == PRESENT)
+        {
+            n_false_positives++;
+        }
+    }
+
+    ck_assert(n_false_positives < N_ITEMS / 20);
+
+    filter_delete(a);
+    filter_delete(b);
+    filter_delete(all);
+    filter_delete(both);
+}
+END_TEST
+
+START_TEST(test_murmur3_batch)
+{
+    // more keys than fill a whole number of vectors
+    const int N_KEYS  = 37;
+    const int MAX_LEN = 40;
+
+    uint8_t     buffer[N_KEYS*MAX_LEN + 1];
+    const void* keys[N_KEYS];
+    uint32_t    batched[N_KEYS];
+
+    for (size_t i = 0; i < sizeof(buffer); ++i)
+    {
+        buffer[i] = (uint8_t) (i*131 + 7);
+    }
+
+    // every tail length, with keys that are not aligned
+    for (int len = 0; len <= MAX_LEN; ++len)
+    {
+        for (int i = 0; i < N_KEYS; ++i)
+        {
+            keys[i] = buffer + 1 + i*len;
+        }
+
+        MurmurHash3_x86_32_batch(keys, len, 42, batched, N_KEYS);
+
+        for (int i = 0; i < N_KEYS; ++i)
+        {
+            uint32_t expected;
+            MurmurHash3_x86_32(keys[i], len, 42, &expected);
+            ck_assert_msg(batched[i] == expected, "MurmurHash3_x86_32_batch() returned a different digest");
+        }
+    }
+}
+END_TEST
+
 // ----------------------------------------------------------------------------
 // Infrastructure
  
@@ -58,6 +909,19 @@ Suite* bloom_filter_suite(void)
     TCase* tc_core = tcase_create("bloom-filter-core");
     
     tcase_add_test(tc_core, test_bloom_filter);
+    tcase_add_test(tc_core, test_bloom_filter_false_positives);
+    tcase_add_test(tc_core, test_blocked_filter);
+    tcase_add_test(tc_core, test_filter_batch);
+    tcase_add_test(tc_core, test_filter_new_optimal);
+    tcase_add_test(tc_core, test_scalable_filter);
+    tcase_add_test(tc_core, test_counting_filter);
+    tcase_add_test(tc_core, test_counting_filter_saturation);
+    tcase_add_test(tc_core, test_cuckoo_filter);
+    tcase_add_test(tc_core, test_cuckoo_filter_full);
+    tcase_add_test(tc_core, test_concurrent_filter);
+    tcase_add_test(tc_core, test_filter_save_load);
+    tcase_add_test(tc_core, test_filter_union_intersect);
+    tcase_add_test(tc_core, test_murmur3_batch);
     
     suite_add_tcase(s, tc_core);
     
@@ -0,0 +1,193 @@
+// concurrent_bloom_filter.c
+// A bloom filter that may be inserted into and tested from many threads.
+
+#include <stdlib.h>
+
+#include "concurrent_bloom_filter.h"
+#include "filter_internal.h"
+
+#define CACHE_LINE_SIZE 64
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+// The stripe assigned to the calling thread, or CONCURRENT_STRIPES if none.
+static _Thread_local size_t stripe = CONCURRENT_STRIPES;
+
+// The number of threads assigned a stripe so far.
+static _Atomic(size_t) n_threads = 0;
+
+static size_t n_words(size_t n_bits);
+static concurrent_stripe_t* my_stripe(concurrent_bloom_filter_t* filter);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+concurrent_bloom_filter_t* concurrent_filter_new(const size_t n_bits, const size_t n_hashes)
+{
+    if (0 == n_bits || 0 == n_hashes)
+    {
+        return NULL;
+    }
+
+    concurrent_bloom_filter_t* filter = aligned_alloc(CACHE_LINE_SIZE, sizeof(concurrent_bloom_filter_t));
+    if (NULL == filter)
+    {
+        return NULL;
+    }
+
+    // round up to a whole number of cache lines, as aligned_alloc() requires
+    const size_t bytes = n_words(n_bits)*sizeof(uint64_t);
+    filter->words = aligned_alloc(CACHE_LINE_SIZE, bytes + (CACHE_LINE_SIZE - bytes % CACHE_LINE_SIZE) % CACHE_LINE_SIZE);
+    if (NULL == filter->words)
+    {
+        free(filter);
+        return NULL;
+    }
+
+    filter->n_bits   = n_bits;
+    filter->n_hashes = n_hashes;
+
+    for (size_t i = 0; i < n_words(n_bits); ++i)
+    {
+        atomic_init(&filter->words[i], 0);
+    }
+
+    for (size_t i = 0; i < CONCURRENT_STRIPES; ++i)
+    {
+        atomic_init(&filter->stripes[i].n_items, 0);
+        atomic_init(&filter->stripes[i].n_setbits, 0);
+    }
+
+    return filter;
+}
+
+void concurrent_filter_delete(concurrent_bloom_filter_t* filter)
+{
+    if (filter != NULL)
+    {
+        free(filter->words);
+        free(filter);
+    }
+}
+
+void concurrent_filter_insert(concurrent_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return;
+    }
+
+    probe_t probe = first_probe(data, len, filter->n_bits);
+    size_t  n_set = 0;
+
+    for (size_t i = 0; i < filter->n_hashes; ++i)
+    {
+        _Atomic(uint64_t)* word = &filter->words[probe.position / 64];
+        const uint64_t     mask = 1ULL << (probe.position % 64);
+
+        // only the thread whose fetch-or sets the bit counts it
+        if (!(atomic_load_explicit(word, memory_order_relaxed) & mask)
+         && !(atomic_fetch_or_explicit(word, mask, memory_order_relaxed) & mask))
+        {
+            n_set++;
+        }
+
+        next_probe(&probe, filter->n_bits);
+    }
+
+    concurrent_stripe_t* s = my_stripe(filter);
+    atomic_fetch_add_explicit(&s->n_items, 1, memory_order_relaxed);
+    if (n_set > 0)
+    {
+        atomic_fetch_add_explicit(&s->n_setbits, n_set, memory_order_relaxed);
+    }
+}
+
+filter_test_t concurrent_filter_test(concurrent_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return ERROR;
+    }
+
+    probe_t probe = first_probe(data, len, filter->n_bits);
+
+    for (size_t i = 0; i < filter->n_hashes; ++i)
+    {
+        const uint64_t word = atomic_load_explicit(&filter->words[probe.position / 64], memory_order_relaxed);
+        if (!(word & (1ULL << (probe.position % 64))))
+        {
+            return ABSENT;
+        }
+
+        next_probe(&probe, filter->n_bits);
+    }
+
+    return PRESENT;
+}
+
+void concurrent_filter_clear(concurrent_bloom_filter_t* filter)
+{
+    if (NULL == filter)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < n_words(filter->n_bits); ++i)
+    {
+        atomic_store_explicit(&filter->words[i], 0, memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < CONCURRENT_STRIPES; ++i)
+    {
+        atomic_store_explicit(&filter->stripes[i].n_items, 0, memory_order_relaxed);
+        atomic_store_explicit(&filter->stripes[i].n_setbits, 0, memory_order_relaxed);
+    }
+}
+
+filter_stats_t concurrent_filter_stats(concurrent_bloom_filter_t* filter)
+{
+    filter_stats_t stats = {
+        .n_items          = 0,
+        .n_bits           = 0,
+        .n_setbits        = 0,
+        .n_items_estimate = 0.0,
+        .fpr_estimate     = 0.0
+    };
+
+    if (filter != NULL)
+    {
+        stats.n_bits = filter->n_bits;
+
+        for (size_t i = 0; i < CONCURRENT_STRIPES; ++i)
+        {
+            stats.n_items   += atomic_load_explicit(&filter->stripes[i].n_items, memory_order_relaxed);
+            stats.n_setbits += atomic_load_explicit(&filter->stripes[i].n_setbits, memory_order_relaxed);
+        }
+
+        // as for filter_stats(); the count of set bits is kept, not counted
+        estimate_fill(&stats, filter->n_hashes);
+    }
+
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static size_t n_words(size_t n_bits)
+{
+    return n_bits / 64 + (n_bits % 64 != 0);
+}
+
+static concurrent_stripe_t* my_stripe(concurrent_bloom_filter_t* filter)
+{
+    // threads take stripes in turn, on their first insert into any filter
+    if (CONCURRENT_STRIPES == stripe)
+    {
+        stripe = atomic_fetch_add_explicit(&n_threads, 1, memory_order_relaxed) % CONCURRENT_STRIPES;
+    }
+
+    return &filter->stripes[stripe];
+}
@@ -0,0 +1,145 @@
+// concurrent_bloom_filter.h
+// A bloom filter that may be inserted into and tested from many threads.
+
+#ifndef CONCURRENT_BLOOM_FILTER_H
+#define CONCURRENT_BLOOM_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "bloom_filter.h"
+
+// Background:
+//
+// The standard bloom filter (bloom_filter.h) sets a bit by reading a
+// byte, setting the bit and writing the byte back, and counts items and
+// set bits in plain fields. Two threads inserting at once may each write
+// back a byte without the other's bit, losing it, and the counts are
+// updated without synchronization at all.
+//
+// This filter stores its bits in 64-bit atomic words and sets each with
+// an atomic fetch-or, which cannot lose a concurrent update to the same
+// word. A bit that is already set is not written, so that inserts of
+// common items do not take the cache lines of a filter in exclusive mode
+// from the threads that read them. Tests are plain atomic loads, and
+// neither inserts nor tests take locks.
+//
+// The bits set by an insert are guaranteed to be visible to a test that
+// happens after it (for instance, after a thread join, or the release and
+// acquire of a lock); a test concurrent with the insert of the same item
+// may report it either present or absent.
+//
+// A shared counter of items would be written by every insert, from every
+// thread, and so would become the filter's bottleneck. Instead, the
+// counts of items and set bits are kept in CONCURRENT_STRIPES stripes,
+// each on its own cache line; each thread updates one stripe, and
+// concurrent_filter_stats() sums them. Statistics taken while inserts
+// are in progress are a snapshot of some recent state.
+//
+// The filter hashes items exactly as the standard filter does, with the
+// functions of filter_internal.h, so a standard and a concurrent filter
+// of the same size set the same bits.
+
+// The number of stripes of counters.
+#define CONCURRENT_STRIPES 64
+
+// One stripe of the counters, alone on its cache line.
+typedef struct concurrent_stripe
+{
+    _Alignas(64) _Atomic(size_t) n_items;
+    _Atomic(size_t) n_setbits;
+} concurrent_stripe_t;
+
+// The concurrent bloom filter data structure.
+typedef struct concurrent_bloom_filter
+{
+    // The number of bits in the filter.
+    size_t n_bits;
+
+    // The number of hash functions used to implement the filter.
+    size_t n_hashes;
+
+    // The bit vector, in 64-bit words; bit i is bit (i % 64) of word (i / 64).
+    _Atomic(uint64_t)* words;
+
+    // The counts of items inserted and bits set, by stripe.
+    concurrent_stripe_t stripes[CONCURRENT_STRIPES];
+} concurrent_bloom_filter_t;
+
+// concurrent_filter_new()
+//
+// Construct a new concurrent bloom filter data structure.
+//
+// Arguments:
+//  n_bits   - the number of bits in the filter
+//  n_hashes - the number of hash functions to use in filter operations
+//
+// Returns:
+//  A pointer to a newly constructed filter on success
+//  NULL on failure (invalid arguments, allocation failure)
+concurrent_bloom_filter_t* concurrent_filter_new(const size_t n_bits, const size_t n_hashes);
+
+// concurrent_filter_delete()
+//
+// Destroy an existing concurrent bloom filter.
+//
+// No other thread may be accessing the filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void concurrent_filter_delete(concurrent_bloom_filter_t* filter);
+
+// concurrent_filter_insert()
+//
+// Insert new data into the filter. May be called from
+// any number of threads concurrently.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - arbitrary user data to insert
+//  len    - the length of the user data (in bytes)
+void concurrent_filter_insert(concurrent_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// concurrent_filter_test()
+//
+// Test for the presence of `data` in an existing filter. May be
+// called from any number of threads concurrently, and concurrently
+// with concurrent_filter_insert().
+//
+// Arguments:
+//  filter - pointer to existing filter
+//  data   - arbitrary user data for which to test
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  ABSENT  if the data is not present in the filter
+//  PRESENT if the data is likely present in the filter
+//  ERROR   on error
+filter_test_t concurrent_filter_test(concurrent_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// concurrent_filter_clear()
+//
+// Clear all data from the filter.
+//
+// No other thread may be inserting into the filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void concurrent_filter_clear(concurrent_bloom_filter_t* filter);
+
+// concurrent_filter_stats()
+//
+// Return metadata about the current state of the filter, merged
+// from the counters of every stripe. May be called concurrently
+// with concurrent_filter_insert().
+//
+// Arguments:
+//  filter - pointer to existing filter
+//
+// Returns:
+//  A structure populated with metadata regarding the filter state
+filter_stats_t concurrent_filter_stats(concurrent_bloom_filter_t* filter);
+
+#endif // CONCURRENT_BLOOM_FILTER_H
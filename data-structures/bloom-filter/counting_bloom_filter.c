@@ -0,0 +1,206 @@
+// counting_bloom_filter.c
+// A bloom filter that supports removal, with a 4-bit counter per bit.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "counting_bloom_filter.h"
+#include "filter_internal.h"
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+static unsigned get_counter(counting_bloom_filter_t* filter, size_t counter);
+static void set_counter(counting_bloom_filter_t* filter, size_t counter, unsigned value);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+counting_bloom_filter_t* counting_filter_new(const size_t n_counters, const size_t n_hashes)
+{
+    if (0 == n_counters || 0 == n_hashes)
+    {
+        return NULL;
+    }
+
+    counting_bloom_filter_t* filter = malloc(sizeof(counting_bloom_filter_t));
+    if (NULL == filter)
+    {
+        return NULL;
+    }
+
+    filter->counters = calloc(n_counters / 2 + n_counters % 2, sizeof(uint8_t));
+    if (NULL == filter->counters)
+    {
+        free(filter);
+        return NULL;
+    }
+
+    filter->n_counters = n_counters;
+    filter->n_hashes   = n_hashes;
+    filter->n_items    = 0;
+
+    return filter;
+}
+
+counting_bloom_filter_t* counting_filter_new_optimal(const size_t n_items, const double fpr)
+{
+    if (0 == n_items || !(fpr > 0.0 && fpr < 1.0))
+    {
+        return NULL;
+    }
+
+    const double ln2        = log(2.0);
+    const double n_counters = ceil(-(double) n_items*log(fpr) / (ln2*ln2));
+
+    // the counters must be addressable in bytes
+    if (n_counters > (double) (SIZE_MAX / 2))
+    {
+        return NULL;
+    }
+
+    const double n_hashes = round(n_counters / (double) n_items*ln2);
+
+    return counting_filter_new((size_t) n_counters, (n_hashes < 1.0) ? 1 : (size_t) n_hashes);
+}
+
+void counting_filter_delete(counting_bloom_filter_t* filter)
+{
+    if (filter != NULL)
+    {
+        free(filter->counters);
+        free(filter);
+    }
+}
+
+void counting_filter_insert(counting_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return;
+    }
+
+    probe_t probe = first_probe(data, len, filter->n_counters);
+
+    for (size_t i = 0; i < filter->n_hashes; ++i)
+    {
+        // a counter at its maximum sticks there
+        const unsigned value = get_counter(filter, probe.position);
+        if (value < COUNTER_MAX)
+        {
+            set_counter(filter, probe.position, value + 1);
+        }
+
+        next_probe(&probe, filter->n_counters);
+    }
+
+    filter->n_items++;
+}
+
+bool counting_filter_remove(counting_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (PRESENT != counting_filter_test(filter, data, len))
+    {
+        return false;
+    }
+
+    probe_t probe = first_probe(data, len, filter->n_counters);
+
+    for (size_t i = 0; i < filter->n_hashes; ++i)
+    {
+        // a probe may visit a counter more than once, so
+        // it may reach zero before the last visit
+        const unsigned value = get_counter(filter, probe.position);
+        if (value > 0 && value < COUNTER_MAX)
+        {
+            set_counter(filter, probe.position, value - 1);
+        }
+
+        next_probe(&probe, filter->n_counters);
+    }
+
+    if (filter->n_items > 0)
+    {
+        filter->n_items--;
+    }
+
+    return true;
+}
+
+filter_test_t counting_filter_test(counting_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return ERROR;
+    }
+
+    probe_t probe = first_probe(data, len, filter->n_counters);
+
+    for (size_t i = 0; i < filter->n_hashes; ++i)
+    {
+        if (0 == get_counter(filter, probe.position))
+        {
+            return ABSENT;
+        }
+
+        next_probe(&probe, filter->n_counters);
+    }
+
+    return PRESENT;
+}
+
+void counting_filter_clear(counting_bloom_filter_t* filter)
+{
+    if (NULL == filter)
+    {
+        return;
+    }
+
+    memset(filter->counters, 0, filter->n_counters / 2 + filter->n_counters % 2);
+    filter->n_items = 0;
+}
+
+filter_stats_t counting_filter_stats(counting_bloom_filter_t* filter)
+{
+    filter_stats_t stats = {
+        .n_items          = 0,
+        .n_bits           = 0,
+        .n_setbits        = 0,
+        .n_items_estimate = 0.0,
+        .fpr_estimate     = 0.0
+    };
+
+    if (filter != NULL)
+    {
+        stats.n_items = filter->n_items;
+        stats.n_bits  = filter->n_counters;
+
+        for (size_t i = 0; i < filter->n_counters; ++i)
+        {
+            stats.n_setbits += (get_counter(filter, i) != 0);
+        }
+
+        // as for filter_stats(), with nonzero counters as set bits
+        estimate_fill(&stats, filter->n_hashes);
+    }
+
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static unsigned get_counter(counting_bloom_filter_t* filter, size_t counter)
+{
+    const unsigned shift = (unsigned) (counter % 2)*4;
+    return (filter->counters[counter / 2] >> shift) & 0xF;
+}
+
+static void set_counter(counting_bloom_filter_t* filter, size_t counter, unsigned value)
+{
+    const unsigned shift = (unsigned) (counter % 2)*4;
+    uint8_t* byte = &filter->counters[counter / 2];
+
+    *byte = (uint8_t) ((*byte & ~(0xF << shift)) | (value << shift));
+}
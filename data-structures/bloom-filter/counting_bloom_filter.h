@@ -0,0 +1,149 @@
+// counting_bloom_filter.h
+// A bloom filter that supports removal, with a 4-bit counter per bit.
+
+#ifndef COUNTING_BLOOM_FILTER_H
+#define COUNTING_BLOOM_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bloom_filter.h"
+
+// Background:
+//
+// An item cannot be removed from a standard bloom filter (bloom_filter.h)
+// by clearing its bits, since each bit may also have been set by other
+// items, which would then be reported absent.
+//
+// A counting bloom filter (Fan, Cao, Almeida and Broder, 2000) replaces
+// each bit with a small counter. An insert increments the k counters for
+// an item and a removal decrements them; an item is present if all of
+// its counters are nonzero. The false-positive rate is that of a standard
+// filter with the same number of bits as there are counters, but the
+// filter is four times the size.
+//
+// Counters here are four bits, packed two to a byte. A counter that
+// reaches its maximum (COUNTER_MAX) sticks there: it is no longer
+// incremented or decremented, since its true count is unknown. With
+// optimal sizing the chance of any counter reaching 16 is negligible.
+//
+// Only items that have been inserted may be removed. Removing an item
+// that was never inserted, but is a false positive, decrements counters
+// belonging to other items and may cause false negatives.
+
+// The largest value of a counter.
+#define COUNTER_MAX 15
+
+// The counting bloom filter data structure.
+typedef struct counting_bloom_filter
+{
+    // The number of counters in the filter.
+    size_t n_counters;
+
+    // The number of hash functions used to implement the filter.
+    size_t n_hashes;
+
+    // The number of items in the filter.
+    size_t n_items;
+
+    // The counters, two to a byte, the first in the low four bits.
+    uint8_t* counters;
+} counting_bloom_filter_t;
+
+// counting_filter_new()
+//
+// Construct a new counting bloom filter data structure.
+//
+// Arguments:
+//  n_counters - the number of counters in the filter
+//  n_hashes   - the number of hash functions to use in filter operations
+//
+// Returns:
+//  A pointer to a newly constructed filter on success
+//  NULL on failure (invalid arguments, allocation failure)
+counting_bloom_filter_t* counting_filter_new(const size_t n_counters, const size_t n_hashes);
+
+// counting_filter_new_optimal()
+//
+// Construct a new counting bloom filter sized for an expected number of
+// items and a target false-positive rate, as for filter_new_optimal().
+//
+// Arguments:
+//  n_items - the expected number of items
+//  fpr     - the target false-positive rate, in (0, 1)
+//
+// Returns:
+//  A pointer to a newly constructed filter on success
+//  NULL on failure (invalid arguments, allocation failure)
+counting_bloom_filter_t* counting_filter_new_optimal(const size_t n_items, const double fpr);
+
+// counting_filter_delete()
+//
+// Destroy an existing counting bloom filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void counting_filter_delete(counting_bloom_filter_t* filter);
+
+// counting_filter_insert()
+//
+// Insert new data into the filter.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - arbitrary user data to insert
+//  len    - the length of the user data (in bytes)
+void counting_filter_insert(counting_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// counting_filter_remove()
+//
+// Remove data, previously inserted, from the filter.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - arbitrary user data to remove
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  `true` if the data was likely present, and is removed
+//  `false` if the data is not present (the filter is unchanged),
+//  or on invalid arguments
+bool counting_filter_remove(counting_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// counting_filter_test()
+//
+// Test for the presence of `data` in an existing filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//  data   - arbitrary user data for which to test
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  ABSENT  if the data is not present in the filter
+//  PRESENT if the data is likely present in the filter
+//  ERROR   on error
+filter_test_t counting_filter_test(counting_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// counting_filter_clear()
+//
+// Clear all data from the filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void counting_filter_clear(counting_bloom_filter_t* filter);
+
+// counting_filter_stats()
+//
+// Return metadata about the current state of the filter. Each counter is
+// reported as a bit of the filter, which is set if the counter is nonzero.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//
+// Returns:
+//  A structure populated with metadata regarding the filter state
+filter_stats_t counting_filter_stats(counting_bloom_filter_t* filter);
+
+#endif // COUNTING_BLOOM_FILTER_H
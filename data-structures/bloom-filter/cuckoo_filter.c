@@ -0,0 +1,393 @@
+// cuckoo_filter.c
+// A probabilistic set that supports removal, implemented as a cuckoo filter.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "murmur3.h"
+#include "cuckoo_filter.h"
+
+// Entries are read and written through an unaligned 64-bit window,
+// so the table is padded to allow a window at its last entry.
+#define TABLE_PADDING sizeof(uint64_t)
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+static size_t table_bytes(size_t n_buckets, size_t fingerprint_bits);
+
+static void locate(cuckoo_filter_t* filter, byte_t* data, size_t len, size_t* bucket, uint32_t* fingerprint);
+static size_t alt_bucket(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint);
+
+static uint32_t get_entry(cuckoo_filter_t* filter, size_t entry);
+static void set_entry(cuckoo_filter_t* filter, size_t entry, uint32_t fingerprint);
+
+static bool bucket_insert(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint);
+static bool bucket_contains(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint);
+static bool bucket_remove(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint);
+
+static void place(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint);
+static bool victim_matches(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint);
+static uint64_t next_random(cuckoo_filter_t* filter);
+static bool valid_item(byte_t* data, size_t len);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+cuckoo_filter_t* cuckoo_filter_new(const size_t n_buckets, const size_t fingerprint_bits)
+{
+    if (0 == n_buckets
+     || 0 == fingerprint_bits
+     || fingerprint_bits > CUCKOO_MAX_FINGERPRINT_BITS
+     || n_buckets > SIZE_MAX / (2*CUCKOO_BUCKET_SIZE*CUCKOO_MAX_FINGERPRINT_BITS))
+    {
+        return NULL;
+    }
+
+    size_t n = 1;
+    while (n < n_buckets)
+    {
+        n *= 2;
+    }
+
+    cuckoo_filter_t* filter = malloc(sizeof(cuckoo_filter_t));
+    if (NULL == filter)
+    {
+        return NULL;
+    }
+
+    filter->table = calloc(table_bytes(n, fingerprint_bits), sizeof(uint8_t));
+    if (NULL == filter->table)
+    {
+        free(filter);
+        return NULL;
+    }
+
+    filter->n_buckets        = n;
+    filter->fingerprint_bits = fingerprint_bits;
+    filter->n_items          = 0;
+    filter->rng              = 0x9e3779b97f4a7c15ULL;
+    filter->has_victim       = false;
+    filter->victim_bucket    = 0;
+    filter->victim           = 0;
+
+    return filter;
+}
+
+cuckoo_filter_t* cuckoo_filter_new_optimal(const size_t n_items, const double fpr)
+{
+    if (0 == n_items || !(fpr > 0.0 && fpr < 1.0))
+    {
+        return NULL;
+    }
+
+    // a test compares 2 * CUCKOO_BUCKET_SIZE fingerprints, each
+    // of which matches by chance with probability 2^-f
+    const double fingerprint_bits = ceil(log2(2.0*CUCKOO_BUCKET_SIZE / fpr));
+
+    const double n_buckets = ceil((double) n_items / (CUCKOO_BUCKET_SIZE*CUCKOO_LOAD_FACTOR));
+    if (n_buckets > (double) (SIZE_MAX / 2))
+    {
+        return NULL;
+    }
+
+    return cuckoo_filter_new((size_t) n_buckets, (fingerprint_bits < 1.0) ? 1 : (size_t) fingerprint_bits);
+}
+
+void cuckoo_filter_delete(cuckoo_filter_t* filter)
+{
+    if (filter != NULL)
+    {
+        free(filter->table);
+        free(filter);
+    }
+}
+
+bool cuckoo_filter_insert(cuckoo_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len) || filter->has_victim)
+    {
+        return false;
+    }
+
+    size_t   bucket;
+    uint32_t fingerprint;
+    locate(filter, data, len, &bucket, &fingerprint);
+
+    // the fingerprint is stored, though another may be displaced to the victim
+    place(filter, bucket, fingerprint);
+    filter->n_items++;
+
+    return true;
+}
+
+bool cuckoo_filter_remove(cuckoo_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return false;
+    }
+
+    size_t   bucket;
+    uint32_t fingerprint;
+    locate(filter, data, len, &bucket, &fingerprint);
+
+    if (victim_matches(filter, bucket, fingerprint))
+    {
+        filter->has_victim = false;
+    }
+    else if (bucket_remove(filter, bucket, fingerprint)
+          || bucket_remove(filter, alt_bucket(filter, bucket, fingerprint), fingerprint))
+    {
+        // an entry is free, so the victim may now have a place
+        if (filter->has_victim)
+        {
+            filter->has_victim = false;
+            place(filter, filter->victim_bucket, filter->victim);
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    filter->n_items--;
+    return true;
+}
+
+filter_test_t cuckoo_filter_test(cuckoo_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || !valid_item(data, len))
+    {
+        return ERROR;
+    }
+
+    size_t   bucket;
+    uint32_t fingerprint;
+    locate(filter, data, len, &bucket, &fingerprint);
+
+    const bool found = bucket_contains(filter, bucket, fingerprint)
+        || bucket_contains(filter, alt_bucket(filter, bucket, fingerprint), fingerprint)
+        || victim_matches(filter, bucket, fingerprint);
+
+    return found ? PRESENT : ABSENT;
+}
+
+void cuckoo_filter_clear(cuckoo_filter_t* filter)
+{
+    if (NULL == filter)
+    {
+        return;
+    }
+
+    memset(filter->table, 0, table_bytes(filter->n_buckets, filter->fingerprint_bits));
+
+    filter->n_items    = 0;
+    filter->has_victim = false;
+}
+
+filter_stats_t cuckoo_filter_stats(cuckoo_filter_t* filter)
+{
+    filter_stats_t stats = {
+        .n_items          = 0,
+        .n_bits           = 0,
+        .n_setbits        = 0,
+        .n_items_estimate = 0.0,
+        .fpr_estimate     = 0.0
+    };
+
+    if (filter != NULL)
+    {
+        const size_t n_entries = filter->n_buckets*CUCKOO_BUCKET_SIZE;
+
+        stats.n_items = filter->n_items;
+        stats.n_bits  = n_entries*filter->fingerprint_bits;
+
+        size_t n_occupied = 0;
+        for (size_t i = 0; i < n_entries; ++i)
+        {
+            n_occupied += (get_entry(filter, i) != 0);
+        }
+
+        stats.n_setbits = n_occupied*filter->fingerprint_bits;
+
+        // every stored fingerprint is counted exactly, and a test compares
+        // the fingerprint of an absent item with those in two buckets,
+        // each matching with probability 2^-f
+        const double load = (double) n_occupied / (double) n_entries;
+        const double p    = ldexp(1.0, -(int) filter->fingerprint_bits);
+
+        stats.n_items_estimate = (double) (n_occupied + filter->has_victim);
+        stats.fpr_estimate     = 1.0 - pow(1.0 - p, 2.0*CUCKOO_BUCKET_SIZE*load);
+    }
+
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static size_t table_bytes(size_t n_buckets, size_t fingerprint_bits)
+{
+    const size_t n_bits = n_buckets*CUCKOO_BUCKET_SIZE*fingerprint_bits;
+    return n_bits / 8 + (n_bits % 8 != 0) + TABLE_PADDING;
+}
+
+// Compute the first bucket and the fingerprint of an item.
+static void locate(cuckoo_filter_t* filter, byte_t* data, size_t len, size_t* bucket, uint32_t* fingerprint)
+{
+    uint64_t hash[2];
+    MurmurHash3_x64_128(data, (int) len, 0, hash);
+
+    const uint64_t mask = (1ULL << filter->fingerprint_bits) - 1;
+
+    // zero marks an empty entry, so is not a fingerprint
+    uint32_t f = (uint32_t) (hash[1] & mask);
+    *fingerprint = (0 == f) ? 1 : f;
+    *bucket      = (size_t) (hash[0] & (filter->n_buckets - 1));
+}
+
+static size_t alt_bucket(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint)
+{
+    // mix the fingerprint so that all of its bits affect the bucket
+    uint64_t h = (uint64_t) fingerprint*0xc6a4a7935bd1e995ULL;
+    h ^= h >> 32;
+
+    return (bucket ^ (size_t) h) & (filter->n_buckets - 1);
+}
+
+static uint32_t get_entry(cuckoo_filter_t* filter, size_t entry)
+{
+    const size_t bit = entry*filter->fingerprint_bits;
+
+    uint64_t window;
+    memcpy(&window, filter->table + bit / 8, sizeof(window));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    window = __builtin_bswap64(window);
+#endif
+
+    const uint64_t mask = (1ULL << filter->fingerprint_bits) - 1;
+    return (uint32_t) ((window >> (bit % 8)) & mask);
+}
+
+static void set_entry(cuckoo_filter_t* filter, size_t entry, uint32_t fingerprint)
+{
+    const size_t bit = entry*filter->fingerprint_bits;
+
+    // an entry spans at most 39 bits of the window, from its first byte
+    uint64_t window;
+    memcpy(&window, filter->table + bit / 8, sizeof(window));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    window = __builtin_bswap64(window);
+#endif
+
+    const uint64_t mask = ((1ULL << filter->fingerprint_bits) - 1) << (bit % 8);
+    window = (window & ~mask) | ((uint64_t) fingerprint << (bit % 8));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    window = __builtin_bswap64(window);
+#endif
+    memcpy(filter->table + bit / 8, &window, sizeof(window));
+}
+
+static bool bucket_insert(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint)
+{
+    const size_t first = bucket*CUCKOO_BUCKET_SIZE;
+    for (size_t i = first; i < first + CUCKOO_BUCKET_SIZE; ++i)
+    {
+        if (0 == get_entry(filter, i))
+        {
+            set_entry(filter, i, fingerprint);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool bucket_contains(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint)
+{
+    const size_t first = bucket*CUCKOO_BUCKET_SIZE;
+    for (size_t i = first; i < first + CUCKOO_BUCKET_SIZE; ++i)
+    {
+        if (get_entry(filter, i) == fingerprint)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool bucket_remove(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint)
+{
+    const size_t first = bucket*CUCKOO_BUCKET_SIZE;
+    for (size_t i = first; i < first + CUCKOO_BUCKET_SIZE; ++i)
+    {
+        if (get_entry(filter, i) == fingerprint)
+        {
+            set_entry(filter, i, 0);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Store a fingerprint in one of its buckets, displacing others as
+// necessary; the fingerprint displaced last, if any, becomes the victim.
+static void place(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint)
+{
+    const size_t other = alt_bucket(filter, bucket, fingerprint);
+    if (bucket_insert(filter, bucket, fingerprint) || bucket_insert(filter, other, fingerprint))
+    {
+        return;
+    }
+
+    bucket = (next_random(filter) & 1) ? bucket : other;
+
+    for (size_t kick = 0; kick < CUCKOO_MAX_KICKS; ++kick)
+    {
+        const size_t   entry     = bucket*CUCKOO_BUCKET_SIZE + next_random(filter) % CUCKOO_BUCKET_SIZE;
+        const uint32_t displaced = get_entry(filter, entry);
+
+        set_entry(filter, entry, fingerprint);
+
+        fingerprint = displaced;
+        bucket      = alt_bucket(filter, bucket, fingerprint);
+
+        if (bucket_insert(filter, bucket, fingerprint))
+        {
+            return;
+        }
+    }
+
+    filter->has_victim    = true;
+    filter->victim_bucket = bucket;
+    filter->victim        = fingerprint;
+}
+
+static bool victim_matches(cuckoo_filter_t* filter, size_t bucket, uint32_t fingerprint)
+{
+    return filter->has_victim
+        && filter->victim == fingerprint
+        && (filter->victim_bucket == bucket || filter->victim_bucket == alt_bucket(filter, bucket, fingerprint));
+}
+
+static uint64_t next_random(cuckoo_filter_t* filter)
+{
+    // xorshift64*
+    uint64_t x = filter->rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    filter->rng = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static bool valid_item(byte_t* data, size_t len)
+{
+    return (data != NULL) && (len > 0);
+}
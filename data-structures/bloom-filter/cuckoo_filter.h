@@ -0,0 +1,190 @@
+// cuckoo_filter.h
+// A probabilistic set that supports removal, implemented as a cuckoo filter.
+
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bloom_filter.h"
+
+// Background:
+//
+// A cuckoo filter (Fan, Andersen, Kaminsky and Mitzenmacher, 2014) stores
+// a short fingerprint of each item, rather than setting bits, in a cuckoo
+// hash table. The table is an array of buckets of CUCKOO_BUCKET_SIZE
+// entries each, and each item may be stored in either of two buckets.
+// An item is present if its fingerprint is found in either bucket, and
+// is removed by clearing one copy of its fingerprint.
+//
+// The two buckets for an item are found by "partial-key cuckoo hashing":
+// the first bucket i1 is derived from a hash of the item, and the second
+// is i2 = i1 ^ hash(fingerprint). Since i1 = i2 ^ hash(fingerprint) as
+// well, the other bucket of any stored fingerprint can be computed from
+// the fingerprint alone, without the item. The number of buckets must be
+// a power of two for this to hold, so tables are rounded up to one.
+//
+// To insert an item, its fingerprint is placed in an empty entry of
+// either bucket. If both are full, a fingerprint is chosen at random
+// from one of them and replaced, and the displaced fingerprint is moved
+// to its other bucket, possibly displacing another, and so on up to
+// CUCKOO_MAX_KICKS times. If the chain of displacements does not end,
+// the last fingerprint displaced is kept aside, so that no item is lost,
+// and the filter is full: further inserts fail until an item is removed.
+// Tables of four-entry buckets fill to about 95% before this happens.
+//
+// A test examines at most two buckets of entries, and for f-bit
+// fingerprints the false-positive rate is at most 2 * 4 / 2^f. Once the
+// rate required is below about 0.3%, a cuckoo filter is smaller than a
+// bloom filter with the same rate. Fingerprints are packed here, so that
+// a filter with f-bit fingerprints uses f bits per entry.
+//
+// Like the counting bloom filter (counting_bloom_filter.h), only items
+// that have been inserted may be removed. The same item may be inserted
+// more than once, and is then removed once per insert, but an item can
+// be stored at most 2 * CUCKOO_BUCKET_SIZE times.
+
+// The number of entries in each bucket.
+#define CUCKOO_BUCKET_SIZE 4
+
+// The most fingerprints displaced by an insert.
+#define CUCKOO_MAX_KICKS 500
+
+// The fraction of entries used, in a filter sized for a number of items.
+#define CUCKOO_LOAD_FACTOR 0.95
+
+// The widest fingerprint, in bits.
+#define CUCKOO_MAX_FINGERPRINT_BITS 32
+
+// The cuckoo filter data structure.
+typedef struct cuckoo_filter
+{
+    // The number of buckets in the filter, a power of two.
+    size_t n_buckets;
+
+    // The number of bits in each fingerprint.
+    size_t fingerprint_bits;
+
+    // The number of items in the filter.
+    size_t n_items;
+
+    // The state of the generator that chooses entries to displace.
+    uint64_t rng;
+
+    // Whether a fingerprint was displaced by an insert and not stored,
+    // and if so, the fingerprint and one of its buckets.
+    bool     has_victim;
+    size_t   victim_bucket;
+    uint32_t victim;
+
+    // The entries, packed in fingerprint_bits each, zero if empty.
+    uint8_t* table;
+} cuckoo_filter_t;
+
+// cuckoo_filter_new()
+//
+// Construct a new cuckoo filter data structure.
+//
+// Arguments:
+//  n_buckets        - the number of buckets in the filter,
+//                     rounded up to a power of two
+//  fingerprint_bits - the number of bits in each fingerprint,
+//                     from 1 to CUCKOO_MAX_FINGERPRINT_BITS
+//
+// Returns:
+//  A pointer to a newly constructed filter on success
+//  NULL on failure (invalid arguments, allocation failure)
+cuckoo_filter_t* cuckoo_filter_new(const size_t n_buckets, const size_t fingerprint_bits);
+
+// cuckoo_filter_new_optimal()
+//
+// Construct a new cuckoo filter sized for an expected
+// number of items and a target false-positive rate.
+//
+// Arguments:
+//  n_items - the expected number of items
+//  fpr     - the target false-positive rate, in (0, 1)
+//
+// Returns:
+//  A pointer to a newly constructed filter on success
+//  NULL on failure (invalid arguments, allocation failure)
+cuckoo_filter_t* cuckoo_filter_new_optimal(const size_t n_items, const double fpr);
+
+// cuckoo_filter_delete()
+//
+// Destroy an existing cuckoo filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void cuckoo_filter_delete(cuckoo_filter_t* filter);
+
+// cuckoo_filter_insert()
+//
+// Insert new data into the filter.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - arbitrary user data to insert
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  `true` if the data is inserted
+//  `false` if the filter is full, or on invalid arguments
+bool cuckoo_filter_insert(cuckoo_filter_t* filter, byte_t* data, size_t len);
+
+// cuckoo_filter_remove()
+//
+// Remove data, previously inserted, from the filter.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - arbitrary user data to remove
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  `true` if the data was likely present, and is removed
+//  `false` if the data is not present (the filter is unchanged),
+//  or on invalid arguments
+bool cuckoo_filter_remove(cuckoo_filter_t* filter, byte_t* data, size_t len);
+
+// cuckoo_filter_test()
+//
+// Test for the presence of `data` in an existing filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//  data   - arbitrary user data for which to test
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  ABSENT  if the data is not present in the filter
+//  PRESENT if the data is likely present in the filter
+//  ERROR   on error
+filter_test_t cuckoo_filter_test(cuckoo_filter_t* filter, byte_t* data, size_t len);
+
+// cuckoo_filter_clear()
+//
+// Clear all data from the filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void cuckoo_filter_clear(cuckoo_filter_t* filter);
+
+// cuckoo_filter_stats()
+//
+// Return metadata about the current state of the filter. The bits of the
+// filter are those of its entries, and the bits of occupied entries are
+// reported as set. The estimated number of items is the number of stored
+// fingerprints, and the estimated false-positive rate follows from the
+// fraction of entries that are occupied.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//
+// Returns:
+//  A structure populated with metadata regarding the filter state
+filter_stats_t cuckoo_filter_stats(cuckoo_filter_t* filter);
+
+#endif // CUCKOO_FILTER_H
@@ -0,0 +1,90 @@
+// filter_internal.h
+// Hashing and estimates shared by the bloom filters of this directory.
+//
+// Not part of the interface of any filter. The standard, counting and
+// concurrent filters include it so that they derive the positions for
+// an item identically; the functions are inline since they lie on the
+// path of every insert and test.
+
+#ifndef FILTER_INTERNAL_H
+#define FILTER_INTERNAL_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "murmur3.h"
+#include "bloom_filter.h"
+
+// The position of the bits (or counters) tested for a key.
+//
+// The k positions for a key are derived from a single 128-bit hash by
+// double hashing (Kirsch and Mitzenmacher, 2006): with the two 64-bit
+// halves of the hash as h1 and h2, the ith position is (h1 + i*h2) mod n,
+// for n positions. This gives the same false-positive rate asymptotically
+// as k independent hash functions, at the cost of one pass over the key
+// rather than k.
+typedef struct probe
+{
+    // The current position.
+    size_t position;
+
+    // The distance between successive positions, modulo n.
+    size_t step;
+} probe_t;
+
+// The first of the positions for a key, among n_positions.
+static inline probe_t first_probe(byte_t* data, size_t len, size_t n_positions)
+{
+    uint64_t hash[2];
+    MurmurHash3_x64_128(data, (int) len, FILTER_SEED, hash);
+
+    probe_t probe = {
+        .position = (size_t) (hash[0] % n_positions),
+        .step     = (size_t) (hash[1] % n_positions)
+    };
+
+    // a zero step would probe a single position k times
+    if (0 == probe.step && n_positions > 1)
+    {
+        probe.step = 1;
+    }
+
+    return probe;
+}
+
+// Advance to the next of the positions for a key, among n_positions.
+static inline void next_probe(probe_t* probe, size_t n_positions)
+{
+    // both terms are less than n_positions, so one subtraction reduces the sum
+    probe->position += probe->step;
+    if (probe->position >= n_positions)
+    {
+        probe->position -= n_positions;
+    }
+}
+
+static inline bool valid_item(byte_t* data, size_t len)
+{
+    return (data != NULL) && (len > 0);
+}
+
+// Fill in the estimates of `stats` from its counts of bits and set bits.
+//
+// With a fraction f of m bits set, each of k bits of an absent item is
+// set with probability f, and the expected number of distinct items to
+// have set them is -(m / k) ln(1 - f).
+static inline void estimate_fill(filter_stats_t* stats, size_t n_hashes)
+{
+    const double m = (double) stats->n_bits;
+    const double k = (double) n_hashes;
+    const double f = (double) stats->n_setbits / m;
+
+    stats->fpr_estimate     = pow(f, k);
+    stats->n_items_estimate = (stats->n_setbits == stats->n_bits)
+        ? INFINITY
+        : -(m / k)*log1p(-f);
+}
+
+#endif // FILTER_INTERNAL_H
@@ -0,0 +1,502 @@
+// hash_bench.c
+// Throughput and quality benchmarks for candidate hash functions.
+//
+// The filters in this directory, and the hashmap, hash every key they
+// see, so the hash function bounds their throughput for all but the
+// largest tables. This benchmark compares the Murmur3 variants in
+// murmur3.c against two newer hash functions, reproduced below: wyhash
+// (Wang Yi), which mixes with a 64x64 -> 128-bit multiply, and XXH64
+// (Yann Collet), which runs four independent accumulators over 32-byte
+// stripes. FNV-1a, a byte-at-a-time hash, is included as a baseline of
+// poor quality.
+//
+// The throughput benchmark hashes keys of 4 bytes to 4KB, drawn from a
+// buffer of random bytes at random offsets, and reports the mean time
+// per hash. The number of keys in each run is scaled down with their
+// size, so that each run hashes about the same number of bytes. The
+// buffer is larger than the L2 cache, so the times for short keys
+// include a cache miss, as they would in a filter or a hashmap. The
+// "x86_32 x8" column hashes the same keys with MurmurHash3_x86_32_batch(),
+// which produces the same digests as MurmurHash3_x86_32() but hashes
+// eight keys at once in the lanes of an AVX2 vector.
+//
+// The avalanche benchmark measures how well each hash mixes its input.
+// For AVALANCHE_TRIALS random keys, it flips each bit of the key in turn
+// and records which bits of the digest change. In a good hash each bit
+// of the digest changes with probability 1/2 whatever the input bit; it
+// reports the worst and the mean bias, |2p - 1|, over every pair of input
+// and output bits, as a percentage. With AVALANCHE_TRIALS trials, noise
+// alone gives a worst bias of about 2%.
+//
+// Usage:
+//  ./hash_bench [bytes hashed per run]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "murmur3.h"
+
+#define DEFAULT_BYTES_PER_RUN (64*1024*1024)
+
+// The most keys in any run.
+#define MAX_KEYS 1000000
+
+// The buffer from which keys are drawn.
+#define BUFFER_SIZE (1 << 22)
+
+// The number of random keys in each avalanche test, and the longest key.
+#define AVALANCHE_TRIALS  50000
+#define AVALANCHE_MAX_LEN 16
+
+// ----------------------------------------------------------------------------
+// Candidates
+
+static uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// wyhash, as of its final version 4.
+
+static const uint64_t WY_SECRET[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+    0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+static void wy_mum(uint64_t* a, uint64_t* b)
+{
+    const __uint128_t r = (__uint128_t) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+}
+
+static uint64_t wy_mix(uint64_t a, uint64_t b)
+{
+    wy_mum(&a, &b);
+    return a ^ b;
+}
+
+static uint64_t wyhash(const void* key, size_t len, uint64_t seed)
+{
+    const uint8_t* p = key;
+    const uint64_t* s = WY_SECRET;
+
+    seed ^= wy_mix(seed ^ s[0], s[1]);
+
+    uint64_t a;
+    uint64_t b;
+
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            const size_t d = (len >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + d);
+            b = (read32(p + len - 4) << 32) | read32(p + len - 4 - d);
+        }
+        else if (len > 0)
+        {
+            a = ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        size_t i = len;
+        if (i >= 48)
+        {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+
+            do
+            {
+                seed = wy_mix(read64(p) ^ s[1], read64(p + 8) ^ seed);
+                see1 = wy_mix(read64(p + 16) ^ s[2], read64(p + 24) ^ see1);
+                see2 = wy_mix(read64(p + 32) ^ s[3], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16)
+        {
+            seed = wy_mix(read64(p) ^ s[1], read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+
+    a ^= s[1];
+    b ^= seed;
+    wy_mum(&a, &b);
+
+    return wy_mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+// XXH64.
+
+#define XXH_PRIME1 0x9e3779b185ebca87ULL
+#define XXH_PRIME2 0xc2b2ae3d27d4eb4fULL
+#define XXH_PRIME3 0x165667b19e3779f9ULL
+#define XXH_PRIME4 0x85ebca77c2b2ae63ULL
+#define XXH_PRIME5 0x27d4eb2f165667c5ULL
+
+static uint64_t xxh_round(uint64_t acc, uint64_t input)
+{
+    acc += input*XXH_PRIME2;
+    acc  = rotl64(acc, 31);
+    return acc*XXH_PRIME1;
+}
+
+static uint64_t xxh_merge(uint64_t acc, uint64_t v)
+{
+    acc ^= xxh_round(0, v);
+    return acc*XXH_PRIME1 + XXH_PRIME4;
+}
+
+static uint64_t xxh64(const void* key, size_t len, uint64_t seed)
+{
+    const uint8_t* p   = key;
+    const uint8_t* end = p + len;
+
+    uint64_t h;
+
+    if (len >= 32)
+    {
+        uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+        uint64_t v2 = seed + XXH_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME1;
+
+        do
+        {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    }
+    else
+    {
+        h = seed + XXH_PRIME5;
+    }
+
+    h += len;
+
+    for (; end - p >= 8; p += 8)
+    {
+        h ^= xxh_round(0, read64(p));
+        h  = rotl64(h, 27)*XXH_PRIME1 + XXH_PRIME4;
+    }
+
+    if (end - p >= 4)
+    {
+        h ^= read32(p)*XXH_PRIME1;
+        h  = rotl64(h, 23)*XXH_PRIME2 + XXH_PRIME3;
+        p += 4;
+    }
+
+    for (; p < end; ++p)
+    {
+        h ^= *p*XXH_PRIME5;
+        h  = rotl64(h, 11)*XXH_PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME2;
+    h ^= h >> 29;
+    h *= XXH_PRIME3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+// FNV-1a, 64-bit.
+
+static uint64_t fnv1a(const void* key, size_t len, uint64_t seed)
+{
+    const uint8_t* p = key;
+
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+// The Murmur3 variants, with the first 64 bits of the wider digests.
+
+static uint64_t murmur3_x86_32(const void* key, size_t len, uint64_t seed)
+{
+    uint32_t out;
+    MurmurHash3_x86_32(key, (int) len, (uint32_t) seed, &out);
+    return out;
+}
+
+static uint64_t murmur3_x86_128(const void* key, size_t len, uint64_t seed)
+{
+    uint64_t out[2];
+    MurmurHash3_x86_128(key, (int) len, (uint32_t) seed, out);
+    return out[0];
+}
+
+static uint64_t murmur3_x64_128(const void* key, size_t len, uint64_t seed)
+{
+    uint64_t out[2];
+    MurmurHash3_x64_128(key, (int) len, (uint32_t) seed, out);
+    return out[0];
+}
+
+typedef uint64_t (*hash_f)(const void* key, size_t len, uint64_t seed);
+
+typedef struct candidate
+{
+    const char* name;
+    hash_f      hash;
+
+    // The number of bits in the digest.
+    size_t      bits;
+} candidate_t;
+
+static const candidate_t CANDIDATES[] = {
+    { "x86_32",  murmur3_x86_32,  32 },
+    { "x86_128", murmur3_x86_128, 64 },
+    { "x64_128", murmur3_x64_128, 64 },
+    { "wyhash",  wyhash,          64 },
+    { "xxh64",   xxh64,           64 },
+    { "fnv1a",   fnv1a,           64 }
+};
+
+#define N_CANDIDATES (sizeof(CANDIDATES) / sizeof(CANDIDATES[0]))
+
+// ----------------------------------------------------------------------------
+// Harness
+
+static uint64_t next_random(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static uint8_t buffer[BUFFER_SIZE];
+
+// The keys of the current run, and their digests from the batch hash.
+static const void* keys[MAX_KEYS];
+static uint32_t    digests[MAX_KEYS];
+
+// Folded into by every hash, so that none is optimized away.
+static volatile uint64_t sink;
+
+// Time n_keys hashes of len bytes each, in nanoseconds per hash.
+static double time_hash(hash_f hash, size_t len, size_t n_keys)
+{
+    uint64_t acc = 0;
+
+    const double start = now_seconds();
+
+    for (size_t i = 0; i < n_keys; ++i)
+    {
+        acc ^= hash(keys[i], len, 0);
+    }
+
+    const double end = now_seconds();
+
+    sink ^= acc;
+    return (end - start)*1e9 / (double) n_keys;
+}
+
+static double time_batch(size_t len, size_t n_keys)
+{
+    const double start = now_seconds();
+    MurmurHash3_x86_32_batch(keys, (int) len, 0, digests, (int) n_keys);
+    const double end = now_seconds();
+
+    sink ^= digests[n_keys - 1];
+    return (end - start)*1e9 / (double) n_keys;
+}
+
+// Measure the worst and mean bias, as percentages, over
+// every pair of input and output bits, for keys of len bytes.
+static void run_avalanche(const candidate_t* c, size_t len, uint64_t* rng, double* worst, double* mean)
+{
+    static uint32_t flips[AVALANCHE_MAX_LEN*8][64];
+    memset(flips, 0, sizeof(flips));
+
+    uint8_t key[AVALANCHE_MAX_LEN];
+
+    for (size_t t = 0; t < AVALANCHE_TRIALS; ++t)
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            key[i] = (uint8_t) (next_random(rng) >> 56);
+        }
+
+        const uint64_t h = c->hash(key, len, 0);
+
+        for (size_t bit = 0; bit < 8*len; ++bit)
+        {
+            key[bit / 8] ^= (uint8_t) (1 << (bit % 8));
+
+            // count only the output bits that changed
+            uint64_t diff = h ^ c->hash(key, len, 0);
+            while (diff != 0)
+            {
+                flips[bit][__builtin_ctzll(diff)]++;
+                diff &= diff - 1;
+            }
+
+            key[bit / 8] ^= (uint8_t) (1 << (bit % 8));
+        }
+    }
+
+    *worst = 0.0;
+    *mean  = 0.0;
+
+    for (size_t bit = 0; bit < 8*len; ++bit)
+    {
+        for (size_t out = 0; out < c->bits; ++out)
+        {
+            const double p    = (double) flips[bit][out] / AVALANCHE_TRIALS;
+            const double bias = 100.0*((p > 0.5) ? 2*p - 1 : 1 - 2*p);
+
+            *mean += bias;
+            if (bias > *worst)
+            {
+                *worst = bias;
+            }
+        }
+    }
+
+    *mean /= (double) (8*len*c->bits);
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t bytes_per_run = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_BYTES_PER_RUN;
+
+    uint64_t rng = 1;
+    for (size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        buffer[i] = (uint8_t) (next_random(&rng) >> 56);
+    }
+
+    const size_t key_sizes[] = { 4, 8, 16, 32, 64, 256, 1024, 4096 };
+
+    printf("%6s  %8s", "bytes", "keys");
+    for (size_t c = 0; c < N_CANDIDATES; ++c)
+    {
+        printf("  %9s", CANDIDATES[c].name);
+    }
+    printf("  %9s\n", "x86_32 x8");
+
+    for (size_t s = 0; s < sizeof(key_sizes) / sizeof(key_sizes[0]); ++s)
+    {
+        const size_t len = key_sizes[s];
+
+        size_t n_keys = bytes_per_run / len;
+        if (n_keys > MAX_KEYS)
+        {
+            n_keys = MAX_KEYS;
+        }
+
+        if (0 == n_keys)
+        {
+            n_keys = 1;
+        }
+
+        for (size_t i = 0; i < n_keys; ++i)
+        {
+            keys[i] = buffer + next_random(&rng) % (BUFFER_SIZE - len);
+        }
+
+        printf("%6zu  %8zu", len, n_keys);
+        for (size_t c = 0; c < N_CANDIDATES; ++c)
+        {
+            printf("  %9.1f", time_hash(CANDIDATES[c].hash, len, n_keys));
+        }
+        printf("  %9.1f\n", time_batch(len, n_keys));
+    }
+
+    printf("(nanoseconds per hash)\n\n");
+
+    const size_t avalanche_sizes[] = { 4, 16 };
+
+    printf("%8s", "");
+    for (size_t s = 0; s < sizeof(avalanche_sizes) / sizeof(avalanche_sizes[0]); ++s)
+    {
+        printf("  %5zu B worst  %6s", avalanche_sizes[s], "mean");
+    }
+    printf("\n");
+
+    for (size_t c = 0; c < N_CANDIDATES; ++c)
+    {
+        printf("%8s", CANDIDATES[c].name);
+
+        for (size_t s = 0; s < sizeof(avalanche_sizes) / sizeof(avalanche_sizes[0]); ++s)
+        {
+            double worst;
+            double mean;
+            run_avalanche(&CANDIDATES[c], avalanche_sizes[s], &rng, &worst, &mean);
+
+            printf("  %13.2f  %6.2f", worst, mean);
+        }
+        printf("\n");
+    }
+
+    printf("(bias, %% of an output bit's flips from one input bit)\n");
+
+    return EXIT_SUCCESS;
+}
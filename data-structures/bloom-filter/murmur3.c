@@ -7,8 +7,15 @@
 // compile and run any of them on any platform, but your performance with the
 // non-native version will be less than optimal.
 
+#include <string.h>
+
 #include "murmur3.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_AVX2 1
+#endif
+
 //-----------------------------------------------------------------------------
 // Platform-specific functions and macros
 
@@ -310,3 +317,131 @@ void MurmurHash3_x64_128 ( const void * key, const int len,
   ((uint64_t*)out)[0] = h1;
   ((uint64_t*)out)[1] = h2;
 }
+
+//-----------------------------------------------------------------------------
+// Batch hashing - the keys of a batch share a length, so every lane of a
+// vector runs the same number of body rounds; only the tail, which is at
+// most three bytes, is gathered a key at a time.
+
+#ifdef HAVE_AVX2
+
+#define LANES 8
+
+#define ROTL32_AVX2(x,r) \
+  _mm256_or_si256(_mm256_slli_epi32(x,r), _mm256_srli_epi32(x,32-(r)))
+
+static FORCE_INLINE uint32_t load32 ( const uint8_t * p )
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static FORCE_INLINE uint32_t tail32 ( const uint8_t * tail, int len )
+{
+  uint32_t k1 = 0;
+
+  switch(len & 3)
+  {
+  case 3: k1 ^= tail[2] << 16;
+  case 2: k1 ^= tail[1] << 8;
+  case 1: k1 ^= tail[0];
+  };
+
+  return k1;
+}
+
+__attribute__((target("avx2")))
+static FORCE_INLINE __m256i mix_k1_avx2 ( __m256i k1 )
+{
+  const __m256i c1 = _mm256_set1_epi32((int)0xcc9e2d51);
+  const __m256i c2 = _mm256_set1_epi32((int)0x1b873593);
+
+  k1 = _mm256_mullo_epi32(k1, c1);
+  k1 = ROTL32_AVX2(k1, 15);
+  return _mm256_mullo_epi32(k1, c2);
+}
+
+// Hash LANES keys, as MurmurHash3_x86_32() does each.
+__attribute__((target("avx2")))
+static void MurmurHash3_x86_32_avx2 ( const uint8_t * const * keys, int len,
+                                      uint32_t seed, uint32_t * out )
+{
+  const int nblocks = len / 4;
+  int i;
+
+  __m256i h1 = _mm256_set1_epi32((int)seed);
+
+  //----------
+  // body
+
+  for(i = 0; i < nblocks; i++)
+  {
+    const int offset = i*4;
+
+    __m256i k1 = _mm256_setr_epi32(
+      (int)load32(keys[0] + offset), (int)load32(keys[1] + offset),
+      (int)load32(keys[2] + offset), (int)load32(keys[3] + offset),
+      (int)load32(keys[4] + offset), (int)load32(keys[5] + offset),
+      (int)load32(keys[6] + offset), (int)load32(keys[7] + offset));
+
+    h1 = _mm256_xor_si256(h1, mix_k1_avx2(k1));
+    h1 = ROTL32_AVX2(h1, 13);
+
+    // h1*5 as h1 + h1*4, which is cheaper than a 32-bit multiply
+    h1 = _mm256_add_epi32(h1, _mm256_slli_epi32(h1, 2));
+    h1 = _mm256_add_epi32(h1, _mm256_set1_epi32((int)0xe6546b64));
+  }
+
+  //----------
+  // tail
+
+  if(len & 3)
+  {
+    const int offset = nblocks*4;
+
+    __m256i k1 = _mm256_setr_epi32(
+      (int)tail32(keys[0] + offset, len), (int)tail32(keys[1] + offset, len),
+      (int)tail32(keys[2] + offset, len), (int)tail32(keys[3] + offset, len),
+      (int)tail32(keys[4] + offset, len), (int)tail32(keys[5] + offset, len),
+      (int)tail32(keys[6] + offset, len), (int)tail32(keys[7] + offset, len));
+
+    h1 = _mm256_xor_si256(h1, mix_k1_avx2(k1));
+  }
+
+  //----------
+  // finalization
+
+  h1 = _mm256_xor_si256(h1, _mm256_set1_epi32(len));
+
+  h1 = _mm256_xor_si256(h1, _mm256_srli_epi32(h1, 16));
+  h1 = _mm256_mullo_epi32(h1, _mm256_set1_epi32((int)0x85ebca6b));
+  h1 = _mm256_xor_si256(h1, _mm256_srli_epi32(h1, 13));
+  h1 = _mm256_mullo_epi32(h1, _mm256_set1_epi32((int)0xc2b2ae35));
+  h1 = _mm256_xor_si256(h1, _mm256_srli_epi32(h1, 16));
+
+  _mm256_storeu_si256((__m256i *)out, h1);
+}
+
+#endif // HAVE_AVX2
+
+void MurmurHash3_x86_32_batch ( const void * const * keys, int len,
+                                uint32_t seed, uint32_t * out, int n )
+{
+  int i = 0;
+
+#ifdef HAVE_AVX2
+  if(__builtin_cpu_supports("avx2"))
+  {
+    for(; i + LANES <= n; i += LANES)
+    {
+      MurmurHash3_x86_32_avx2((const uint8_t * const *)keys + i, len, seed, out + i);
+    }
+  }
+#endif
+
+  for(; i < n; i++)
+  {
+    MurmurHash3_x86_32(keys[i], len, seed, out + i);
+  }
+}
@@ -0,0 +1,228 @@
+// scalable_bloom_filter.c
+// A bloom filter that grows to hold any number of items.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "scalable_bloom_filter.h"
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+static bool add_filter(scalable_bloom_filter_t* filter);
+static size_t newest_room(scalable_bloom_filter_t* filter);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+scalable_bloom_filter_t* scalable_filter_new(const size_t initial_items, const double fpr)
+{
+    if (0 == initial_items || !(fpr > 0.0 && fpr < 1.0))
+    {
+        return NULL;
+    }
+
+    scalable_bloom_filter_t* filter = malloc(sizeof(scalable_bloom_filter_t));
+    if (NULL == filter)
+    {
+        return NULL;
+    }
+
+    filter->fpr           = fpr;
+    filter->initial_items = initial_items;
+    filter->n_items       = 0;
+    filter->n_filters     = 0;
+
+    if (!add_filter(filter))
+    {
+        free(filter);
+        return NULL;
+    }
+
+    return filter;
+}
+
+void scalable_filter_delete(scalable_bloom_filter_t* filter)
+{
+    if (NULL == filter)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < filter->n_filters; ++i)
+    {
+        filter_delete(filter->filters[i]);
+    }
+
+    free(filter);
+}
+
+bool scalable_filter_insert(scalable_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || NULL == data || 0 == len)
+    {
+        return false;
+    }
+
+    bool within_budget = true;
+
+    bloom_filter_t* newest = filter->filters[filter->n_filters - 1];
+    if (newest->n_items >= filter->next_check)
+    {
+        const size_t room = newest_room(filter);
+        if (0 == room)
+        {
+            within_budget = add_filter(filter);
+            if (!within_budget)
+            {
+                // the newest filter keeps filling; don't recount it on every insert
+                filter->next_check = newest->n_items + filter->initial_items;
+            }
+        }
+        else
+        {
+            // check again once about half of the room is taken
+            filter->next_check = newest->n_items + room / 2 + room % 2;
+        }
+    }
+
+    filter_insert(filter->filters[filter->n_filters - 1], data, len);
+    filter->n_items++;
+
+    return within_budget;
+}
+
+filter_test_t scalable_filter_test(scalable_bloom_filter_t* filter, byte_t* data, size_t len)
+{
+    if (NULL == filter || NULL == data || 0 == len)
+    {
+        return ERROR;
+    }
+
+    // the newest filter is the largest, and holds the most items
+    for (size_t i = filter->n_filters; i > 0; --i)
+    {
+        if (PRESENT == filter_test(filter->filters[i - 1], data, len))
+        {
+            return PRESENT;
+        }
+    }
+
+    return ABSENT;
+}
+
+void scalable_filter_clear(scalable_bloom_filter_t* filter)
+{
+    if (NULL == filter)
+    {
+        return;
+    }
+
+    for (size_t i = 1; i < filter->n_filters; ++i)
+    {
+        filter_delete(filter->filters[i]);
+    }
+
+    filter_clear(filter->filters[0]);
+
+    filter->n_filters  = 1;
+    filter->n_items    = 0;
+    filter->next_check = filter->initial_items / 2;
+}
+
+filter_stats_t scalable_filter_stats(scalable_bloom_filter_t* filter)
+{
+    filter_stats_t stats = {
+        .n_items          = 0,
+        .n_bits           = 0,
+        .n_setbits        = 0,
+        .n_items_estimate = 0.0,
+        .fpr_estimate     = 0.0
+    };
+
+    if (filter != NULL)
+    {
+        stats.n_items = filter->n_items;
+
+        // the probability that no filter reports a false positive
+        double p_none = 1.0;
+
+        for (size_t i = 0; i < filter->n_filters; ++i)
+        {
+            const filter_stats_t s = filter_stats(filter->filters[i]);
+            stats.n_bits           += s.n_bits;
+            stats.n_setbits        += s.n_setbits;
+            stats.n_items_estimate += s.n_items_estimate;
+
+            p_none *= 1.0 - s.fpr_estimate;
+        }
+
+        stats.fpr_estimate = 1.0 - p_none;
+    }
+
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+// Append a filter to the chain, sized for the next
+// capacity and false-positive rate in the sequence.
+static bool add_filter(scalable_bloom_filter_t* filter)
+{
+    const size_t i = filter->n_filters;
+    if (SCALABLE_MAX_FILTERS == i)
+    {
+        return false;
+    }
+
+    size_t n_items = filter->initial_items;
+    double fpr     = filter->fpr*(1.0 - SCALABLE_TIGHTENING);
+
+    for (size_t j = 0; j < i; ++j)
+    {
+        if (n_items > SIZE_MAX / SCALABLE_GROWTH)
+        {
+            return false;
+        }
+
+        n_items *= SCALABLE_GROWTH;
+        fpr     *= SCALABLE_TIGHTENING;
+    }
+
+    bloom_filter_t* next = filter_new_optimal(n_items, fpr);
+    if (NULL == next)
+    {
+        return false;
+    }
+
+    filter->filters[i] = next;
+    filter->n_filters++;
+
+    filter->next_check = n_items / 2;
+
+    return true;
+}
+
+// Estimate the number of distinct items the newest filter may
+// take before it is full: zero if it is full, and at least one
+// otherwise.
+static size_t newest_room(scalable_bloom_filter_t* filter)
+{
+    bloom_filter_t* newest = filter->filters[filter->n_filters - 1];
+
+    const filter_stats_t stats = filter_stats(newest);
+    if ((double) stats.n_setbits > SCALABLE_FILL_LIMIT*(double) stats.n_bits)
+    {
+        return 0;
+    }
+
+    // the number of items that sets SCALABLE_FILL_LIMIT of the bits, by
+    // the same estimate as filter_stats() gives for those already inserted
+    const double m     = (double) stats.n_bits;
+    const double k     = (double) newest->n_hashes;
+    const double limit = -(m / k)*log1p(-SCALABLE_FILL_LIMIT);
+
+    const double room = limit - stats.n_items_estimate;
+    return (room < 1.0) ? 1 : (size_t) room;
+}
@@ -0,0 +1,157 @@
+// scalable_bloom_filter.h
+// A bloom filter that grows to hold any number of items.
+
+#ifndef SCALABLE_BLOOM_FILTER_H
+#define SCALABLE_BLOOM_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bloom_filter.h"
+
+// Background:
+//
+// A bloom filter is sized for the number of items it is expected to
+// hold. If more are inserted, nothing fails: more and more of its bits
+// are set, and its false-positive rate rises silently towards one.
+//
+// A scalable bloom filter (Almeida, Baquero, Preguica and Hutchison,
+// 2007) holds a chain of ordinary bloom filters. Items are inserted
+// into the newest filter in the chain until it is full, at which point
+// a new filter is added; an item is present if any filter in the chain
+// reports it present.
+//
+// Each filter is created by filter_new_optimal(), so that it is full,
+// with about half of its bits set, once it holds the number of items
+// for which it was sized. Rather than count items, the chain checks the
+// fill ratio of the newest filter (from filter_stats()) and adds a
+// filter once more than SCALABLE_FILL_LIMIT of its bits are set. This
+// bounds the false-positive rate of each filter even if the same items
+// are inserted repeatedly. Since filter_stats() counts the set bits of
+// the whole filter, the fill ratio is not checked on every insert: each
+// check estimates from the fill ratio how many more items the filter
+// can take, and the next check is made once half of them are inserted.
+// A filter is thus checked about log2 of its capacity times, and found
+// full within an insert or two of its limit.
+//
+// Filter i is sized for SCALABLE_GROWTH times as many items as filter
+// i - 1, so that the chain stays short (logarithmic in the number of
+// items), and for a false-positive rate SCALABLE_TIGHTENING times that
+// of filter i - 1. With a rate of p0 for the first filter, the rate of
+// the chain as a whole is then at most p0 / (1 - SCALABLE_TIGHTENING);
+// the first filter is given p0 = p * (1 - SCALABLE_TIGHTENING) so that
+// the chain as a whole meets a target rate p.
+
+// The growth in capacity of each filter over the previous one.
+#define SCALABLE_GROWTH 2
+
+// The ratio of the false-positive rate of each filter to the previous one.
+#define SCALABLE_TIGHTENING 0.5
+
+// The fill ratio above which the newest filter is considered full.
+#define SCALABLE_FILL_LIMIT 0.5
+
+// The most filters in the chain.
+#define SCALABLE_MAX_FILTERS 48
+
+// The scalable bloom filter data structure.
+typedef struct scalable_bloom_filter
+{
+    // The target false-positive rate of the chain as a whole.
+    double fpr;
+
+    // The number of items for which the first filter is sized.
+    size_t initial_items;
+
+    // The number of items inserted into the filter.
+    size_t n_items;
+
+    // The number of filters in the chain.
+    size_t n_filters;
+
+    // The number of items in the newest filter at which
+    // its fill ratio is next checked.
+    size_t next_check;
+
+    // The filters in the chain, oldest first.
+    bloom_filter_t* filters[SCALABLE_MAX_FILTERS];
+} scalable_bloom_filter_t;
+
+// scalable_filter_new()
+//
+// Construct a new scalable bloom filter data structure.
+//
+// Arguments:
+//  initial_items - the number of items for which the first filter
+//                  in the chain is sized
+//  fpr           - the target false-positive rate, in (0, 1)
+//
+// Returns:
+//  A pointer to a newly constructed filter on success
+//  NULL on failure (invalid arguments, allocation failure)
+scalable_bloom_filter_t* scalable_filter_new(const size_t initial_items, const double fpr);
+
+// scalable_filter_delete()
+//
+// Destroy an existing scalable bloom filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void scalable_filter_delete(scalable_bloom_filter_t* filter);
+
+// scalable_filter_insert()
+//
+// Insert new data into the filter, adding a filter
+// to the chain if the newest filter is full.
+//
+// Arguments:
+//  filter - pointer to an existing filter
+//  data   - arbitrary user data to insert
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  `true` if the data is inserted within the target false-positive rate
+//  `false` on invalid arguments, or if a filter could not be added to
+//  the chain; in the latter case the data is inserted into the newest
+//  filter regardless, so that it is never reported absent
+bool scalable_filter_insert(scalable_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// scalable_filter_test()
+//
+// Test for the presence of `data` in an existing filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//  data   - arbitrary user data for which to test
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  ABSENT  if the data is not present in the filter
+//  PRESENT if the data is likely present in the filter
+//  ERROR   on error
+filter_test_t scalable_filter_test(scalable_bloom_filter_t* filter, byte_t* data, size_t len);
+
+// scalable_filter_clear()
+//
+// Clear all data from the filter, and shrink
+// the chain back to its first filter.
+//
+// Arguments:
+//  filter - pointer to existing filter
+void scalable_filter_clear(scalable_bloom_filter_t* filter);
+
+// scalable_filter_stats()
+//
+// Return metadata about the current state of the filter, summed over
+// every filter in the chain. The estimated false-positive rate is the
+// probability that any filter in the chain reports a false positive.
+//
+// Arguments:
+//  filter - pointer to existing filter
+//
+// Returns:
+//  A structure populated with metadata regarding the filter state
+filter_stats_t scalable_filter_stats(scalable_bloom_filter_t* filter);
+
+#endif // SCALABLE_BLOOM_FILTER_H
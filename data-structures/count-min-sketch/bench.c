@@ -0,0 +1,285 @@
+// bench.c
+// Update throughput and estimation error of the Count-Min sketch.
+//
+// Models a stream of keys whose frequencies follow a Zipf distribution
+// with exponent ZIPF_EXPONENT over N_DISTINCT distinct keys, as the key
+// streams of caches and request logs typically do: a few keys are very
+// frequent, and most are rare. The stream is generated before any
+// timing begins, and the exact count of every key is kept alongside.
+//
+// For sketches sized by cms_new_optimal() for error bounds of 0.1%,
+// 0.01% and 0.001% of the total count (at delta = 1%), with and without
+// conservative update, it reports the memory used, the throughput of
+// cms_add(), the mean error of the estimates over all distinct keys, the
+// percentage of keys whose estimate is within the bound epsilon * N,
+// and the mean relative error of the estimates for the TOP_KEYS most
+// frequent keys. An exact count of every key would need a map with
+// N_DISTINCT entries; the memory of such a map is shown for comparison,
+// at 16 bytes per entry before any overhead.
+//
+// Finally the stream is split between N_SHARDS sketches, which are then
+// merged, and the estimates of the merged sketch are compared with those
+// of a single sketch over the whole stream.
+//
+// Usage:
+//  ./bench [stream length]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "count_min_sketch.h"
+
+#define DEFAULT_STREAM_LENGTH 10000000
+
+// The number of distinct keys, and the skew of their frequencies.
+#define N_DISTINCT    (1 << 20)
+#define ZIPF_EXPONENT 1.1
+
+// The number of most frequent keys whose relative error is reported.
+#define TOP_KEYS 100
+
+// The number of sketches the stream is split between, to be merged.
+#define N_SHARDS 8
+
+// ----------------------------------------------------------------------------
+// Harness
+
+static uint64_t next_random(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void fail(const char* message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+// The stream, and the exact count of each key; key i is the
+// (i + 1)th most frequent, so keys 0 to TOP_KEYS - 1 are the top keys.
+static uint64_t* stream;
+static uint32_t  exact[N_DISTINCT];
+
+static void make_stream(size_t length)
+{
+    // the cumulative distribution of the keys, searched for each draw
+    double* cdf = malloc(N_DISTINCT*sizeof(double));
+    stream      = malloc(length*sizeof(uint64_t));
+    if (NULL == cdf || NULL == stream)
+    {
+        fail("allocation failed");
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < N_DISTINCT; ++i)
+    {
+        sum   += 1.0 / pow((double) (i + 1), ZIPF_EXPONENT);
+        cdf[i] = sum;
+    }
+
+    uint64_t rng = 1;
+    for (size_t n = 0; n < length; ++n)
+    {
+        const double u = (double) (next_random(&rng) >> 11) / 9007199254740992.0*sum;
+
+        size_t low  = 0;
+        size_t high = N_DISTINCT - 1;
+        while (low < high)
+        {
+            const size_t mid = low + (high - low) / 2;
+            if (cdf[mid] < u)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        stream[n] = low;
+        exact[low]++;
+    }
+
+    free(cdf);
+}
+
+static void add_range(count_min_sketch_t* sketch, size_t first, size_t last)
+{
+    for (size_t n = first; n < last; ++n)
+    {
+        cms_add(sketch, (byte_t*) &stream[n], sizeof(uint64_t), 1);
+    }
+}
+
+// The error of each estimate, summarized.
+typedef struct errors
+{
+    double mean;
+    double within_percent;
+    double top_percent;
+} errors_t;
+
+static errors_t measure(count_min_sketch_t* sketch, double epsilon)
+{
+    const double bound = epsilon*(double) sketch->total;
+
+    errors_t e = { 0.0, 0.0, 0.0 };
+    size_t n_seen = 0;
+
+    for (uint64_t key = 0; key < N_DISTINCT; ++key)
+    {
+        if (0 == exact[key])
+        {
+            continue;
+        }
+
+        const double error = (double) (cms_estimate(sketch, (byte_t*) &key, sizeof(key)) - exact[key]);
+
+        e.mean           += error;
+        e.within_percent += (error <= bound);
+        n_seen++;
+
+        if (key < TOP_KEYS)
+        {
+            e.top_percent += 100.0*error / (double) exact[key];
+        }
+    }
+
+    e.mean           /= (double) n_seen;
+    e.within_percent  = 100.0*e.within_percent / (double) n_seen;
+    e.top_percent    /= TOP_KEYS;
+
+    return e;
+}
+
+static void run_accuracy(size_t length, double epsilon, bool conservative)
+{
+    count_min_sketch_t* sketch = cms_new_optimal(epsilon, 0.01, conservative);
+    if (NULL == sketch)
+    {
+        fail("allocation failed");
+    }
+
+    const double start = now_seconds();
+    add_range(sketch, 0, length);
+    const double mups = (double) length / (now_seconds() - start) / 1e6;
+
+    const errors_t e = measure(sketch, epsilon);
+
+    printf("%12s  %8.3f  %10zu  %10.2f  %12.2f  %10.0f  %10.2f  %10.3f\n",
+        conservative ? "conservative" : "plain", 100.0*epsilon,
+        sketch->width*sketch->depth*sizeof(uint32_t) / 1024, mups,
+        e.mean, epsilon*(double) length, e.within_percent, e.top_percent);
+
+    cms_delete(sketch);
+}
+
+static void run_shards(size_t length, double epsilon, bool conservative)
+{
+    count_min_sketch_t* whole = cms_new_optimal(epsilon, 0.01, conservative);
+    count_min_sketch_t* shards[N_SHARDS];
+
+    if (NULL == whole)
+    {
+        fail("allocation failed");
+    }
+
+    add_range(whole, 0, length);
+
+    for (size_t s = 0; s < N_SHARDS; ++s)
+    {
+        shards[s] = cms_new_optimal(epsilon, 0.01, conservative);
+        if (NULL == shards[s])
+        {
+            fail("allocation failed");
+        }
+
+        add_range(shards[s], length*s / N_SHARDS, length*(s + 1) / N_SHARDS);
+    }
+
+    const double start = now_seconds();
+    for (size_t s = 1; s < N_SHARDS; ++s)
+    {
+        if (!cms_merge(shards[0], shards[s]))
+        {
+            fail("merge failed");
+        }
+    }
+    const double merge_ms = (now_seconds() - start)*1e3;
+
+    const errors_t w = measure(whole, epsilon);
+    const errors_t m = measure(shards[0], epsilon);
+
+    printf("%12s  %8.3f  %10.3f  %12.2f  %12.2f  %10.3f  %10.3f\n",
+        conservative ? "conservative" : "plain", 100.0*epsilon, merge_ms,
+        w.mean, m.mean, w.top_percent, m.top_percent);
+
+    cms_delete(whole);
+    for (size_t s = 0; s < N_SHARDS; ++s)
+    {
+        cms_delete(shards[s]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t length = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_STREAM_LENGTH;
+
+    if (0 == length)
+    {
+        fail("empty stream");
+    }
+
+    make_stream(length);
+
+    size_t n_distinct = 0;
+    for (size_t key = 0; key < N_DISTINCT; ++key)
+    {
+        n_distinct += (exact[key] != 0);
+    }
+
+    printf("%zu updates over %zu distinct keys (exact map: at least %zu KB)\n\n",
+        length, n_distinct, n_distinct*16 / 1024);
+
+    printf("%12s  %8s  %10s  %10s  %12s  %10s  %10s  %10s\n",
+        "policy", "eps %", "KB", "Mupd/s", "mean error", "eps * N", "within %", "top err %");
+
+    const double epsilons[] = { 0.001, 0.0001, 0.00001 };
+    for (size_t e = 0; e < sizeof(epsilons) / sizeof(epsilons[0]); ++e)
+    {
+        run_accuracy(length, epsilons[e], false);
+        run_accuracy(length, epsilons[e], true);
+    }
+
+    printf("\n%12s  %8s  %10s  %12s  %12s  %10s  %10s\n",
+        "policy", "eps %", "merge ms", "whole error", "merged error", "whole top", "merged top");
+
+    run_shards(length, 0.0001, false);
+    run_shards(length, 0.0001, true);
+
+    printf("(%d shards; top: mean relative error %% of the %d most frequent keys)\n", N_SHARDS, TOP_KEYS);
+
+    free(stream);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,228 @@
+// check.c
+// Driver program for Count-Min sketch data structure tests.
+
+// attribute gnu_printf
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "count_min_sketch.h"
+
+// ----------------------------------------------------------------------------
+// Test Cases
+
+// Key i of a stream is added (i % 16) + 1 times, in all N_ROUNDS rounds.
+static void add_stream(count_min_sketch_t* sketch, uint64_t first, uint64_t last, size_t n_rounds)
+{
+    for (size_t round = 0; round < n_rounds; ++round)
+    {
+        for (uint64_t i = first; i < last; ++i)
+        {
+            ck_assert(cms_add(sketch, (byte_t*)&i, sizeof(i), (uint32_t) (i % 16) + 1));
+        }
+    }
+}
+
+START_TEST(test_cms_new)
+{
+    ck_assert(NULL == cms_new(0, 4, false));
+    ck_assert(NULL == cms_new(1024, 0, false));
+    ck_assert(NULL == cms_new_optimal(0.0, 0.01, false));
+    ck_assert(NULL == cms_new_optimal(0.001, 1.0, false));
+
+    // rounded up to a power of two
+    count_min_sketch_t* sketch = cms_new(1000, 4, false);
+    ck_assert_msg(sketch != NULL, "cms_new() returned NULL");
+    ck_assert(sketch->width == 1024 && sketch->depth == 4);
+    ck_assert(sketch->total == 0);
+    cms_delete(sketch);
+
+    // e / 0.001 = 2719 counters per row, and ln(100) = 4.6 rows
+    sketch = cms_new_optimal(0.001, 0.01, true);
+    ck_assert_msg(sketch != NULL, "cms_new_optimal() returned NULL");
+    ck_assert(sketch->width == 4096 && sketch->depth == 5);
+    ck_assert(sketch->conservative);
+    cms_delete(sketch);
+}
+END_TEST
+
+START_TEST(test_cms_estimates)
+{
+    const uint64_t N_KEYS   = 10000;
+    const size_t   N_ROUNDS = 3;
+    const double   EPSILON  = 0.001;
+
+    for (int conservative = 0; conservative <= 1; ++conservative)
+    {
+        count_min_sketch_t* sketch = cms_new_optimal(EPSILON, 0.01, conservative);
+        ck_assert_msg(sketch != NULL, "cms_new_optimal() returned NULL");
+
+        ck_assert(!cms_add(sketch, NULL, 8, 1));
+        ck_assert(!cms_add(sketch, (byte_t*)"abc", 0, 1));
+        ck_assert(!cms_add(NULL, (byte_t*)"abc", 3, 1));
+
+        add_stream(sketch, 0, N_KEYS, N_ROUNDS);
+
+        size_t n_within = 0;
+        for (uint64_t i = 0; i < N_KEYS; ++i)
+        {
+            const uint64_t actual   = N_ROUNDS*((i % 16) + 1);
+            const uint64_t estimate = cms_estimate(sketch, (byte_t*)&i, sizeof(i));
+
+            ck_assert_msg(estimate >= actual, "cms_estimate() returned an underestimate");
+            n_within += ((double) (estimate - actual) <= EPSILON*(double) sketch->total);
+        }
+
+        ck_assert_msg(n_within >= N_KEYS - N_KEYS / 100, "more than 1%% of estimates exceed the bound");
+        ck_assert(sketch->total == N_ROUNDS*(N_KEYS / 16)*(16*17 / 2));
+
+        ck_assert(cms_estimate(sketch, NULL, 8) == 0);
+
+        cms_clear(sketch);
+        ck_assert(sketch->total == 0);
+        ck_assert(cms_estimate(sketch, (byte_t*)"abc", 3) == 0);
+
+        cms_delete(sketch);
+    }
+}
+END_TEST
+
+START_TEST(test_cms_conservative)
+{
+    // a narrow sketch, so that most counters are shared
+    const uint64_t N_KEYS = 5000;
+
+    count_min_sketch_t* plain        = cms_new(256, 4, false);
+    count_min_sketch_t* conservative = cms_new(256, 4, true);
+    ck_assert(plain != NULL && conservative != NULL);
+
+    add_stream(plain, 0, N_KEYS, 1);
+    add_stream(conservative, 0, N_KEYS, 1);
+
+    uint64_t plain_error        = 0;
+    uint64_t conservative_error = 0;
+
+    for (uint64_t i = 0; i < N_KEYS; ++i)
+    {
+        const uint64_t actual = (i % 16) + 1;
+        const uint64_t p      = cms_estimate(plain, (byte_t*)&i, sizeof(i));
+        const uint64_t c      = cms_estimate(conservative, (byte_t*)&i, sizeof(i));
+
+        // conservative update never underestimates, nor exceeds the plain estimate
+        ck_assert(c >= actual && c <= p);
+
+        plain_error        += p - actual;
+        conservative_error += c - actual;
+    }
+
+    ck_assert(conservative_error < plain_error);
+
+    cms_delete(plain);
+    cms_delete(conservative);
+}
+END_TEST
+
+START_TEST(test_cms_merge)
+{
+    const uint64_t N_KEYS = 4000;
+
+    for (int conservative = 0; conservative <= 1; ++conservative)
+    {
+        count_min_sketch_t* a   = cms_new(1024, 4, conservative);
+        count_min_sketch_t* b   = cms_new(1024, 4, conservative);
+        count_min_sketch_t* all = cms_new(1024, 4, conservative);
+        ck_assert(a != NULL && b != NULL && all != NULL);
+
+        // two shards of a stream, with overlapping keys
+        add_stream(a, 0, N_KEYS / 2 + N_KEYS / 4, 1);
+        add_stream(b, N_KEYS / 4, N_KEYS, 1);
+        add_stream(all, 0, N_KEYS / 2 + N_KEYS / 4, 1);
+        add_stream(all, N_KEYS / 4, N_KEYS, 1);
+
+        ck_assert(cms_merge(a, b));
+        ck_assert(a->total == all->total);
+
+        if (!conservative)
+        {
+            // plain counters are sums, whatever the order of the adds
+            ck_assert(0 == memcmp(a->counters, all->counters, a->width*a->depth*sizeof(uint32_t)));
+        }
+
+        for (uint64_t i = 0; i < N_KEYS; ++i)
+        {
+            const bool     both   = (i >= N_KEYS / 4 && i < N_KEYS / 2 + N_KEYS / 4);
+            const uint64_t actual = ((i % 16) + 1)*(both ? 2 : 1);
+            ck_assert(cms_estimate(a, (byte_t*)&i, sizeof(i)) >= actual);
+        }
+
+        cms_delete(a);
+        cms_delete(b);
+        cms_delete(all);
+    }
+
+    count_min_sketch_t* a = cms_new(1024, 4, false);
+    count_min_sketch_t* b = cms_new(2048, 4, false);
+    count_min_sketch_t* c = cms_new(1024, 3, false);
+    count_min_sketch_t* d = cms_new(1024, 4, true);
+
+    ck_assert(!cms_merge(a, b));
+    ck_assert(!cms_merge(a, c));
+    ck_assert(!cms_merge(a, d));
+    ck_assert(!cms_merge(a, a));
+    ck_assert(!cms_merge(a, NULL));
+
+    cms_delete(a);
+    cms_delete(b);
+    cms_delete(c);
+    cms_delete(d);
+}
+END_TEST
+
+START_TEST(test_cms_saturation)
+{
+    count_min_sketch_t* sketch = cms_new(64, 2, true);
+    ck_assert(sketch != NULL);
+
+    ck_assert(cms_add(sketch, (byte_t*)"abc", 3, UINT32_MAX - 1));
+    ck_assert(cms_add(sketch, (byte_t*)"abc", 3, 5));
+
+    // counters saturate, though the total does not
+    ck_assert(cms_estimate(sketch, (byte_t*)"abc", 3) == UINT32_MAX);
+    ck_assert(sketch->total == (uint64_t) UINT32_MAX + 4);
+
+    cms_delete(sketch);
+}
+END_TEST
+
+// ----------------------------------------------------------------------------
+// Infrastructure
+
+Suite* count_min_sketch_suite(void)
+{
+    Suite* s = suite_create("count-min-sketch");
+    TCase* tc_core = tcase_create("count-min-sketch-core");
+
+    tcase_add_test(tc_core, test_cms_new);
+    tcase_add_test(tc_core, test_cms_estimates);
+    tcase_add_test(tc_core, test_cms_conservative);
+    tcase_add_test(tc_core, test_cms_merge);
+    tcase_add_test(tc_core, test_cms_saturation);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    Suite* suite = count_min_sketch_suite();
+    SRunner* runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    srunner_free(runner);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+// count_min_sketch.c
+// Approximate frequency counts implemented as a Count-Min sketch.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "murmur3.h"
+#include "count_min_sketch.h"
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+// The position of an item's counters, derived by double hashing.
+typedef struct probe
+{
+    // The column of the counter in the first row.
+    uint64_t column;
+
+    // The distance between the columns in successive rows.
+    uint64_t step;
+} probe_t;
+
+static probe_t make_probe(byte_t* data, size_t len);
+static uint32_t* row_counter(count_min_sketch_t* sketch, probe_t* probe, size_t row);
+static uint32_t add_saturating(uint32_t a, uint32_t b);
+static bool valid_item(byte_t* data, size_t len);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+count_min_sketch_t* cms_new(const size_t width, const size_t depth, const bool conservative)
+{
+    if (0 == width || 0 == depth || width > SIZE_MAX / 2)
+    {
+        return NULL;
+    }
+
+    size_t w = 1;
+    while (w < width)
+    {
+        w *= 2;
+    }
+
+    if (depth > SIZE_MAX / sizeof(uint32_t) / w)
+    {
+        return NULL;
+    }
+
+    count_min_sketch_t* sketch = malloc(sizeof(count_min_sketch_t));
+    if (NULL == sketch)
+    {
+        return NULL;
+    }
+
+    sketch->counters = calloc(w*depth, sizeof(uint32_t));
+    if (NULL == sketch->counters)
+    {
+        free(sketch);
+        return NULL;
+    }
+
+    sketch->width        = w;
+    sketch->depth        = depth;
+    sketch->conservative = conservative;
+    sketch->total        = 0;
+
+    return sketch;
+}
+
+count_min_sketch_t* cms_new_optimal(const double epsilon, const double delta, const bool conservative)
+{
+    if (!(epsilon > 0.0 && epsilon < 1.0) || !(delta > 0.0 && delta < 1.0))
+    {
+        return NULL;
+    }
+
+    const double width = ceil(exp(1.0) / epsilon);
+    const double depth = ceil(log(1.0 / delta));
+
+    if (width > (double) (SIZE_MAX / 2))
+    {
+        return NULL;
+    }
+
+    return cms_new((size_t) width, (depth < 1.0) ? 1 : (size_t) depth, conservative);
+}
+
+void cms_delete(count_min_sketch_t* sketch)
+{
+    if (sketch != NULL)
+    {
+        free(sketch->counters);
+        free(sketch);
+    }
+}
+
+bool cms_add(count_min_sketch_t* sketch, byte_t* data, size_t len, uint32_t count)
+{
+    if (NULL == sketch || !valid_item(data, len))
+    {
+        return false;
+    }
+
+    probe_t probe = make_probe(data, len);
+
+    if (sketch->conservative)
+    {
+        // raise each counter no further than the new estimate
+        uint32_t estimate = UINT32_MAX;
+        for (size_t i = 0; i < sketch->depth; ++i)
+        {
+            const uint32_t c = *row_counter(sketch, &probe, i);
+            if (c < estimate)
+            {
+                estimate = c;
+            }
+        }
+
+        const uint32_t target = add_saturating(estimate, count);
+        for (size_t i = 0; i < sketch->depth; ++i)
+        {
+            uint32_t* c = row_counter(sketch, &probe, i);
+            if (*c < target)
+            {
+                *c = target;
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < sketch->depth; ++i)
+        {
+            uint32_t* c = row_counter(sketch, &probe, i);
+            *c = add_saturating(*c, count);
+        }
+    }
+
+    sketch->total += count;
+    return true;
+}
+
+uint64_t cms_estimate(count_min_sketch_t* sketch, byte_t* data, size_t len)
+{
+    if (NULL == sketch || !valid_item(data, len))
+    {
+        return 0;
+    }
+
+    probe_t probe = make_probe(data, len);
+
+    uint32_t estimate = UINT32_MAX;
+    for (size_t i = 0; i < sketch->depth; ++i)
+    {
+        const uint32_t c = *row_counter(sketch, &probe, i);
+        if (c < estimate)
+        {
+            estimate = c;
+        }
+    }
+
+    return estimate;
+}
+
+bool cms_merge(count_min_sketch_t* dst, count_min_sketch_t* src)
+{
+    if (NULL == dst || NULL == src || dst == src)
+    {
+        return false;
+    }
+
+    if (dst->width != src->width
+     || dst->depth != src->depth
+     || dst->conservative != src->conservative)
+    {
+        return false;
+    }
+
+    const size_t n_counters = dst->width*dst->depth;
+    for (size_t i = 0; i < n_counters; ++i)
+    {
+        dst->counters[i] = add_saturating(dst->counters[i], src->counters[i]);
+    }
+
+    dst->total += src->total;
+    return true;
+}
+
+void cms_clear(count_min_sketch_t* sketch)
+{
+    if (NULL == sketch)
+    {
+        return;
+    }
+
+    memset(sketch->counters, 0, sketch->width*sketch->depth*sizeof(uint32_t));
+    sketch->total = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static probe_t make_probe(byte_t* data, size_t len)
+{
+    uint64_t hash[2];
+    MurmurHash3_x64_128(data, (int) len, 0, hash);
+
+    probe_t probe = {
+        .column = hash[0],
+        .step   = hash[1]
+    };
+
+    return probe;
+}
+
+static uint32_t* row_counter(count_min_sketch_t* sketch, probe_t* probe, size_t row)
+{
+    const uint64_t column = (probe->column + row*probe->step) & (sketch->width - 1);
+    return &sketch->counters[row*sketch->width + column];
+}
+
+static uint32_t add_saturating(uint32_t a, uint32_t b)
+{
+    return (a > UINT32_MAX - b) ? UINT32_MAX : a + b;
+}
+
+static bool valid_item(byte_t* data, size_t len)
+{
+    return (data != NULL) && (len > 0);
+}
@@ -0,0 +1,169 @@
+// count_min_sketch.h
+// Approximate frequency counts implemented as a Count-Min sketch.
+
+#ifndef COUNT_MIN_SKETCH_H
+#define COUNT_MIN_SKETCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Background:
+//
+// Counting how often each distinct item occurs in a stream exactly
+// requires a map from every distinct item to its count, which grows
+// with the number of distinct items. A Count-Min sketch (Cormode and
+// Muthukrishnan, 2005) answers the same question approximately in a
+// fixed amount of memory.
+//
+// The sketch is a table of `depth` rows of `width` counters. Each row
+// has its own hash function, which maps an item to one counter in the
+// row. Adding an item adds its count to the item's counter in every
+// row; the estimated count of an item is the least of its counters.
+// Every counter of an item includes the item's own count, so the
+// estimate never falls below the true count; it exceeds it by the
+// counts of the other items that share the counter in every row.
+//
+// With width w = e / epsilon and depth d = ln(1 / delta), an estimate
+// exceeds the true count by more than epsilon * N, where N is the total
+// of all counts added, with probability at most delta. Frequent items
+// are thus estimated with small relative error, while the counts of
+// rare items are lost in the noise: the sketch is suited to finding
+// the items that dominate a stream rather than to counting every one.
+//
+// With conservative update (Estan and Varghese, 2002), adding an item
+// raises each of its counters only as far as needed: to the item's
+// current estimate plus the count added, if the counter is below that.
+// Since the estimate is the least of the counters, the result is the
+// same for the item being added, but counters that already exceed it
+// (because of other items) are left alone. This reduces the error of
+// every estimate, often by a large factor on skewed streams, at the
+// cost of reading every counter before writing.
+//
+// Sketches built over separate parts of a stream (for instance, one
+// per shard or thread) may be merged into a sketch of the whole stream
+// by adding their counters, provided that they have the same shape.
+// For sketches that use conservative update, the merged counters are
+// still never below the true counts, but may be larger than those of a
+// single sketch built over the whole stream.
+//
+// Each row hashes an item with Murmur3, deriving the counter for row
+// i from the two halves of a single 128-bit hash by double hashing
+// (h1 + i*h2), as the bloom filter does. The width is rounded up to a
+// power of two, so that a counter is selected with a mask rather than
+// a division. Counters are 32 bits wide, and saturate at UINT32_MAX.
+
+// The representation of bytes-like objects.
+typedef uint8_t byte_t;
+
+// The Count-Min sketch data structure.
+typedef struct count_min_sketch
+{
+    // The number of counters in each row, a power of two.
+    size_t width;
+
+    // The number of rows.
+    size_t depth;
+
+    // Whether counts are added by conservative update.
+    bool conservative;
+
+    // The total of all counts added to the sketch.
+    uint64_t total;
+
+    // The counters, row by row; counter j of row i is counters[i*width + j].
+    uint32_t* counters;
+} count_min_sketch_t;
+
+// cms_new()
+//
+// Construct a new Count-Min sketch data structure.
+//
+// Arguments:
+//  width        - the number of counters in each row, rounded
+//                 up to a power of two
+//  depth        - the number of rows
+//  conservative - `true` to add counts by conservative update
+//
+// Returns:
+//  A pointer to a newly constructed sketch on success
+//  NULL on failure (invalid arguments, allocation failure)
+count_min_sketch_t* cms_new(const size_t width, const size_t depth, const bool conservative);
+
+// cms_new_optimal()
+//
+// Construct a new Count-Min sketch whose estimates exceed the true
+// counts by at most epsilon times the total count, with probability
+// at least 1 - delta: with width e / epsilon and depth ln(1 / delta).
+//
+// Arguments:
+//  epsilon      - the error bound, as a fraction of the total, in (0, 1)
+//  delta        - the probability of exceeding the bound, in (0, 1)
+//  conservative - `true` to add counts by conservative update
+//
+// Returns:
+//  A pointer to a newly constructed sketch on success
+//  NULL on failure (invalid arguments, allocation failure)
+count_min_sketch_t* cms_new_optimal(const double epsilon, const double delta, const bool conservative);
+
+// cms_delete()
+//
+// Destroy an existing Count-Min sketch.
+//
+// Arguments:
+//  sketch - pointer to existing sketch
+void cms_delete(count_min_sketch_t* sketch);
+
+// cms_add()
+//
+// Add `count` occurrences of `data` to the sketch.
+//
+// Arguments:
+//  sketch - pointer to an existing sketch
+//  data   - arbitrary user data to count
+//  len    - the length of the user data (in bytes)
+//  count  - the number of occurrences to add
+//
+// Returns:
+//  `true` on success
+//  `false` on invalid arguments
+bool cms_add(count_min_sketch_t* sketch, byte_t* data, size_t len, uint32_t count);
+
+// cms_estimate()
+//
+// Estimate the number of occurrences of `data` added to the sketch.
+//
+// Arguments:
+//  sketch - pointer to existing sketch
+//  data   - arbitrary user data for which to estimate
+//  len    - the length of the user data (in bytes)
+//
+// Returns:
+//  An estimate that is never less than the true count
+//  0 on invalid arguments
+uint64_t cms_estimate(count_min_sketch_t* sketch, byte_t* data, size_t len);
+
+// cms_merge()
+//
+// Add the counts of the sketch `src` to the sketch `dst`, so that
+// `dst` estimates the counts of the items added to either.
+//
+// Arguments:
+//  dst - pointer to the existing sketch into which to merge
+//  src - pointer to an existing sketch of the same width, depth,
+//        and update policy
+//
+// Returns:
+//  `true` on success
+//  `false` on invalid arguments, or if the sketches differ in shape
+bool cms_merge(count_min_sketch_t* dst, count_min_sketch_t* src);
+
+// cms_clear()
+//
+// Clear all counts from the sketch.
+//
+// Arguments:
+//  sketch - pointer to existing sketch
+void cms_clear(count_min_sketch_t* sketch);
+
+#endif // COUNT_MIN_SKETCH_H
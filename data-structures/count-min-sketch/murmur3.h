@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+// MurmurHash3 was written by Austin Appleby, and is placed in the public domain. 
+// The author hereby disclaims copyright to this source code.
+
+#ifndef _MURMURHASH3_H_
+#define _MURMURHASH3_H_
+
+#include <stdint.h>
+
+// MurmurHash3_x86_32()
+//
+// Arguments:
+//  key  - the data to be hashed
+//  len  - the length of the data
+//  seed - a seed for this invocation of the hash function
+//  out  - buffer into which hash digest will be written
+//
+// Returns:
+//  A 32-bit hash digest in buffer `out`
+void MurmurHash3_x86_32 (const void *key, int len, uint32_t seed, void *out);
+
+// MurmurHash3_x86_128()
+//
+// Arguments:
+//  key  - the data to be hashed
+//  len  - the length of the data
+//  seed - a seed for this invocation of the hash function
+//  out  - buffer into which hash digest will be written
+//
+// Returns:
+//  A 128-bit hash digest in buffer `out`
+void MurmurHash3_x86_128(const void *key, int len, uint32_t seed, void *out);
+
+// MurmurHash3_x64_128()
+//
+// Arguments:
+//  key  - the data to be hashed
+//  len  - the length of the data
+//  seed - a seed for this invocation of the hash function
+//  out  - buffer into which hash digest will be written
+//
+// Returns:
+//  A 128-bit hash digest in buffer `out`
+void MurmurHash3_x64_128(const void *key, int len, uint32_t seed, void *out);
+
+// MurmurHash3_x86_32_batch()
+//
+// Hash `n` keys of the same length, producing for each the same digest
+// as MurmurHash3_x86_32(). On processors that support AVX2, the keys
+// are hashed eight at a time, one in each 32-bit lane of a vector.
+//
+// Arguments:
+//  keys - the data to be hashed, one pointer per key
+//  len  - the length of each key
+//  seed - a seed for this invocation of the hash function
+//  out  - buffer into which `n` 32-bit hash digests will be written
+//  n    - the number of keys
+//
+// Returns:
+//  The 32-bit hash digest of keys[i] in out[i]
+void MurmurHash3_x86_32_batch (const void * const * keys, int len, uint32_t seed, uint32_t *out, int n);
+
+#endif // _MURMURHASH3_H_
@@ -0,0 +1,193 @@
+// bench.c
+// Add throughput and estimation error of the HyperLogLog sketch.
+//
+// For precisions of 10, 14 and 16 bits (1KB, 16KB and 64KB of
+// registers), each of N_RUNS runs adds distinct 8-byte keys to an empty
+// sketch, with a different range of keys in each run, and records the
+// estimate each time the number of distinct keys reaches a power of
+// ten. It reports the throughput of hll_add(), and at each power of ten
+// the mean relative error of the estimates (their bias) and their root
+// mean square relative error, which should be close to the standard
+// error 1.04 / sqrt(m) shown alongside. An exact count of the largest
+// cardinality would need a set of that many keys; the memory of such a
+// set is shown for comparison, at 8 bytes per key before any overhead.
+//
+// Finally the keys are split between N_SHARDS sketches, which are then
+// merged, and the time to merge and the estimate of the merged sketch
+// are compared with a single sketch over all of the keys.
+//
+// Usage:
+//  ./bench [greatest cardinality]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "hyperloglog.h"
+
+#define DEFAULT_MAX_CARDINALITY 10000000
+
+// The number of runs at each precision, each with its own keys.
+#define N_RUNS 10
+
+// Keys of run r start at r times this amount.
+#define RUN_OFFSET (1ULL << 40)
+
+// The number of powers of ten up to the greatest cardinality, at most.
+#define MAX_CHECKPOINTS 20
+
+// The number of sketches the keys are split between, to be merged.
+#define N_SHARDS 8
+
+// ----------------------------------------------------------------------------
+// Harness
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void fail(const char* message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+static void run_precision(size_t precision, uint64_t max_cardinality)
+{
+    // the sum of the relative errors, and of their squares, at each checkpoint
+    double sum[MAX_CHECKPOINTS]    = { 0.0 };
+    double sum_sq[MAX_CHECKPOINTS] = { 0.0 };
+
+    size_t n_checkpoints = 0;
+    double n_adds        = 0.0;
+    double seconds       = 0.0;
+
+    hyperloglog_t* hll = hll_new(precision);
+    if (NULL == hll)
+    {
+        fail("allocation failed");
+    }
+
+    for (uint64_t run = 0; run < N_RUNS; ++run)
+    {
+        hll_clear(hll);
+
+        uint64_t added      = 0;
+        size_t   checkpoint = 0;
+
+        for (uint64_t next = 10; next <= max_cardinality && checkpoint < MAX_CHECKPOINTS; next *= 10)
+        {
+            const double start = now_seconds();
+            for (; added < next; ++added)
+            {
+                uint64_t key = run*RUN_OFFSET + added;
+                hll_add(hll, (byte_t*) &key, sizeof(key));
+            }
+            seconds += now_seconds() - start;
+
+            const double error = (hll_count(hll) - (double) next) / (double) next;
+            sum[checkpoint]    += error;
+            sum_sq[checkpoint] += error*error;
+            checkpoint++;
+        }
+
+        n_checkpoints = checkpoint;
+        n_adds       += (double) added;
+    }
+
+    printf("precision %zu: %zu bytes, %.1f ns per add, standard error %.3f%%\n",
+        precision, hll->n_registers, seconds*1e9 / n_adds,
+        100.0*1.04 / sqrt((double) hll->n_registers));
+
+    printf("%12s  %10s  %10s\n", "distinct", "bias %", "rms %");
+
+    uint64_t cardinality = 10;
+    for (size_t c = 0; c < n_checkpoints; ++c, cardinality *= 10)
+    {
+        printf("%12llu  %10.3f  %10.3f\n", (unsigned long long) cardinality,
+            100.0*sum[c] / N_RUNS, 100.0*sqrt(sum_sq[c] / N_RUNS));
+    }
+
+    printf("\n");
+
+    hll_delete(hll);
+}
+
+static void run_shards(size_t precision, uint64_t n_keys)
+{
+    hyperloglog_t* whole = hll_new(precision);
+    hyperloglog_t* shards[N_SHARDS];
+
+    if (NULL == whole)
+    {
+        fail("allocation failed");
+    }
+
+    for (size_t s = 0; s < N_SHARDS; ++s)
+    {
+        shards[s] = hll_new(precision);
+        if (NULL == shards[s])
+        {
+            fail("allocation failed");
+        }
+    }
+
+    for (uint64_t key = 0; key < n_keys; ++key)
+    {
+        hll_add(whole, (byte_t*) &key, sizeof(key));
+        hll_add(shards[key % N_SHARDS], (byte_t*) &key, sizeof(key));
+    }
+
+    const double start = now_seconds();
+    for (size_t s = 1; s < N_SHARDS; ++s)
+    {
+        if (!hll_merge(shards[0], shards[s]))
+        {
+            fail("merge failed");
+        }
+    }
+    const double merge_us = (now_seconds() - start)*1e6;
+
+    printf("%10s  %12s  %12s  %12s  %12s\n", "precision", "distinct", "merge us", "whole", "merged");
+    printf("%10zu  %12llu  %12.1f  %12.0f  %12.0f\n", precision, (unsigned long long) n_keys,
+        merge_us, hll_count(whole), hll_count(shards[0]));
+    printf("(%d shards)\n", N_SHARDS);
+
+    hll_delete(whole);
+    for (size_t s = 0; s < N_SHARDS; ++s)
+    {
+        hll_delete(shards[s]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const uint64_t max_cardinality = (argc > 1)
+        ? strtoull(argv[1], NULL, 10)
+        : DEFAULT_MAX_CARDINALITY;
+
+    if (max_cardinality < 10)
+    {
+        fail("cardinality must be at least 10");
+    }
+
+    printf("exact set of %llu keys: at least %llu KB\n\n",
+        (unsigned long long) max_cardinality, (unsigned long long) (max_cardinality*8 / 1024));
+
+    const size_t precisions[] = { 10, 14, 16 };
+    for (size_t p = 0; p < sizeof(precisions) / sizeof(precisions[0]); ++p)
+    {
+        run_precision(precisions[p], max_cardinality);
+    }
+
+    run_shards(14, max_cardinality);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+// check.c
+// Driver program for HyperLogLog data structure tests.
+
+// attribute gnu_printf
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#include <check.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hyperloglog.h"
+
+// ----------------------------------------------------------------------------
+// Test Cases
+
+static void add_range(hyperloglog_t* hll, uint64_t first, uint64_t last)
+{
+    for (uint64_t i = first; i < last; ++i)
+    {
+        ck_assert(hll_add(hll, (byte_t*)&i, sizeof(i)));
+    }
+}
+
+START_TEST(test_hll_new)
+{
+    ck_assert(NULL == hll_new(HLL_MIN_PRECISION - 1));
+    ck_assert(NULL == hll_new(HLL_MAX_PRECISION + 1));
+
+    hyperloglog_t* hll = hll_new(14);
+    ck_assert_msg(hll != NULL, "hll_new() returned NULL");
+    ck_assert(hll->precision == 14 && hll->n_registers == 16384);
+
+    ck_assert_msg(hll_count(hll) == 0.0, "hll_count() of an empty sketch is nonzero");
+
+    ck_assert(!hll_add(hll, NULL, 8));
+    ck_assert(!hll_add(hll, (byte_t*)"abc", 0));
+    ck_assert(!hll_add(NULL, (byte_t*)"abc", 3));
+
+    hll_delete(hll);
+}
+END_TEST
+
+START_TEST(test_hll_duplicates)
+{
+    hyperloglog_t* once  = hll_new(12);
+    hyperloglog_t* twice = hll_new(12);
+    ck_assert(once != NULL && twice != NULL);
+
+    ck_assert(hll_add(once, (byte_t*)"abc", 3));
+    ck_assert(fabs(hll_count(once) - 1.0) < 0.01);
+
+    add_range(once, 0, 1000);
+    add_range(twice, 0, 1000);
+    add_range(twice, 0, 1000);
+    ck_assert(hll_add(twice, (byte_t*)"abc", 3));
+
+    // repeated items change no register
+    ck_assert(0 == memcmp(once->registers, twice->registers, once->n_registers));
+    ck_assert(hll_count(once) == hll_count(twice));
+
+    hll_clear(once);
+    ck_assert(hll_count(once) == 0.0);
+
+    hll_delete(once);
+    hll_delete(twice);
+}
+END_TEST
+
+START_TEST(test_hll_accuracy)
+{
+    const size_t PRECISION = 14;
+
+    // four standard errors, 1.04 / sqrt(m) each
+    const double tolerance = 4*1.04 / sqrt((double) (1 << PRECISION));
+
+    hyperloglog_t* hll = hll_new(PRECISION);
+    ck_assert(hll != NULL);
+
+    // from far fewer items than registers to far more
+    uint64_t n = 0;
+    const uint64_t counts[] = { 10, 100, 1000, 10000, 100000, 1000000 };
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        add_range(hll, n, counts[c]);
+        n = counts[c];
+
+        const double estimate = hll_count(hll);
+        ck_assert_msg(fabs(estimate - (double) n) <= tolerance*(double) n,
+            "hll_count() estimate outside of four standard errors");
+    }
+
+    hll_delete(hll);
+}
+END_TEST
+
+START_TEST(test_hll_merge)
+{
+    const uint64_t N_ITEMS = 100000;
+
+    hyperloglog_t* a   = hll_new(12);
+    hyperloglog_t* b   = hll_new(12);
+    hyperloglog_t* all = hll_new(12);
+    ck_assert(a != NULL && b != NULL && all != NULL);
+
+    // two shards of a stream, with overlapping items
+    add_range(a, 0, N_ITEMS / 2 + N_ITEMS / 4);
+    add_range(b, N_ITEMS / 4, N_ITEMS);
+    add_range(all, 0, N_ITEMS);
+
+    ck_assert(hll_merge(a, b));
+
+    // the merged sketch is the sketch of the whole stream
+    ck_assert(0 == memcmp(a->registers, all->registers, a->n_registers));
+    ck_assert(hll_count(a) == hll_count(all));
+
+    hyperloglog_t* other = hll_new(13);
+    ck_assert(other != NULL);
+
+    ck_assert(!hll_merge(a, other));
+    ck_assert(!hll_merge(a, a));
+    ck_assert(!hll_merge(a, NULL));
+    ck_assert(!hll_merge(NULL, a));
+
+    hll_delete(a);
+    hll_delete(b);
+    hll_delete(all);
+    hll_delete(other);
+}
+END_TEST
+
+// ----------------------------------------------------------------------------
+// Infrastructure
+
+Suite* hyperloglog_suite(void)
+{
+    Suite* s = suite_create("hyperloglog");
+    TCase* tc_core = tcase_create("hyperloglog-core");
+
+    tcase_add_test(tc_core, test_hll_new);
+    tcase_add_test(tc_core, test_hll_duplicates);
+    tcase_add_test(tc_core, test_hll_accuracy);
+    tcase_add_test(tc_core, test_hll_merge);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    Suite* suite = hyperloglog_suite();
+    SRunner* runner = srunner_create(suite);
+
+    srunner_run_all(runner, CK_NORMAL);
+    srunner_free(runner);
+
+    return EXIT_SUCCESS;
+}
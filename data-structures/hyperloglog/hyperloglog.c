@@ -0,0 +1,206 @@
+// hyperloglog.c
+// Approximate distinct counts implemented as a HyperLogLog sketch.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "murmur3.h"
+#include "hyperloglog.h"
+
+// The bias-correction constant of the estimator, 1 / (2 ln 2).
+#define ALPHA_INF 0.721347520444481703680
+
+// The greatest register value, for the least precision.
+#define MAX_REGISTER (64 - HLL_MIN_PRECISION + 1)
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+static double sigma(double x);
+static double tau(double x);
+static bool valid_item(byte_t* data, size_t len);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+hyperloglog_t* hll_new(const size_t precision)
+{
+    if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION)
+    {
+        return NULL;
+    }
+
+    hyperloglog_t* hll = malloc(sizeof(hyperloglog_t));
+    if (NULL == hll)
+    {
+        return NULL;
+    }
+
+    const size_t n_registers = (size_t) 1 << precision;
+
+    hll->registers = calloc(n_registers, sizeof(uint8_t));
+    if (NULL == hll->registers)
+    {
+        free(hll);
+        return NULL;
+    }
+
+    hll->precision   = precision;
+    hll->n_registers = n_registers;
+
+    return hll;
+}
+
+void hll_delete(hyperloglog_t* hll)
+{
+    if (hll != NULL)
+    {
+        free(hll->registers);
+        free(hll);
+    }
+}
+
+bool hll_add(hyperloglog_t* hll, byte_t* data, size_t len)
+{
+    if (NULL == hll || !valid_item(data, len))
+    {
+        return false;
+    }
+
+    uint64_t hash[2];
+    MurmurHash3_x64_128(data, (int) len, 0, hash);
+
+    // the first p bits select the register, and the remaining
+    // q = 64 - p bits give the run of leading zeros
+    const size_t   q     = 64 - hll->precision;
+    const size_t   index = (size_t) (hash[0] >> q);
+    const uint64_t rest  = hash[0] << hll->precision;
+
+    const uint8_t rank = (0 == rest) ? (uint8_t) (q + 1) : (uint8_t) (__builtin_clzll(rest) + 1);
+
+    if (rank > hll->registers[index])
+    {
+        hll->registers[index] = rank;
+    }
+
+    return true;
+}
+
+double hll_count(hyperloglog_t* hll)
+{
+    if (NULL == hll)
+    {
+        return 0.0;
+    }
+
+    // the number of registers holding each value
+    size_t histogram[MAX_REGISTER + 1] = { 0 };
+    for (size_t i = 0; i < hll->n_registers; ++i)
+    {
+        histogram[hll->registers[i]]++;
+    }
+
+    const size_t q = 64 - hll->precision;
+    const double m = (double) hll->n_registers;
+
+    // Ertl's improved estimator (Algorithm 6)
+    double z = m*tau(1.0 - (double) histogram[q + 1] / m);
+    for (size_t k = q; k >= 1; --k)
+    {
+        z = 0.5*(z + (double) histogram[k]);
+    }
+
+    z += m*sigma((double) histogram[0] / m);
+
+    return ALPHA_INF*m*m / z;
+}
+
+bool hll_merge(hyperloglog_t* dst, hyperloglog_t* src)
+{
+    if (NULL == dst || NULL == src || dst == src)
+    {
+        return false;
+    }
+
+    if (dst->precision != src->precision)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < dst->n_registers; ++i)
+    {
+        if (src->registers[i] > dst->registers[i])
+        {
+            dst->registers[i] = src->registers[i];
+        }
+    }
+
+    return true;
+}
+
+void hll_clear(hyperloglog_t* hll)
+{
+    if (NULL == hll)
+    {
+        return;
+    }
+
+    memset(hll->registers, 0, hll->n_registers);
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+// The correction for registers still zero: x + sum over k >= 1 of
+// x^(2^k) 2^(k-1), or infinity if every register is zero.
+static double sigma(double x)
+{
+    if (1.0 == x)
+    {
+        return INFINITY;
+    }
+
+    double y = 1.0;
+    double z = x;
+    double previous;
+
+    do
+    {
+        x *= x;
+        previous = z;
+        z += x*y;
+        y += y;
+    } while (z != previous);
+
+    return z;
+}
+
+// The correction for registers at their greatest value:
+// (1 - x - sum over k >= 1 of (1 - x^(2^-k))^2 2^-k) / 3.
+static double tau(double x)
+{
+    if (0.0 == x || 1.0 == x)
+    {
+        return 0.0;
+    }
+
+    double y = 1.0;
+    double z = 1.0 - x;
+    double previous;
+
+    do
+    {
+        x = sqrt(x);
+        previous = z;
+        y *= 0.5;
+        z -= (1.0 - x)*(1.0 - x)*y;
+    } while (z != previous);
+
+    return z / 3.0;
+}
+
+static bool valid_item(byte_t* data, size_t len)
+{
+    return (data != NULL) && (len > 0);
+}
@@ -0,0 +1,463 @@
+// bench.c
+// Throughput benchmark for the priority queue.
+//
+// Pushes n items with random priorities into an empty queue and then
+// pops them all, for n from 1K to 10M, reporting the mean time per
+// push and per pop. The heap is compared against the previous sorted
+// linked-list implementation (reproduced below as list_queue_t), which
+// is quadratic in n and so is only run at the smaller sizes.
+//
+// The bulk benchmark compares building a queue of n items with n calls
+// to queue_push() against queue_from_array(), and emptying it with n
+// calls to queue_pop() against queue_drain_sorted().
+//
+// The monotone benchmark holds n items with integer keys in the queue
+// and repeatedly pops the smallest, then pushes it back with its key
+// advanced by a random amount, as an event simulation would. It
+// compares the heap (with a comparison function on the keys) against
+// the radix heap.
+//
+// Usage:
+//  ./bench [largest number of items]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "radix_heap.h"
+#include "priority_queue.h"
+
+#define DEFAULT_MAX_ITEMS 10000000
+
+// The largest run attempted with the linked-list baseline.
+#define LIST_MAX_ITEMS 10000
+
+// Pop/push pairs in each run of the monotone benchmark,
+// and the largest amount by which a key advances.
+#define N_MONOTONE_OPS  10000000
+#define MAX_KEY_ADVANCE 1000
+
+// ----------------------------------------------------------------------------
+// Baseline: Sorted Linked List
+
+typedef struct list_node
+{
+    struct list_node* next;
+    void*             value;
+} list_node_t;
+
+typedef struct list_queue
+{
+    list_node_t*  head;
+    prioritizer_f prioritizer;
+} list_queue_t;
+
+static list_queue_t* list_queue_new(prioritizer_f prioritizer)
+{
+    list_queue_t* queue = malloc(sizeof(list_queue_t));
+    if (NULL == queue)
+    {
+        return NULL;
+    }
+
+    queue->head        = NULL;
+    queue->prioritizer = prioritizer;
+
+    return queue;
+}
+
+static void list_queue_delete(list_queue_t* queue)
+{
+    free(queue);
+}
+
+static bool list_queue_push(list_queue_t* queue, void* value)
+{
+    list_node_t* node = malloc(sizeof(list_node_t));
+    if (NULL == node)
+    {
+        return false;
+    }
+
+    node->value = value;
+
+    // walk to the first item of no greater priority
+    list_node_t** link = &queue->head;
+    while (*link != NULL && LESS == queue->prioritizer(value, (*link)->value))
+    {
+        link = &(*link)->next;
+    }
+
+    node->next = *link;
+    *link      = node;
+
+    return true;
+}
+
+static void* list_queue_pop(list_queue_t* queue)
+{
+    list_node_t* node = queue->head;
+    if (NULL == node)
+    {
+        return NULL;
+    }
+
+    queue->head = node->next;
+
+    void* value = node->value;
+    free(node);
+
+    return value;
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+typedef struct queue_ops
+{
+    const char* name;
+    void* (*create)(void);
+    void  (*destroy)(void*);
+    bool  (*push)(void*, void*);
+    void* (*pop)(void*);
+} queue_ops_t;
+
+static priority_t int_prioritizer(void* a, void* b)
+{
+    const int as_a = *(int*) a;
+    const int as_b = *(int*) b;
+
+    if (as_a > as_b)
+    {
+        return GREATER;
+    }
+    else if (as_a == as_b)
+    {
+        return EQUAL;
+    }
+    else
+    {
+        return LESS;
+    }
+}
+
+static void* heap_create(void)
+{
+    return queue_new(int_prioritizer, NULL);
+}
+
+static void heap_destroy(void* queue)
+{
+    queue_delete((priority_queue_t*) queue);
+}
+
+static bool heap_push(void* queue, void* value)
+{
+    return queue_push((priority_queue_t*) queue, value);
+}
+
+static void* heap_pop(void* queue)
+{
+    return queue_pop((priority_queue_t*) queue);
+}
+
+static void* list_create(void)
+{
+    return list_queue_new(int_prioritizer);
+}
+
+static void list_destroy(void* queue)
+{
+    list_queue_delete((list_queue_t*) queue);
+}
+
+static bool list_push(void* queue, void* value)
+{
+    return list_queue_push((list_queue_t*) queue, value);
+}
+
+static void* list_pop(void* queue)
+{
+    return list_queue_pop((list_queue_t*) queue);
+}
+
+static const queue_ops_t heap_ops = {
+    "heap", heap_create, heap_destroy, heap_push, heap_pop
+};
+
+static const queue_ops_t list_ops = {
+    "list", list_create, list_destroy, list_push, list_pop
+};
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void run(const queue_ops_t* ops, int* keys, size_t n)
+{
+    void* queue = ops->create();
+    if (NULL == queue)
+    {
+        fprintf(stderr, "%s: create failed\n", ops->name);
+        exit(EXIT_FAILURE);
+    }
+
+    const double push_start = now_seconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!ops->push(queue, &keys[i]))
+        {
+            fprintf(stderr, "%s: push failed\n", ops->name);
+            exit(EXIT_FAILURE);
+        }
+    }
+    const double push_elapsed = now_seconds() - push_start;
+
+    int prev = RAND_MAX;
+
+    const double pop_start = now_seconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int* key = ops->pop(queue);
+        if (NULL == key || *key > prev)
+        {
+            fprintf(stderr, "%s: items popped out of order\n", ops->name);
+            exit(EXIT_FAILURE);
+        }
+
+        prev = *key;
+    }
+    const double pop_elapsed = now_seconds() - pop_start;
+
+    ops->destroy(queue);
+
+    printf("%10zu  %6s  %12.1f  %12.1f\n",
+        n, ops->name, push_elapsed*1e9 / (double) n, pop_elapsed*1e9 / (double) n);
+}
+
+// ----------------------------------------------------------------------------
+// Bulk Operations
+
+static void run_bulk(int* keys, void** items, void** out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        items[i] = &keys[i];
+    }
+
+    // one at a time
+    double start = now_seconds();
+
+    priority_queue_t* queue = queue_new(int_prioritizer, NULL);
+    for (size_t i = 0; i < n; ++i)
+    {
+        queue_push(queue, items[i]);
+    }
+
+    const double push_elapsed = now_seconds() - start;
+    start = now_seconds();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        out[i] = queue_pop(queue);
+    }
+
+    const double pop_elapsed = now_seconds() - start;
+    queue_delete(queue);
+
+    // in bulk
+    start = now_seconds();
+
+    queue = queue_from_array(int_prioritizer, NULL, items, n);
+    if (NULL == queue)
+    {
+        fprintf(stderr, "queue_from_array() failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const double build_elapsed = now_seconds() - start;
+    start = now_seconds();
+
+    if (queue_drain_sorted(queue, out, n) != n)
+    {
+        fprintf(stderr, "queue_drain_sorted() failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const double drain_elapsed = now_seconds() - start;
+    queue_delete(queue);
+
+    for (size_t i = 1; i < n; ++i)
+    {
+        if (*(int*) out[i - 1] < *(int*) out[i])
+        {
+            fprintf(stderr, "items drained out of order\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("%10zu  %12.1f  %12.1f  %12.1f  %12.1f\n",
+        n,
+        push_elapsed*1e9 / (double) n,
+        build_elapsed*1e9 / (double) n,
+        pop_elapsed*1e9 / (double) n,
+        drain_elapsed*1e9 / (double) n);
+}
+
+// ----------------------------------------------------------------------------
+// Monotone Integer Keys
+
+static priority_t min_key_prioritizer(void* a, void* b)
+{
+    const uint64_t as_a = *(uint64_t*) a;
+    const uint64_t as_b = *(uint64_t*) b;
+
+    // smaller keys have higher priority
+    if (as_a < as_b)
+    {
+        return GREATER;
+    }
+    else if (as_a == as_b)
+    {
+        return EQUAL;
+    }
+    else
+    {
+        return LESS;
+    }
+}
+
+static void run_monotone_heap(uint64_t* keys, size_t n)
+{
+    priority_queue_t* queue = queue_new(min_key_prioritizer, NULL);
+    if (NULL == queue)
+    {
+        fprintf(stderr, "heap: create failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    srand(1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        keys[i] = (uint64_t) (rand() % MAX_KEY_ADVANCE);
+        queue_push(queue, &keys[i]);
+    }
+
+    const double start = now_seconds();
+    for (size_t i = 0; i < N_MONOTONE_OPS; ++i)
+    {
+        uint64_t* key = queue_pop(queue);
+        *key += (uint64_t) (rand() % MAX_KEY_ADVANCE);
+        queue_push(queue, key);
+    }
+    const double elapsed = now_seconds() - start;
+
+    queue_delete(queue);
+
+    printf("%10zu  %6s  %12.1f\n", n, "heap", elapsed*1e9 / N_MONOTONE_OPS);
+}
+
+static void run_monotone_radix(size_t n)
+{
+    radix_heap_t* heap = radix_heap_new();
+    if (NULL == heap)
+    {
+        fprintf(stderr, "radix: create failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    srand(1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        radix_heap_push(heap, (uint64_t) (rand() % MAX_KEY_ADVANCE), NULL);
+    }
+
+    const double start = now_seconds();
+    for (size_t i = 0; i < N_MONOTONE_OPS; ++i)
+    {
+        uint64_t key;
+        radix_heap_pop(heap, &key, NULL);
+        radix_heap_push(heap, key + (uint64_t) (rand() % MAX_KEY_ADVANCE), NULL);
+    }
+    const double elapsed = now_seconds() - start;
+
+    radix_heap_delete(heap);
+
+    printf("%10zu  %6s  %12.1f\n", n, "radix", elapsed*1e9 / N_MONOTONE_OPS);
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t max_items = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_MAX_ITEMS;
+
+    int* keys = malloc(max_items*sizeof(int));
+    if (NULL == keys)
+    {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    srand(1);
+    for (size_t i = 0; i < max_items; ++i)
+    {
+        keys[i] = rand();
+    }
+
+    printf("%10s  %6s  %12s  %12s\n", "items", "queue", "push (ns)", "pop (ns)");
+
+    for (size_t n = 1000; n <= max_items; n *= 10)
+    {
+        run(&heap_ops, keys, n);
+        if (n <= LIST_MAX_ITEMS)
+        {
+            run(&list_ops, keys, n);
+        }
+    }
+
+    void** items = malloc(max_items*sizeof(void*));
+    void** out   = malloc(max_items*sizeof(void*));
+    if (NULL == items || NULL == out)
+    {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("\n%10s  %12s  %12s  %12s  %12s\n",
+        "items", "push (ns)", "build (ns)", "pop (ns)", "drain (ns)");
+
+    for (size_t n = 1000; n <= max_items; n *= 10)
+    {
+        run_bulk(keys, items, out, n);
+    }
+
+    free(out);
+    free(items);
+    free(keys);
+
+    uint64_t* held = malloc(max_items*sizeof(uint64_t));
+    if (NULL == held)
+    {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("\n%10s  %6s  %12s\n", "held", "queue", "pop+push (ns)");
+
+    for (size_t n = 1000; n <= max_items; n *= 10)
+    {
+        run_monotone_heap(held, n);
+        run_monotone_radix(n);
+    }
+
+    free(held);
+
+    return EXIT_SUCCESS;
+}
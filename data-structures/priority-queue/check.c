@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#include "radix_heap.h"
 #include "priority_queue.h"
 
 typedef struct point
@@ -127,6 +128,299 @@ START_TEST(test_queue_push_pop)
 }
 END_TEST
 
+START_TEST(test_queue_many)
+{
+    priority_queue_t* queue = queue_new(point_prioritizer, point_deleter);
+    ck_assert_msg(queue != NULL, "queue_new() returned NULL");
+
+    const int n_items = 1000;
+
+    // pseudo-random sums, with duplicates, spanning several array growths
+    srand(1);
+    for (int i = 0; i < n_items; ++i)
+    {
+        ck_assert(queue_push(queue, make_point(rand() % 100, rand() % 100)));
+    }
+
+    int prev_sum = 1000;
+    for (int i = 0; i < n_items; ++i)
+    {
+        point_t* p = (point_t*) queue_pop(queue);
+        ck_assert_msg(p != NULL, "queue_pop() returned NULL before queue empty");
+
+        const int sum = p->x + p->y;
+        ck_assert_msg(sum <= prev_sum, "items popped out of priority order");
+        prev_sum = sum;
+
+        delete_point(p);
+    }
+
+    ck_assert(NULL == queue_pop(queue));
+
+    // items remaining at delete are released with the deleter
+    ck_assert(queue_push(queue, make_point(1, 2)));
+    ck_assert(queue_push(queue, make_point(3, 4)));
+
+    queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_queue_decrease_key)
+{
+    priority_queue_t* queue = queue_new(point_prioritizer, point_deleter);
+    ck_assert_msg(queue != NULL, "queue_new() returned NULL");
+
+    point_t* points[8];
+    queue_handle_t handles[8];
+
+    for (int i = 0; i < 8; ++i)
+    {
+        points[i] = make_point(i, 0);
+        ck_assert(queue_push_handle(queue, points[i], &handles[i]));
+    }
+
+    // promote the lowest priority item to the front
+    points[0]->x = 100;
+    ck_assert(queue_decrease_key(queue, handles[0]));
+
+    // demote the highest priority item to the back
+    points[7]->x = -1;
+    ck_assert(queue_update(queue, handles[7]));
+
+    ck_assert(queue_pop(queue) == points[0]);
+    for (int i = 6; i >= 1; --i)
+    {
+        ck_assert_msg(queue_pop(queue) == points[i], "items popped out of priority order");
+    }
+    ck_assert(queue_pop(queue) == points[7]);
+
+    ck_assert(NULL == queue_pop(queue));
+
+    // handles of items no longer in the queue are rejected
+    ck_assert(!queue_decrease_key(queue, handles[0]));
+    ck_assert(!queue_update(queue, handles[7]));
+
+    for (int i = 0; i < 8; ++i)
+    {
+        delete_point(points[i]);
+    }
+
+    queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_queue_remove)
+{
+    priority_queue_t* queue = queue_new(point_prioritizer, point_deleter);
+    ck_assert_msg(queue != NULL, "queue_new() returned NULL");
+
+    const int n_items = 100;
+
+    point_t* points[100];
+    queue_handle_t handles[100];
+
+    for (int i = 0; i < n_items; ++i)
+    {
+        points[i] = make_point(i, 0);
+        ck_assert(queue_push_handle(queue, points[i], &handles[i]));
+    }
+
+    // remove every odd item from wherever it sits in the heap
+    for (int i = 1; i < n_items; i += 2)
+    {
+        ck_assert(queue_remove(queue, handles[i]) == points[i]);
+        ck_assert_msg(NULL == queue_remove(queue, handles[i]), "item removed twice");
+        delete_point(points[i]);
+    }
+
+    // released handles are reused without disturbing live items
+    for (int i = 1; i < n_items; i += 2)
+    {
+        points[i] = make_point(-i, 0);
+        ck_assert(queue_push_handle(queue, points[i], &handles[i]));
+    }
+
+    for (int i = n_items - 2; i >= 0; i -= 2)
+    {
+        ck_assert_msg(queue_pop(queue) == points[i], "items popped out of priority order");
+        delete_point(points[i]);
+    }
+
+    for (int i = 1; i < n_items; i += 2)
+    {
+        ck_assert_msg(queue_pop(queue) == points[i], "items popped out of priority order");
+        delete_point(points[i]);
+    }
+
+    ck_assert(NULL == queue_pop(queue));
+
+    queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_queue_from_array)
+{
+    const int n_items = 500;
+
+    void* items[500];
+    srand(1);
+    for (int i = 0; i < n_items; ++i)
+    {
+        items[i] = make_point(rand() % 100, rand() % 100);
+    }
+
+    priority_queue_t* queue = queue_from_array(point_prioritizer, point_deleter, items, n_items);
+    ck_assert_msg(queue != NULL, "queue_from_array() returned NULL");
+    ck_assert(n_items == queue_size(queue));
+
+    // the item at index i has handle i
+    point_t* promoted = (point_t*) items[123];
+    promoted->x = 1000;
+    ck_assert(queue_decrease_key(queue, 123));
+
+    void* drained[500];
+    ck_assert(n_items == queue_drain_sorted(queue, drained, n_items));
+    ck_assert(0 == queue_size(queue));
+
+    ck_assert(drained[0] == promoted);
+
+    int prev_sum = 2000;
+    for (int i = 0; i < n_items; ++i)
+    {
+        point_t* p = (point_t*) drained[i];
+        ck_assert_msg(p->x + p->y <= prev_sum, "items drained out of priority order");
+        prev_sum = p->x + p->y;
+        delete_point(p);
+    }
+
+    queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_queue_push_n)
+{
+    priority_queue_t* queue = queue_new(point_prioritizer, point_deleter);
+    ck_assert_msg(queue != NULL, "queue_new() returned NULL");
+
+    // a large batch into an empty queue, then small batches into a full one
+    void* items[300];
+    for (int i = 0; i < 300; ++i)
+    {
+        items[i] = make_point(i % 97, 0);
+    }
+
+    ck_assert(queue_push_n(queue, items, 200));
+    ck_assert(queue_push_n(queue, items + 200, 50));
+    ck_assert(queue_push_n(queue, items + 250, 50));
+    ck_assert(queue_push_n(queue, items, 0));
+    ck_assert(300 == queue_size(queue));
+
+    // a partial drain leaves the remaining items queued
+    void* drained[300];
+    ck_assert(10 == queue_drain_sorted(queue, drained, 10));
+    ck_assert(290 == queue_size(queue));
+    ck_assert(290 == queue_drain_sorted(queue, drained + 10, 300));
+
+    for (int i = 1; i < 300; ++i)
+    {
+        point_t* p = (point_t*) drained[i - 1];
+        point_t* q = (point_t*) drained[i];
+        ck_assert_msg(p->x >= q->x, "items drained out of priority order");
+    }
+
+    for (int i = 0; i < 300; ++i)
+    {
+        delete_point((point_t*) drained[i]);
+    }
+
+    ck_assert(0 == queue_drain_sorted(queue, drained, 300));
+
+    queue_delete(queue);
+}
+END_TEST
+
+START_TEST(test_radix_heap_new)
+{
+    radix_heap_t* heap = radix_heap_new();
+    ck_assert_msg(heap != NULL, "radix_heap_new() returned NULL");
+
+    ck_assert(0 == radix_heap_size(heap));
+    ck_assert(!radix_heap_pop(heap, NULL, NULL));
+
+    radix_heap_delete(heap);
+}
+END_TEST
+
+START_TEST(test_radix_heap_push_pop)
+{
+    radix_heap_t* heap = radix_heap_new();
+    ck_assert_msg(heap != NULL, "radix_heap_new() returned NULL");
+
+    const uint64_t keys[] = { 9, 2, UINT64_MAX, 2, 1000, 0, 65 };
+    const size_t n_keys = sizeof(keys) / sizeof(keys[0]);
+
+    for (size_t i = 0; i < n_keys; ++i)
+    {
+        ck_assert(radix_heap_push(heap, keys[i], (void*) &keys[i]));
+    }
+
+    ck_assert(n_keys == radix_heap_size(heap));
+
+    const uint64_t expected[] = { 0, 2, 2, 9, 65, 1000, UINT64_MAX };
+    for (size_t i = 0; i < n_keys; ++i)
+    {
+        uint64_t key;
+        void* value;
+        ck_assert(radix_heap_pop(heap, &key, &value));
+        ck_assert_msg(key == expected[i], "items popped out of key order");
+        ck_assert_msg(*(const uint64_t*) value == key, "value does not match key");
+    }
+
+    ck_assert(!radix_heap_pop(heap, NULL, NULL));
+
+    radix_heap_delete(heap);
+}
+END_TEST
+
+START_TEST(test_radix_heap_monotone)
+{
+    radix_heap_t* heap = radix_heap_new();
+    ck_assert_msg(heap != NULL, "radix_heap_new() returned NULL");
+
+    // interleave pushes and pops, as in an event simulation
+    srand(1);
+    for (int i = 0; i < 100; ++i)
+    {
+        ck_assert(radix_heap_push(heap, (uint64_t) (rand() % 1000), NULL));
+    }
+
+    uint64_t last = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        uint64_t key;
+        ck_assert(radix_heap_pop(heap, &key, NULL));
+        ck_assert_msg(key >= last, "items popped out of key order");
+        last = key;
+
+        ck_assert(radix_heap_push(heap, key + (uint64_t) (rand() % 1000), NULL));
+    }
+
+    // keys below the last key popped are rejected
+    if (last > 0)
+    {
+        ck_assert(!radix_heap_push(heap, last - 1, NULL));
+    }
+
+    ck_assert(radix_heap_push(heap, last, NULL));
+
+    uint64_t key;
+    ck_assert(radix_heap_pop(heap, &key, NULL));
+    ck_assert(key == last);
+
+    radix_heap_delete(heap);
+}
+END_TEST
+
 // ----------------------------------------------------------------------------
 // Infrastructure
  
@@ -137,6 +431,14 @@ Suite* priority_queue_suite(void)
     
     tcase_add_test(tc_core, test_queue_new);
     tcase_add_test(tc_core, test_queue_push_pop);
+    tcase_add_test(tc_core, test_queue_many);
+    tcase_add_test(tc_core, test_queue_decrease_key);
+    tcase_add_test(tc_core, test_queue_remove);
+    tcase_add_test(tc_core, test_queue_from_array);
+    tcase_add_test(tc_core, test_queue_push_n);
+    tcase_add_test(tc_core, test_radix_heap_new);
+    tcase_add_test(tc_core, test_radix_heap_push_pop);
+    tcase_add_test(tc_core, test_radix_heap_monotone);
     
     suite_add_tcase(s, tc_core);
     
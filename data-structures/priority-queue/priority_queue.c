@@ -1,57 +1,143 @@
 // priority_queue.c
-// Simple linked-list based priority queue.
+// Array-backed indexed d-ary heap priority queue.
 
 #include "priority_queue.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 
+// The number of children of each node in the heap.
+#define HEAP_ARITY 4
+
+// The capacity of the arrays allocated for a new queue.
+#define INITIAL_CAPACITY 16
+
+// Terminates the list of free handles.
+#define NO_HANDLE SIZE_MAX
+
 // ----------------------------------------------------------------------------
-// Exported
+// Internal Declarations
 
-typedef struct queue_node
+// An item in the heap, along with the handle that identifies it.
+typedef struct heap_entry
 {
-    // Linked-list entry.
-    struct queue_node* next;
-
-    // User-provided data.
-    void* value;
-} queue_node_t;
+    void*          value;
+    queue_handle_t handle;
+} heap_entry_t;
 
 struct priority_queue
 {
-    queue_node_t* head;
-    queue_node_t* tail;
+    // The heap, stored implicitly: the children of
+    // the entry at index i are at HEAP_ARITY*i + 1 ...
+    heap_entry_t* entries;
+
+    // Indexed by handle: the position in `entries` of the item with
+    // that handle if it is live, the next free handle otherwise.
+    size_t* positions;
+
+    // The number of items in the heap, and the capacity of both arrays.
+    size_t count;
+    size_t capacity;
+
+    // The number of handles ever issued, and the head of the free list.
+    size_t n_handles;
+    size_t free_handles;
 
     prioritizer_f prioritizer;
     deleter_f     deleter;
 };
 
-static bool queue_is_empty(priority_queue_t* queue);
+static bool reserve(priority_queue_t* queue, size_t count);
+static void heapify(priority_queue_t* queue);
+
+static queue_handle_t acquire_handle(priority_queue_t* queue);
+static void release_handle(priority_queue_t* queue, queue_handle_t handle);
+static bool is_live(priority_queue_t* queue, queue_handle_t handle);
 
-static queue_node_t* new_node(void* value);
-static void delete_node(queue_node_t* node);
+static void* remove_at(priority_queue_t* queue, size_t index);
+
+static size_t sift_up(priority_queue_t* queue, size_t index);
+static void sift_down(priority_queue_t* queue, size_t index);
+static void place(priority_queue_t* queue, size_t index, heap_entry_t entry);
+
+static bool higher_priority(priority_queue_t* queue, void* a, void* b);
 
 // ----------------------------------------------------------------------------
 // Exported
 
 priority_queue_t* queue_new(
-    prioritizer_f prioritizer, 
+    prioritizer_f prioritizer,
     deleter_f     deleter)
 {
+    if (NULL == prioritizer)
+    {
+        return NULL;
+    }
+
     priority_queue_t* queue = malloc(sizeof(priority_queue_t));
     if (NULL == queue)
     {
         return NULL;
     }
 
-    queue->head = NULL;
-    queue->tail = NULL;
+    queue->entries   = malloc(INITIAL_CAPACITY*sizeof(heap_entry_t));
+    queue->positions = malloc(INITIAL_CAPACITY*sizeof(size_t));
+    if (NULL == queue->entries || NULL == queue->positions)
+    {
+        free(queue->entries);
+        free(queue->positions);
+        free(queue);
+        return NULL;
+    }
+
+    queue->count        = 0;
+    queue->capacity     = INITIAL_CAPACITY;
+    queue->n_handles    = 0;
+    queue->free_handles = NO_HANDLE;
 
     queue->prioritizer = prioritizer;
     queue->deleter     = deleter;
 
     return queue;
-}   
+}
+
+priority_queue_t* queue_from_array(
+    prioritizer_f prioritizer,
+    deleter_f     deleter,
+    void*         items[],
+    size_t        n)
+{
+    if (NULL == items && n > 0)
+    {
+        return NULL;
+    }
+
+    priority_queue_t* queue = queue_new(prioritizer, deleter);
+    if (NULL == queue)
+    {
+        return NULL;
+    }
+
+    if (!reserve(queue, n))
+    {
+        queue_delete(queue);
+        return NULL;
+    }
+
+    // the item at index i receives handle i
+    for (size_t i = 0; i < n; ++i)
+    {
+        const heap_entry_t entry = { .value = items[i], .handle = i };
+        place(queue, i, entry);
+    }
+
+    queue->count     = n;
+    queue->n_handles = n;
+
+    heapify(queue);
+
+    return queue;
+}
 
 void queue_delete(priority_queue_t* queue)
 {
@@ -60,71 +146,87 @@ void queue_delete(priority_queue_t* queue)
         return;
     }
 
-    void* value;
-    while ((value = queue_pop(queue)) != NULL)
+    // heap order is irrelevant here, so release items in array order
+    if (queue->deleter != NULL)
     {
-        queue->deleter(value);
+        for (size_t i = 0; i < queue->count; ++i)
+        {
+            queue->deleter(queue->entries[i].value);
+        }
     }
 
+    free(queue->entries);
+    free(queue->positions);
     free(queue);
 }
 
 bool queue_push(priority_queue_t* queue, void* value)
+{
+    return queue_push_handle(queue, value, NULL);
+}
+
+bool queue_push_handle(
+    priority_queue_t* queue,
+    void*             value,
+    queue_handle_t*   handle)
 {
     if (NULL == queue)
     {
         return false;
     }
 
-    queue_node_t* node = new_node(value);
-    if (NULL == node)
+    if (!reserve(queue, queue->count + 1))
     {
         return false;
     }
 
-    if (queue_is_empty(queue))
+    const heap_entry_t entry = { .value = value, .handle = acquire_handle(queue) };
+    place(queue, queue->count, entry);
+    sift_up(queue, queue->count++);
+
+    if (handle != NULL)
     {
-        queue->head = node;
-        queue->tail = node;
-        return true;
+        *handle = entry.handle;
     }
 
-    bool inserted = false;
+    return true;
+}
 
-    queue_node_t* prev = NULL;
-    queue_node_t* curr = queue->head;
-    while (curr != NULL)
+bool queue_push_n(priority_queue_t* queue, void* items[], size_t n)
+{
+    if (NULL == queue || (NULL == items && n > 0))
     {
-        priority_t r = queue->prioritizer(node->value, curr->value);
-        if (GREATER == r || EQUAL == r)
-        {
-            if (NULL == prev)
-            {
-                // insert at the head of the list
-                node->next  = queue->head;
-                queue->head = node;
-            }
-            else
-            {
-                // general case
-                prev->next = node;
-                node->next = curr;
-            }
+        return false;
+    }
 
-            inserted = true;
-            break;
-        }
+    // allocate once, up front, so that either all items are pushed or none
+    if (!reserve(queue, queue->count + n))
+    {
+        return false;
+    }
+
+    // when the batch outnumbers the items already in the queue, rebuilding
+    // the heap in O(count + n) is cheaper than n sifts of O(log count) each
+    const bool rebuild = n > queue->count;
 
-        prev = curr;
-        curr = curr->next;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const heap_entry_t entry = { .value = items[i], .handle = acquire_handle(queue) };
+        place(queue, queue->count, entry);
+
+        if (rebuild)
+        {
+            queue->count++;
+        }
+        else
+        {
+            sift_up(queue, queue->count++);
+        }
     }
 
-    if (!inserted)
+    if (rebuild)
     {
-        // new node is lowest-priority item
-        node->next        = NULL;
-        queue->tail->next = node;
-        queue->tail       = node;
+        heapify(queue);
     }
 
     return true;
@@ -132,54 +234,246 @@ bool queue_push(priority_queue_t* queue, void* value)
 
 void* queue_pop(priority_queue_t* queue)
 {
-    if (NULL == queue || queue_is_empty(queue))
+    if (NULL == queue || 0 == queue->count)
+    {
+        return NULL;
+    }
+
+    return remove_at(queue, 0);
+}
+
+size_t queue_drain_sorted(priority_queue_t* queue, void* items[], size_t n)
+{
+    if (NULL == queue || NULL == items)
+    {
+        return 0;
+    }
+
+    const size_t n_drained = (n < queue->count) ? n : queue->count;
+    for (size_t i = 0; i < n_drained; ++i)
+    {
+        items[i] = remove_at(queue, 0);
+    }
+
+    return n_drained;
+}
+
+size_t queue_size(priority_queue_t* queue)
+{
+    return (NULL == queue) ? 0 : queue->count;
+}
+
+bool queue_decrease_key(priority_queue_t* queue, queue_handle_t handle)
+{
+    if (NULL == queue || !is_live(queue, handle))
     {
         return false;
     }
 
-    queue_node_t* popped = queue->head;
+    sift_up(queue, queue->positions[handle]);
+
+    return true;
+}
 
-    if (queue->tail == popped)
+bool queue_update(priority_queue_t* queue, queue_handle_t handle)
+{
+    if (NULL == queue || !is_live(queue, handle))
     {
-        // a single item in the queue; need to update tail as well
-        queue->head = NULL;
-        queue->tail = NULL;
+        return false;
     }
-    else
+
+    // the item moves in at most one direction
+    const size_t index = queue->positions[handle];
+    if (sift_up(queue, index) == index)
     {
-        // general case
-        queue->head = popped->next;
+        sift_down(queue, index);
     }
 
-    void* tmp = popped->value;
-    delete_node(popped);
+    return true;
+}
+
+void* queue_remove(priority_queue_t* queue, queue_handle_t handle)
+{
+    if (NULL == queue || !is_live(queue, handle))
+    {
+        return NULL;
+    }
 
-    return tmp;
+    return remove_at(queue, queue->positions[handle]);
 }
 
 // ----------------------------------------------------------------------------
 // Internal
 
-static bool queue_is_empty(priority_queue_t* queue)
+static bool reserve(priority_queue_t* queue, size_t count)
 {
-    return (NULL == queue->head) && (NULL == queue->tail);
+    if (count <= queue->capacity)
+    {
+        return true;
+    }
+
+    size_t capacity = 2*queue->capacity;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    heap_entry_t* entries = realloc(queue->entries, capacity*sizeof(heap_entry_t));
+    if (NULL == entries)
+    {
+        return false;
+    }
+
+    queue->entries = entries;
+
+    size_t* positions = realloc(queue->positions, capacity*sizeof(size_t));
+    if (NULL == positions)
+    {
+        return false;
+    }
+
+    queue->positions = positions;
+    queue->capacity  = capacity;
+
+    return true;
 }
 
-static queue_node_t* new_node(void* value)
+static void heapify(priority_queue_t* queue)
 {
-    queue_node_t* node = malloc(sizeof(queue_node_t));
-    if (NULL == node)
+    if (queue->count < 2)
     {
-        return NULL;
+        return;
     }
 
-    node->next  = NULL;
-    node->value = value;
+    // sift down every internal node, from the last one to the root;
+    // most nodes are near the bottom and sift only a short distance
+    size_t index = (queue->count - 2) / HEAP_ARITY + 1;
+    while (index-- > 0)
+    {
+        sift_down(queue, index);
+    }
+}
+
+static queue_handle_t acquire_handle(priority_queue_t* queue)
+{
+    // reuse a released handle if there is one; otherwise every
+    // issued handle is live, so a fresh one is within capacity
+    if (queue->free_handles != NO_HANDLE)
+    {
+        const queue_handle_t handle = queue->free_handles;
+        queue->free_handles = queue->positions[handle];
+        return handle;
+    }
+
+    return queue->n_handles++;
+}
+
+static void release_handle(priority_queue_t* queue, queue_handle_t handle)
+{
+    queue->positions[handle] = queue->free_handles;
+    queue->free_handles      = handle;
+}
+
+static bool is_live(priority_queue_t* queue, queue_handle_t handle)
+{
+    // a free handle may hold any position, but no entry refers to it
+    if (handle >= queue->n_handles)
+    {
+        return false;
+    }
 
-    return node;
+    const size_t index = queue->positions[handle];
+    return index < queue->count && queue->entries[index].handle == handle;
 }
 
-static void delete_node(queue_node_t* node)
+static void* remove_at(priority_queue_t* queue, size_t index)
 {
-    free(node);
-}
\ No newline at end of file
+    const heap_entry_t removed = queue->entries[index];
+    release_handle(queue, removed.handle);
+
+    // move the last item into the hole and restore the heap property
+    if (--queue->count > index)
+    {
+        place(queue, index, queue->entries[queue->count]);
+        if (sift_up(queue, index) == index)
+        {
+            sift_down(queue, index);
+        }
+    }
+
+    return removed.value;
+}
+
+static size_t sift_up(priority_queue_t* queue, size_t index)
+{
+    heap_entry_t*      entries = queue->entries;
+    const heap_entry_t entry   = entries[index];
+
+    // shift lower-priority ancestors down into the hole, then fill it
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / HEAP_ARITY;
+        if (!higher_priority(queue, entry.value, entries[parent].value))
+        {
+            break;
+        }
+
+        place(queue, index, entries[parent]);
+        index = parent;
+    }
+
+    place(queue, index, entry);
+
+    return index;
+}
+
+static void sift_down(priority_queue_t* queue, size_t index)
+{
+    heap_entry_t*      entries = queue->entries;
+    const heap_entry_t entry   = entries[index];
+    const size_t       count   = queue->count;
+
+    for (;;)
+    {
+        const size_t first = HEAP_ARITY*index + 1;
+        if (first >= count)
+        {
+            break;
+        }
+
+        const size_t last = (first + HEAP_ARITY < count)
+            ? first + HEAP_ARITY
+            : count;
+
+        // find the highest priority child
+        size_t best = first;
+        for (size_t child = first + 1; child < last; ++child)
+        {
+            if (higher_priority(queue, entries[child].value, entries[best].value))
+            {
+                best = child;
+            }
+        }
+
+        if (!higher_priority(queue, entries[best].value, entry.value))
+        {
+            break;
+        }
+
+        place(queue, index, entries[best]);
+        index = best;
+    }
+
+    place(queue, index, entry);
+}
+
+static void place(priority_queue_t* queue, size_t index, heap_entry_t entry)
+{
+    queue->entries[index] = entry;
+    queue->positions[entry.handle] = index;
+}
+
+static bool higher_priority(priority_queue_t* queue, void* a, void* b)
+{
+    return GREATER == queue->prioritizer(a, b);
+}
@@ -1,13 +1,32 @@
 // priority_queue.h
-// Simple linked-list based priority queue.
+// Array-backed indexed d-ary heap priority queue.
+//
+// Items are kept in an implicit 4-ary heap ordered by the user-provided
+// priority function, so push and pop each take O(log n) comparisons and
+// the queue performs no per-item allocation. Items of equal priority are
+// popped in an unspecified order.
+//
+// The heap is indexed: every item in the queue is identified by a handle,
+// through which its position in the heap can be found in constant time.
+// This allows an item whose priority has changed to be moved to its new
+// position, and an arbitrary item to be removed, in O(log n). Algorithms
+// such as Dijkstra's shortest paths can therefore update an item in place
+// rather than pushing a duplicate and discarding stale entries as they
+// are popped, which bounds the size of the queue by the number of live
+// items rather than by the number of updates.
 
 #ifndef PRIORITY_QUEUE_H
 #define PRIORITY_QUEUE_H
 
+#include <stddef.h>
 #include <stdbool.h>
 
 typedef struct priority_queue priority_queue_t;
 
+// Identifies an item in the queue; valid from the push that returns it
+// until the item leaves the queue, after which it may be reused.
+typedef size_t queue_handle_t;
+
 // The type returned by the user-provided priority function.
 typedef enum priority
 {
@@ -32,11 +51,34 @@ typedef void (*deleter_f)(void*);
 //
 // Returns:
 //  A pointer to a newly constructed priority queue on success
-//  NULL on failure
+//  NULL on failure (invalid argument, allocation failure)
 priority_queue_t* queue_new(
     prioritizer_f prioritizer, 
     deleter_f     deleter);
 
+// queue_from_array()
+//
+// Construct a new priority queue holding the items of an existing array.
+//
+// The heap is built in O(n) comparisons, rather than the O(n log n) of
+// n calls to queue_push(). The item at index i of the array receives
+// handle i. The array itself is not retained by the queue.
+//
+// Arguments:
+//  prioritizer - the function used to relative priority of items in the queue
+//  deleter     - the function used to destroy items in the queue during delete
+//  items       - the array of items to insert into the queue
+//  n           - the number of items in the array
+//
+// Returns:
+//  A pointer to a newly constructed priority queue on success
+//  NULL on failure (invalid argument, allocation failure)
+priority_queue_t* queue_from_array(
+    prioritizer_f prioritizer,
+    deleter_f     deleter,
+    void*         items[],
+    size_t        n);
+
 // queue_delete()
 //
 // Destroy an existing priority queue.
@@ -58,6 +100,42 @@ void queue_delete(priority_queue_t* queue);
 //  `false` otherwise (allocation failure)
 bool queue_push(priority_queue_t* queue, void* value);
 
+// queue_push_handle()
+//
+// Insert an item into the priority queue, returning its handle.
+//
+// Arguments:
+//  queue  - pointer to priority queue instance
+//  value  - the item to insert into the queue
+//  handle - set to the handle of the inserted item on success (may be NULL)
+//
+// Returns:
+//  `true` on successful addition of the item to the queue
+//  `false` otherwise (invalid argument, allocation failure)
+bool queue_push_handle(
+    priority_queue_t* queue,
+    void*             value,
+    queue_handle_t*   handle);
+
+// queue_push_n()
+//
+// Insert a batch of items into the priority queue.
+//
+// Storage for the batch is allocated once, and if the batch is larger
+// than the queue, the heap is rebuilt in linear time rather than
+// inserting each item in turn.
+//
+// Arguments:
+//  queue - pointer to priority queue instance
+//  items - the array of items to insert into the queue
+//  n     - the number of items in the array
+//
+// Returns:
+//  `true` on successful addition of all items to the queue
+//  `false` otherwise, in which case no items are added
+//  (invalid argument, allocation failure)
+bool queue_push_n(priority_queue_t* queue, void* items[], size_t n);
+
 // queue_pop()
 //
 // Remove the highest priority item from the queue.
@@ -70,4 +148,77 @@ bool queue_push(priority_queue_t* queue, void* value);
 //  NULL on failure (invalid argument, empty queue)
 void* queue_pop(priority_queue_t* queue);
 
+// queue_drain_sorted()
+//
+// Remove the highest priority items from the queue, in priority order.
+//
+// Arguments:
+//  queue - pointer to priority queue instance
+//  items - the array to which removed items are written, highest first
+//  n     - the capacity of the array; to drain the entire queue,
+//          provide an array of at least queue_size() items
+//
+// Returns:
+//  The number of items removed, which is the smaller of
+//  `n` and the number of items in the queue
+//  0 on failure (invalid argument)
+size_t queue_drain_sorted(priority_queue_t* queue, void* items[], size_t n);
+
+// queue_size()
+//
+// Return the number of items in the queue.
+//
+// Arguments:
+//  queue - pointer to priority queue instance
+//
+// Returns:
+//  The number of items in the queue, 0 on invalid argument
+size_t queue_size(priority_queue_t* queue);
+
+// queue_decrease_key()
+//
+// Restore the position of an item whose priority has increased.
+//
+// The caller modifies the item such that the priority function ranks it
+// higher than before (in a min-queue of distances, its key decreases),
+// and then calls this function to move it towards the front of the queue.
+//
+// Arguments:
+//  queue  - pointer to priority queue instance
+//  handle - the handle of the modified item
+//
+// Returns:
+//  `true` on success
+//  `false` on failure (invalid argument, item not in queue)
+bool queue_decrease_key(priority_queue_t* queue, queue_handle_t handle);
+
+// queue_update()
+//
+// Restore the position of an item whose priority has changed.
+//
+// As queue_decrease_key(), but the priority of the item may
+// have changed in either direction.
+//
+// Arguments:
+//  queue  - pointer to priority queue instance
+//  handle - the handle of the modified item
+//
+// Returns:
+//  `true` on success
+//  `false` on failure (invalid argument, item not in queue)
+bool queue_update(priority_queue_t* queue, queue_handle_t handle);
+
+// queue_remove()
+//
+// Remove an arbitrary item from the queue.
+//
+// Arguments:
+//  queue  - pointer to priority queue instance
+//  handle - the handle of the item to remove
+//
+// Returns:
+//  A pointer to the item removed from the queue on success
+//  NULL on failure (invalid argument, item not in queue)
+void* queue_remove(priority_queue_t* queue, queue_handle_t handle);
+
 #endif // PRIORITY_QUEUE_H
\ No newline at end of file
@@ -0,0 +1,244 @@
+// radix_heap.c
+// Monotone integer-keyed priority queue (radix heap).
+
+#include <stdlib.h>
+
+#include "radix_heap.h"
+
+// One bucket for keys equal to the last key, and one per bit position.
+#define N_BUCKETS 65
+
+// The capacity of a bucket when it first receives an item.
+#define INITIAL_BUCKET_CAPACITY 8
+
+// ----------------------------------------------------------------------------
+// Internal Declarations
+
+typedef struct radix_entry
+{
+    uint64_t key;
+    void*    value;
+} radix_entry_t;
+
+// A growable array of entries; capacity is
+// retained when the bucket is emptied.
+typedef struct radix_bucket
+{
+    radix_entry_t* entries;
+    size_t         count;
+    size_t         capacity;
+} radix_bucket_t;
+
+struct radix_heap
+{
+    radix_bucket_t buckets[N_BUCKETS];
+
+    // The key of the last item popped, against which buckets are assigned.
+    uint64_t last;
+
+    // The total number of items in the heap.
+    size_t count;
+};
+
+static size_t bucket_index(uint64_t key, uint64_t last);
+static bool bucket_reserve(radix_bucket_t* bucket, size_t count);
+static bool bucket_append(radix_bucket_t* bucket, uint64_t key, void* value);
+static bool redistribute(radix_heap_t* heap);
+
+// ----------------------------------------------------------------------------
+// Exported
+
+radix_heap_t* radix_heap_new(void)
+{
+    radix_heap_t* heap = malloc(sizeof(radix_heap_t));
+    if (NULL == heap)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < N_BUCKETS; ++i)
+    {
+        heap->buckets[i].entries  = NULL;
+        heap->buckets[i].count    = 0;
+        heap->buckets[i].capacity = 0;
+    }
+
+    heap->last  = 0;
+    heap->count = 0;
+
+    return heap;
+}
+
+void radix_heap_delete(radix_heap_t* heap)
+{
+    if (NULL == heap)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < N_BUCKETS; ++i)
+    {
+        free(heap->buckets[i].entries);
+    }
+
+    free(heap);
+}
+
+bool radix_heap_push(radix_heap_t* heap, uint64_t key, void* value)
+{
+    if (NULL == heap || key < heap->last)
+    {
+        return false;
+    }
+
+    radix_bucket_t* bucket = &heap->buckets[bucket_index(key, heap->last)];
+    if (!bucket_append(bucket, key, value))
+    {
+        return false;
+    }
+
+    heap->count++;
+
+    return true;
+}
+
+bool radix_heap_pop(radix_heap_t* heap, uint64_t* key, void** value)
+{
+    if (NULL == heap || 0 == heap->count)
+    {
+        return false;
+    }
+
+    if (0 == heap->buckets[0].count && !redistribute(heap))
+    {
+        return false;
+    }
+
+    // every item in bucket 0 has the last key; take any of them
+    radix_bucket_t* bucket = &heap->buckets[0];
+    const radix_entry_t* entry = &bucket->entries[--bucket->count];
+
+    if (key != NULL)
+    {
+        *key = entry->key;
+    }
+
+    if (value != NULL)
+    {
+        *value = entry->value;
+    }
+
+    heap->count--;
+
+    return true;
+}
+
+size_t radix_heap_size(radix_heap_t* heap)
+{
+    return (NULL == heap) ? 0 : heap->count;
+}
+
+// ----------------------------------------------------------------------------
+// Internal
+
+static size_t bucket_index(uint64_t key, uint64_t last)
+{
+    // one plus the position of the highest bit in which key and last differ
+    const uint64_t diff = key ^ last;
+    return (0 == diff) ? 0 : (size_t) (64 - __builtin_clzll(diff));
+}
+
+static bool bucket_reserve(radix_bucket_t* bucket, size_t count)
+{
+    if (count <= bucket->capacity)
+    {
+        return true;
+    }
+
+    size_t capacity = (0 == bucket->capacity)
+        ? INITIAL_BUCKET_CAPACITY
+        : 2*bucket->capacity;
+
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    radix_entry_t* entries = realloc(bucket->entries, capacity*sizeof(radix_entry_t));
+    if (NULL == entries)
+    {
+        return false;
+    }
+
+    bucket->entries  = entries;
+    bucket->capacity = capacity;
+
+    return true;
+}
+
+static bool bucket_append(radix_bucket_t* bucket, uint64_t key, void* value)
+{
+    if (!bucket_reserve(bucket, bucket->count + 1))
+    {
+        return false;
+    }
+
+    bucket->entries[bucket->count].key   = key;
+    bucket->entries[bucket->count].value = value;
+    bucket->count++;
+
+    return true;
+}
+
+static bool redistribute(radix_heap_t* heap)
+{
+    // find the lowest non-empty bucket; the heap is not empty, so one exists
+    size_t i = 1;
+    while (0 == heap->buckets[i].count)
+    {
+        ++i;
+    }
+
+    radix_bucket_t* bucket = &heap->buckets[i];
+
+    uint64_t min = bucket->entries[0].key;
+    for (size_t j = 1; j < bucket->count; ++j)
+    {
+        if (bucket->entries[j].key < min)
+        {
+            min = bucket->entries[j].key;
+        }
+    }
+
+    // size the target buckets up front, so that a failure to grow one
+    // leaves the heap as it was rather than partially redistributed
+    size_t counts[N_BUCKETS] = { 0 };
+    for (size_t j = 0; j < bucket->count; ++j)
+    {
+        counts[bucket_index(bucket->entries[j].key, min)]++;
+    }
+
+    for (size_t b = 0; b < i; ++b)
+    {
+        if (!bucket_reserve(&heap->buckets[b], heap->buckets[b].count + counts[b]))
+        {
+            return false;
+        }
+    }
+
+    heap->last = min;
+
+    // every item now shares more high-order bits with the last key, so it
+    // moves to a strictly lower bucket
+    for (size_t j = 0; j < bucket->count; ++j)
+    {
+        const radix_entry_t* entry = &bucket->entries[j];
+        radix_bucket_t* target = &heap->buckets[bucket_index(entry->key, min)];
+
+        target->entries[target->count++] = *entry;
+    }
+
+    bucket->count = 0;
+
+    return true;
+}
@@ -0,0 +1,104 @@
+// radix_heap.h
+// Monotone integer-keyed priority queue (radix heap).
+
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Background:
+//
+// The general-purpose priority queue (see priority_queue.h) orders
+// arbitrary items with a user-provided priority function, and so makes
+// O(log n) indirect calls to that function per push and pop. Many uses
+// of a priority queue need much less generality than that: priorities
+// are non-negative integers (timestamps, path lengths), and the queue
+// is monotone, meaning that no item is ever pushed with a key smaller
+// than that of the last item popped. Event simulation and Dijkstra's
+// algorithm with non-negative edge weights both have this property.
+//
+// A radix heap exploits monotonicity to avoid comparisons entirely.
+// Items are kept in 65 buckets according to the most significant bit
+// in which their key differs from the last key popped: bucket 0 holds
+// items whose key equals the last key, and bucket i holds items whose
+// keys first differ from it in bit i - 1. Since keys never fall below
+// the last key popped, the buckets are ordered: every key in bucket i
+// is smaller than every key in bucket j > i.
+//
+// Popping from bucket 0 is therefore trivial. When bucket 0 is empty,
+// the lowest non-empty bucket is located and the smallest key within
+// it becomes the new last key; each of its items is then redistributed
+// into a strictly lower bucket, since it now agrees with the last key
+// in at least one more high-order bit. An item can thus move at most 64
+// times over its lifetime, giving O(1) amortized push and pop for a
+// fixed key width, with the work consisting of a scan and a few bit
+// operations rather than calls through a function pointer.
+//
+// This queue pops the item with the smallest key first.
+
+// The radix heap.
+typedef struct radix_heap radix_heap_t;
+
+// radix_heap_new()
+//
+// Construct a new, empty radix heap.
+//
+// Returns:
+//  A pointer to a newly constructed radix heap on success
+//  NULL on failure (allocation failure)
+radix_heap_t* radix_heap_new(void);
+
+// radix_heap_delete()
+//
+// Destroy an existing radix heap.
+//
+// Values remaining in the heap are not owned by it, and are not released.
+//
+// Arguments:
+//  heap - pointer to an existing radix heap
+void radix_heap_delete(radix_heap_t* heap);
+
+// radix_heap_push()
+//
+// Insert an item into the radix heap.
+//
+// Arguments:
+//  heap  - pointer to an existing radix heap
+//  key   - the priority of the item; must not be less than the
+//          key of the last item popped from the heap
+//  value - the item to insert
+//
+// Returns:
+//  `true` on successful addition of the item to the heap
+//  `false` otherwise (invalid argument, key below the
+//  last key popped, allocation failure)
+bool radix_heap_push(radix_heap_t* heap, uint64_t key, void* value);
+
+// radix_heap_pop()
+//
+// Remove the item with the smallest key from the radix heap.
+//
+// Arguments:
+//  heap  - pointer to an existing radix heap
+//  key   - set to the key of the removed item (may be NULL)
+//  value - set to the removed item (may be NULL)
+//
+// Returns:
+//  `true` if an item was removed
+//  `false` on failure (invalid argument, empty heap, allocation failure)
+bool radix_heap_pop(radix_heap_t* heap, uint64_t* key, void** value);
+
+// radix_heap_size()
+//
+// Return the number of items in the radix heap.
+//
+// Arguments:
+//  heap - pointer to an existing radix heap
+//
+// Returns:
+//  The number of items in the heap, 0 on invalid argument
+size_t radix_heap_size(radix_heap_t* heap);
+
+#endif // RADIX_HEAP_H
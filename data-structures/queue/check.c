@@ -87,6 +87,53 @@ START_TEST(test_queue_0)
 }
 END_TEST
 
+START_TEST(test_queue_chunks)
+{
+    queue_t* queue = queue_new(point_deleter);
+    ck_assert_msg(queue != NULL, "queue_new() returned NULL");
+
+    // enough items to span several chunks, with pops interleaved
+    // so that the head and tail cross chunk boundaries separately
+    const int n_items = 2000;
+
+    int next_pop = 0;
+    for (int i = 0; i < n_items; ++i)
+    {
+        ck_assert(queue_push(queue, make_point((float) i, 0.0)));
+
+        if (i % 3 == 0)
+        {
+            point_t* out = (point_t*) queue_pop(queue);
+            ck_assert(out != NULL);
+            ck_assert_msg(out->x == (float) next_pop++, "items popped out of FIFO order");
+            delete_point(out);
+        }
+    }
+
+    while (next_pop < n_items)
+    {
+        point_t* out = (point_t*) queue_pop(queue);
+        ck_assert(out != NULL);
+        ck_assert_msg(out->x == (float) next_pop++, "items popped out of FIFO order");
+        delete_point(out);
+    }
+
+    ck_assert(NULL == queue_pop(queue));
+
+    // the queue remains usable once drained, and deletes the items it holds
+    for (int i = 0; i < 600; ++i)
+    {
+        ck_assert(queue_push(queue, make_point((float) i, 0.0)));
+    }
+
+    point_t* out = (point_t*) queue_pop(queue);
+    ck_assert(out != NULL && 0.0 == out->x);
+    delete_point(out);
+
+    queue_delete(queue);
+}
+END_TEST
+
 // ----------------------------------------------------------------------------
 // Infrastructure
  
@@ -96,6 +143,7 @@ Suite* queue_suite(void)
     TCase* tc_core = tcase_create("queue-core");
     
     tcase_add_test(tc_core, test_queue_0);
+    tcase_add_test(tc_core, test_queue_chunks);
     
     suite_add_tcase(s, tc_core);
     
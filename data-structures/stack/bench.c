@@ -0,0 +1,238 @@
+// bench.c
+// Depth-first traversal benchmark for the stack.
+//
+// Traverses random trees depth-first with an explicit stack: each
+// popped node pushes between 0 and MAX_CHILDREN children, and a new
+// tree is started whenever the stack empties, until n nodes have been
+// pushed in all. Every implementation sees the same sequence of
+// operations, as the matching checksums confirm.
+//
+// The array stack is compared against the previous linked-list
+// implementation (reproduced below as list_stack_t), which allocates
+// a node per push and frees it per pop. The array stack is run pushing
+// children one at a time with stack_push() and all at once with
+// stack_push_n(), each twice on the same stack: the first (cold) run
+// includes the growth of the array, and the second (warm) run, which
+// reuses it, performs no allocation.
+//
+// Usage:
+//  ./bench [nodes pushed]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "stack.h"
+
+#define DEFAULT_N_PUSHES 10000000
+
+// The most children of any node; with a mean of one child per node,
+// the trees are (critically) large, and the stack grows deep.
+#define MAX_CHILDREN 2
+
+// ----------------------------------------------------------------------------
+// Baseline: Linked List
+
+typedef struct list_item
+{
+    struct list_item* below;
+    void*             data;
+} list_item_t;
+
+typedef struct list_stack
+{
+    size_t       count;
+    list_item_t* top;
+} list_stack_t;
+
+static bool list_push(list_stack_t* stack, void* data)
+{
+    list_item_t* item = malloc(sizeof(list_item_t));
+    if (NULL == item)
+    {
+        return false;
+    }
+
+    item->data  = data;
+    item->below = stack->top;
+
+    stack->top = item;
+    stack->count++;
+
+    return true;
+}
+
+static void* list_pop(list_stack_t* stack)
+{
+    list_item_t* popped = stack->top;
+
+    stack->top = popped->below;
+    stack->count--;
+
+    void* data = popped->data;
+    free(popped);
+
+    return data;
+}
+
+// ----------------------------------------------------------------------------
+// Harness
+
+typedef enum variant
+{
+    LIST,
+    ARRAY_PUSH,
+    ARRAY_PUSH_N
+} variant_t;
+
+static uint64_t next_random(uint64_t* state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void fail(const char* message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+static void run(const char* name, variant_t variant, lstack_t* stack, size_t n_pushes)
+{
+    list_stack_t list = { .count = 0, .top = NULL };
+
+    uint64_t rng = 1;
+    uint64_t checksum = 0;
+    size_t   n_pushed = 0;
+    size_t   max_depth = 0;
+
+    void* children[MAX_CHILDREN];
+
+    const double start = now_seconds();
+
+    while (n_pushed < n_pushes)
+    {
+        // the stack is empty; start a new tree at a fresh root
+        uintptr_t node = n_pushed + 1;
+
+        for (;;)
+        {
+            checksum += node;
+
+            const size_t n_children = next_random(&rng) % (MAX_CHILDREN + 1);
+            for (size_t i = 0; i < n_children; ++i)
+            {
+                children[i] = (void*) (uintptr_t) (n_pushed + i + 1);
+            }
+
+            n_pushed += n_children;
+
+            bool pushed = true;
+            switch (variant)
+            {
+            case LIST:
+                for (size_t i = 0; i < n_children; ++i)
+                {
+                    pushed = pushed && list_push(&list, children[i]);
+                }
+                break;
+            case ARRAY_PUSH:
+                for (size_t i = 0; i < n_children; ++i)
+                {
+                    pushed = pushed && stack_push(stack, children[i]);
+                }
+                break;
+            case ARRAY_PUSH_N:
+                pushed = stack_push_n(stack, children, n_children);
+                break;
+            }
+
+            if (!pushed)
+            {
+                fail("push failed");
+            }
+
+            const size_t depth = (LIST == variant) ? list.count : stack_count(stack);
+            if (depth > max_depth)
+            {
+                max_depth = depth;
+            }
+
+            if (0 == depth || n_pushed >= n_pushes)
+            {
+                break;
+            }
+
+            node = (uintptr_t) ((LIST == variant) ? list_pop(&list) : stack_pop(stack));
+        }
+
+        // abandon whatever remains once enough nodes have been pushed
+        while (list.count > 0)
+        {
+            list_pop(&list);
+        }
+
+        while (stack_count(stack) > 0)
+        {
+            stack_pop(stack);
+        }
+    }
+
+    const double elapsed = now_seconds() - start;
+
+    printf("%-14s  %10zu  %10zu  %10.3f  %10.2f  %18llu\n",
+        name, n_pushed, max_depth, elapsed, elapsed*1e9 / (double) n_pushed,
+        (unsigned long long) checksum);
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t n_pushes = (argc > 1)
+        ? strtoul(argv[1], NULL, 10)
+        : DEFAULT_N_PUSHES;
+
+    printf("%-14s  %10s  %10s  %10s  %10s  %18s\n",
+        "stack", "pushes", "max depth", "seconds", "ns/push", "checksum");
+
+    run("list", LIST, NULL, n_pushes);
+
+    lstack_t* stack = stack_new();
+    if (NULL == stack)
+    {
+        fail("allocation failed");
+    }
+
+    run("push (cold)", ARRAY_PUSH, stack, n_pushes);
+    run("push (warm)", ARRAY_PUSH, stack, n_pushes);
+
+    stack_delete(stack);
+
+    stack = stack_new();
+    if (NULL == stack)
+    {
+        fail("allocation failed");
+    }
+
+    run("push_n (cold)", ARRAY_PUSH_N, stack, n_pushes);
+    run("push_n (warm)", ARRAY_PUSH_N, stack, n_pushes);
+
+    stack_delete(stack);
+
+    return EXIT_SUCCESS;
+}
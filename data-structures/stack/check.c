@@ -150,6 +150,80 @@ START_TEST(test_stack_peek)
 }
 END_TEST
 
+START_TEST(test_stack_growth)
+{
+    const size_t N_PUSHED = 100000;
+
+    lstack_t* s = stack_new();
+    ck_assert_msg(s != NULL, "stack_new() returned NULL");
+
+    // beyond the inline storage, through many doublings
+    for (size_t i = 0; i < N_PUSHED; ++i)
+    {
+        const bool pushed = stack_push(s, (void*) (i + 1));
+        ck_assert_msg(pushed, "stack_push() failed");
+        ck_assert(stack_peek(s) == (void*) (i + 1));
+    }
+
+    ck_assert(stack_count(s) == N_PUSHED);
+
+    for (size_t i = N_PUSHED; i > 0; --i)
+    {
+        ck_assert_msg(stack_pop(s) == (void*) i, "stack_pop() returned unexpected data");
+    }
+
+    ck_assert(stack_pop(s) == NULL);
+
+    // reserved capacity is retained
+    ck_assert(stack_reserve(s, 1000));
+    ck_assert(s->capacity >= 1000);
+    ck_assert(!stack_reserve(NULL, 1));
+
+    const bool deleted = stack_delete(s);
+    ck_assert_msg(deleted, "stack_delete() on empty stack failed");
+}
+END_TEST
+
+START_TEST(test_stack_push_n_pop_n)
+{
+    void* items[100];
+    for (size_t i = 0; i < 100; ++i)
+    {
+        items[i] = (void*) (i + 1);
+    }
+
+    lstack_t* s = stack_new();
+    ck_assert_msg(s != NULL, "stack_new() returned NULL");
+
+    ck_assert(stack_push_n(s, items, 0));
+    ck_assert(!stack_push_n(NULL, items, 1));
+    ck_assert(!stack_push_n(s, NULL, 1));
+
+    // the last item pushed is on top
+    ck_assert(stack_push_n(s, items, 3));
+    ck_assert(stack_push_n(s, items + 3, 97));
+    ck_assert(stack_count(s) == 100);
+    ck_assert(stack_peek(s) == (void*) 100);
+
+    // items are popped in the order stack_pop() returns them
+    void* popped[100];
+    ck_assert(stack_pop_n(s, popped, 10) == 10);
+    for (size_t i = 0; i < 10; ++i)
+    {
+        ck_assert_msg(popped[i] == (void*) (100 - i), "stack_pop_n() returned unexpected data");
+    }
+
+    // popping more than remain pops what there is
+    ck_assert(stack_pop_n(s, popped, 100) == 90);
+    ck_assert(popped[0] == (void*) 90 && popped[89] == (void*) 1);
+    ck_assert(stack_pop_n(s, popped, 1) == 0);
+    ck_assert(stack_count(s) == 0);
+
+    const bool deleted = stack_delete(s);
+    ck_assert_msg(deleted, "stack_delete() on empty stack failed");
+}
+END_TEST
+
 // ----------------------------------------------------------------------------
 // Infrastructure
  
@@ -162,6 +236,8 @@ Suite* stack_suite(void)
     tcase_add_test(tc_core, test_stack_delete);
     tcase_add_test(tc_core, test_stack_push_pop);
     tcase_add_test(tc_core, test_stack_peek);
+    tcase_add_test(tc_core, test_stack_growth);
+    tcase_add_test(tc_core, test_stack_push_n_pop_n);
     
     suite_add_tcase(s, tc_core);
     
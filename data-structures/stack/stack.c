@@ -2,26 +2,16 @@
 // Generic stack (last in, first out) data structure.
 
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "stack.h"
 
-// ----------------------------------------------------------------------------
-// Internal Types
-
-// An individual item on the stack.
-typedef struct stack_item
-{
-    // A pointer to the item below this on the stack.
-    struct stack_item* below;
-    
-    // A pointer to arbitrary user-provided data.
-    void* data;
-} stack_item_t;
-
 // ----------------------------------------------------------------------------
 // Internal Prototypes
 
-static stack_item_t* new_item(void* data);
+static bool grow(lstack_t* stack, size_t required);
+static bool is_inline(lstack_t* stack);
 
 // ----------------------------------------------------------------------------
 // Exported
@@ -34,8 +24,9 @@ lstack_t* stack_new(void)
         return NULL;
     }
 
-    stack->top   = NULL;
-    stack->count = 0;
+    stack->count    = 0;
+    stack->capacity = STACK_INLINE_CAPACITY;
+    stack->items    = stack->inline_items;
 
     return stack;
 }
@@ -48,6 +39,11 @@ bool stack_delete(lstack_t* stack)
     }
 
     // the stack is empty, safe to delete
+    if (!is_inline(stack))
+    {
+        free(stack->items);
+    }
+
     free(stack);
     stack = NULL;
 
@@ -61,16 +57,38 @@ bool stack_push(lstack_t* stack, void* data)
         return false;
     }
 
-    stack_item_t* item = new_item(data);
-    if (NULL == item)
+    if (stack->count == stack->capacity && !grow(stack, stack->count + 1))
     {
         return false;
     }
 
-    item->below = stack->top;
+    stack->items[stack->count++] = data;
 
-    stack->top = item;
-    stack->count++;
+    return true;
+}
+
+bool stack_push_n(lstack_t* stack, void* items[], size_t n)
+{
+    if (NULL == stack || (NULL == items && n > 0))
+    {
+        return false;
+    }
+
+    if (n > SIZE_MAX - stack->count)
+    {
+        return false;
+    }
+
+    if (stack->count + n > stack->capacity && !grow(stack, stack->count + n))
+    {
+        return false;
+    }
+
+    if (n > 0)
+    {
+        memcpy(stack->items + stack->count, items, n*sizeof(void*));
+        stack->count += n;
+    }
 
     return true;
 }
@@ -82,16 +100,28 @@ void* stack_pop(lstack_t* stack)
         return NULL;
     }
 
-    stack_item_t* popped = stack->top;
+    return stack->items[--stack->count];
+}
 
-    stack->top = popped->below;
-    stack->count--;
+size_t stack_pop_n(lstack_t* stack, void* items[], size_t n)
+{
+    if (NULL == stack || NULL == items)
+    {
+        return 0;
+    }
 
-    void* data = popped->data;
+    const size_t n_popped = (n < stack->count) ? n : stack->count;
 
-    free(popped);
+    // the top of the stack is popped first
+    void** top = stack->items + stack->count;
+    for (size_t i = 0; i < n_popped; ++i)
+    {
+        items[i] = *--top;
+    }
 
-    return data;
+    stack->count -= n_popped;
+
+    return n_popped;
 }
 
 void* stack_peek(lstack_t* stack)
@@ -101,25 +131,68 @@ void* stack_peek(lstack_t* stack)
         return NULL;
     }
 
-    return stack->top->data;
+    return stack->items[stack->count - 1];
 }
 
 size_t stack_count(lstack_t* stack)
 {
-    return (NULL == stack) ? 0 : stack->count; 
+    return (NULL == stack) ? 0 : stack->count;
+}
+
+bool stack_reserve(lstack_t* stack, size_t capacity)
+{
+    if (NULL == stack)
+    {
+        return false;
+    }
+
+    return (capacity <= stack->capacity) || grow(stack, capacity);
 }
 
 // ----------------------------------------------------------------------------
 // Internal
 
-static stack_item_t* new_item(void* data)
+static bool grow(lstack_t* stack, size_t required)
 {
-    stack_item_t* item = malloc(sizeof(stack_item_t));
-    if (NULL == item)
+    // double the capacity, or more if a bulk push requires it
+    size_t capacity = stack->capacity;
+    while (capacity < required)
     {
-        return NULL;
+        capacity = (capacity > SIZE_MAX / 2) ? required : 2*capacity;
+    }
+
+    if (capacity > SIZE_MAX / sizeof(void*))
+    {
+        return false;
+    }
+
+    void** items;
+    if (is_inline(stack))
+    {
+        items = malloc(capacity*sizeof(void*));
+        if (NULL == items)
+        {
+            return false;
+        }
+
+        memcpy(items, stack->inline_items, stack->count*sizeof(void*));
+    }
+    else
+    {
+        items = realloc(stack->items, capacity*sizeof(void*));
+        if (NULL == items)
+        {
+            return false;
+        }
     }
 
-    item->data = data;
-    return item;
-}
\ No newline at end of file
+    stack->items    = items;
+    stack->capacity = capacity;
+
+    return true;
+}
+
+static bool is_inline(lstack_t* stack)
+{
+    return stack->items == stack->inline_items;
+}
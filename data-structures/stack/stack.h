@@ -7,7 +7,28 @@
 #include <stddef.h>
 #include <stdbool.h>
 
-struct stack_item;
+// Background:
+//
+// The stack stores its items in a contiguous array that grows
+// geometrically, doubling in capacity whenever it fills. A push or pop is
+// then an array store or load and a change to the count, and the items
+// nearest the top, which are those a stack touches, share cache lines.
+// The array never shrinks, so once a stack has reached the greatest depth
+// of some workload (a depth-first traversal, say), repeating the workload
+// performs no allocation at all; stack_reserve() reaches that depth at once.
+//
+// The first STACK_INLINE_CAPACITY items are stored inline in the stack
+// itself, so that the many stacks that stay small never allocate an array.
+// The inline capacity may be changed by defining STACK_INLINE_CAPACITY
+// before including this header, consistently across translation units.
+
+#ifndef STACK_INLINE_CAPACITY
+#define STACK_INLINE_CAPACITY 8
+#endif
+
+#if STACK_INLINE_CAPACITY < 1
+#error "STACK_INLINE_CAPACITY must be at least 1"
+#endif
 
 // The stack data structure.
 typedef struct stack
@@ -15,8 +36,15 @@ typedef struct stack
     // The number of elements in the stack. 
     size_t count;
 
-    // Pointer to the current top of the stack.
-    struct stack_item* top;
+    // The number of elements the current storage can hold.
+    size_t capacity;
+
+    // The storage, with the top of the stack at items[count - 1];
+    // refers to `inline_items` until the stack outgrows them.
+    void** items;
+
+    // Storage for small stacks.
+    void* inline_items[STACK_INLINE_CAPACITY];
 } lstack_t;
 
 // stack_new()
@@ -65,6 +93,18 @@ bool stack_delete(lstack_t* stack);
 //  `false` otherwise
 bool stack_push(lstack_t* stack, void* data);
 
+// stack_push_n()
+//
+// Push `n` items onto the top of the stack, in order,
+// so that `items[n - 1]` becomes the top of the stack.
+//
+// Either all of the items are pushed, or none are.
+//
+// Returns:
+//  `true` on successful push
+//  `false` otherwise (invalid argument, allocation failure)
+bool stack_push_n(lstack_t* stack, void* items[], size_t n);
+
 // stack_pop()
 //
 // Pop an item off the top of the stack.
@@ -79,6 +119,17 @@ bool stack_push(lstack_t* stack, void* data);
 //  NULL on failure (invalid stack, empty stack)
 void* stack_pop(lstack_t* stack);
 
+// stack_pop_n()
+//
+// Pop up to `n` items off the top of the stack into `items`,
+// in the order in which stack_pop() would return them, so
+// that `items[0]` holds the item that was the top of the stack.
+//
+// Returns:
+//  The number of items popped, fewer than `n` only if the stack
+//  held fewer than `n` items; 0 on invalid argument
+size_t stack_pop_n(lstack_t* stack, void* items[], size_t n);
+
 // stack_peek()
 //
 // Return the user data stored in the topmost stack
@@ -104,4 +155,14 @@ void* stack_peek(lstack_t* stack);
 //  The current count of items on the stack.
 size_t stack_count(lstack_t* stack);
 
+// stack_reserve()
+//
+// Ensure that the stack can hold at least `capacity`
+// items in total without allocating.
+//
+// Returns:
+//  `true` on success
+//  `false` otherwise (invalid stack, allocation failure)
+bool stack_reserve(lstack_t* stack, size_t capacity);
+
 #endif // STACK_H